@@ -0,0 +1,1217 @@
+#include "HospitalManagementSystem.h"
+#include "Benchmarks.h"
+
+// ================= Benchmarks =================
+void printBenchResult(const string& label, size_t operations, double seconds) {
+    cout << "  " << label << ": " << operations << " ops in " << seconds * 1000 << " ms ("
+         << (seconds > 0 ? seconds * 1e9 / operations : 0) << " ns/op)" << endl;
+}
+
+void benchmarkPatientLookup() {
+    cout << "Patient lookup: linear list walk vs ID index" << endl;
+    for (int count : {10000, 100000, 1000000}) {
+        cout << count << " patients" << endl;
+        PatientList patients;
+        mt19937 rng(42);
+
+        auto start = chrono::steady_clock::now();
+        for (int id = 1; id <= count; id++) {
+            patients.admitPatient(id, "Patient", 40, "severe");
+        }
+        printBenchResult("admit", count, elapsedSeconds(start));
+
+        // The walk touches ~count/2 nodes per query, so keep the total work bounded
+        size_t scanQueries = max(20, 20000000 / count);
+        size_t found = 0;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < scanQueries; i++) {
+            found += patients.scanPatientByID(rng() % count + 1) != nullptr;
+        }
+        printBenchResult("linear walk lookup", scanQueries, elapsedSeconds(start));
+
+        size_t indexQueries = 1000000;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < indexQueries; i++) {
+            found += patients.searchPatientByID(rng() % count + 1) != nullptr;
+        }
+        printBenchResult("indexed lookup", indexQueries, elapsedSeconds(start));
+
+        start = chrono::steady_clock::now();
+        for (int id = 1; id <= count; id += 2) {
+            patients.dischargePatient(id);
+        }
+        printBenchResult("discharge", (count + 1) / 2, elapsedSeconds(start));
+
+        if (found != scanQueries + indexQueries) {
+            cout << "  warning: missing patients during lookup" << endl;
+        }
+    }
+}
+
+void benchmarkBedAllocation() {
+    cout << "Bed allocation on a nearly full ward (free-count AVL)" << endl;
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    vector<string> lines;
+    for (int count : {1000, 10000, 100000, 1000000}) {
+        BedManagement beds;
+        mt19937 rng(7);
+        ostringstream report;
+        report << count << " beds" << "\n";
+
+        auto start = chrono::steady_clock::now();
+        for (int bed = 1; bed <= count; bed++) {
+            beds.addBeds(bed);
+        }
+        double addSeconds = elapsedSeconds(start);
+
+        start = chrono::steady_clock::now();
+        for (int patient = 1; patient <= count; patient++) {
+            beds.allocateBed(patient);
+        }
+        double fillSeconds = elapsedSeconds(start);
+
+        // Surge pattern: a random bed frees up and is immediately re-allocated
+        size_t cycles = 200000;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < cycles; i++) {
+            beds.releaseBed(rng() % count + 1);
+            beds.allocateBed(count + static_cast<int>(i));
+        }
+        double cycleSeconds = elapsedSeconds(start);
+
+        report << "  add: " << addSeconds * 1e9 / count << " ns/op, fill: " << fillSeconds * 1e9 / count
+               << " ns/op, release+allocate on full ward: " << cycleSeconds * 1e9 / cycles << " ns/op\n";
+        lines.push_back(report.str());
+    }
+    cout.rdbuf(previous);
+    for (const string& line : lines) {
+        cout << line;
+    }
+}
+
+void benchmarkBilling() {
+    cout << "Billing: indexed max-heap (add, increase-key, settle by ID, pop max)" << endl;
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    vector<string> lines;
+    for (int accounts : {10000, 100000, 1000000}) {
+        BillingSystem billing;
+        mt19937 rng(11);
+        ostringstream report;
+
+        auto start = chrono::steady_clock::now();
+        for (int id = 1; id <= accounts; id++) {
+            billing.addBillingRecord(id, rng() % 100000, "Card");
+        }
+        double addSeconds = elapsedSeconds(start);
+
+        size_t updates = 1000000;
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < updates; i++) {
+            billing.addBillingRecord(rng() % accounts + 1, rng() % 1000, "Cash");
+        }
+        double updateSeconds = elapsedSeconds(start);
+
+        int settled = accounts / 2;
+        start = chrono::steady_clock::now();
+        for (int id = 1; id <= settled; id++) {
+            billing.markBillAsPaidByID(id * 2);
+        }
+        double settleSeconds = elapsedSeconds(start);
+
+        size_t remaining = billing.getPendingCount();
+        start = chrono::steady_clock::now();
+        while (billing.getPendingCount() > 0) {
+            billing.markAsPaid();
+        }
+        double popSeconds = elapsedSeconds(start);
+
+        report << accounts << " accounts\n  add: " << addSeconds * 1e9 / accounts << " ns/op, increase-key: "
+               << updateSeconds * 1e9 / updates << " ns/op, settle by ID: " << settleSeconds * 1e9 / settled
+               << " ns/op, pop max: " << popSeconds * 1e9 / remaining << " ns/op\n";
+        lines.push_back(report.str());
+    }
+    cout.rdbuf(previous);
+    for (const string& line : lines) {
+        cout << line;
+    }
+}
+
+void benchmarkRecovery() {
+    const int perManager = 250000;
+    string directory = (filesystem::temp_directory_path() / "hms_bench_recovery").string();
+    filesystem::remove_all(directory);
+    cout << "Recovery of " << perManager * 5 << " entities (patients, staff, bills, beds, medical records)" << endl;
+
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    double populateSeconds, replaySeconds, checkpointSeconds, snapshotSeconds;
+    uint64_t replayed;
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory, false, UINT64_MAX);
+        storage.recover();
+        auto start = chrono::steady_clock::now();
+        for (int id = 1; id <= perManager; id++) {
+            hospital.patients.admitPatient(id, "Patient", 20 + id % 70, "severe");
+            hospital.staff.addStaff(id, "Staff", "nurses", "Cardiology", "night");
+            hospital.billing.addBillingRecord(id, id % 5000, "Card");
+            hospital.beds.addBeds(id);
+            hospital.medical.addRecord(id, "Patient", 20 + id % 70, "History", "Prescriptions", "Notes");
+        }
+        storage.commit();
+        populateSeconds = elapsedSeconds(start);
+    }
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory, false, UINT64_MAX);
+        RecoveryStats stats = storage.recover();
+        replaySeconds = stats.seconds;
+        replayed = stats.replayedRecords;
+        auto start = chrono::steady_clock::now();
+        storage.checkpoint();
+        checkpointSeconds = elapsedSeconds(start);
+    }
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory, false, UINT64_MAX);
+        snapshotSeconds = storage.recover().seconds;
+    }
+    cout.rdbuf(previous);
+    filesystem::remove_all(directory);
+
+    cout << "  populate with logging: " << populateSeconds * 1000 << " ms" << endl;
+    cout << "  recover by replaying " << replayed << " log records: " << replaySeconds * 1000 << " ms" << endl;
+    cout << "  checkpoint: " << checkpointSeconds * 1000 << " ms" << endl;
+    cout << "  recover from snapshot: " << snapshotSeconds * 1000 << " ms" << endl;
+}
+
+// One heap block per node; the baseline the node pool is measured against
+template <typename T>
+struct HeapNodes {
+    template <typename... Args>
+    T* create(Args&&... args) {
+        return new T{std::forward<Args>(args)...};
+    }
+
+    void destroy(T* node) {
+        delete node;
+    }
+};
+
+size_t residentBytes() {
+#ifdef HMS_HAVE_MMAP
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return 0;
+}
+
+// Builds a doubly linked patient list, walks it, replaces a random half of it and walks it again
+template <typename Allocator>
+void benchmarkNodeChurn(const string& label, int count) {
+    cout << label << endl;
+    size_t residentBefore = residentBytes();
+    Allocator nodes;
+    vector<Patient*> live;
+    live.reserve(count);
+    Patient* head = nullptr;
+    auto link = [&](Patient* patient) {
+        patient->next = head;
+        if (head) head->prev = patient;
+        head = patient;
+        live.push_back(patient);
+    };
+    auto walk = [&]() {
+        long long total = 0;
+        for (Patient* current = head; current; current = current->next) {
+            total += current->age;
+        }
+        return total;
+    };
+
+    auto start = chrono::steady_clock::now();
+    for (int id = 1; id <= count; id++) {
+        link(nodes.create(id, "Patient", 20 + id % 70, "severe"));
+    }
+    printBenchResult("insert", count, elapsedSeconds(start));
+    size_t residentAfter = residentBytes();
+
+    start = chrono::steady_clock::now();
+    long long checksum = walk();
+    printBenchResult("traverse", count, elapsedSeconds(start));
+
+    mt19937 rng(11);
+    shuffle(live.begin(), live.end(), rng);
+    int replaced = count / 2;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < replaced; i++) {
+        Patient* patient = live.back();
+        live.pop_back();
+        if (patient->prev) {
+            patient->prev->next = patient->next;
+        } else {
+            head = patient->next;
+        }
+        if (patient->next) patient->next->prev = patient->prev;
+        nodes.destroy(patient);
+    }
+    for (int i = 0; i < replaced; i++) {
+        link(nodes.create(count + i + 1, "Patient", 20 + i % 70, "severe"));
+    }
+    printBenchResult("delete + insert", replaced * 2, elapsedSeconds(start));
+
+    start = chrono::steady_clock::now();
+    checksum += walk();
+    printBenchResult("traverse after churn", count, elapsedSeconds(start));
+
+    for (Patient* patient : live) {
+        nodes.destroy(patient);
+    }
+    if (residentAfter > residentBefore) {
+        cout << "  resident memory for " << count << " nodes: " << (residentAfter - residentBefore) / (1024.0 * 1024.0) << " MiB ("
+             << (residentAfter - residentBefore) / count << " bytes/node)" << endl;
+    }
+    if (checksum == 0) {
+        cout << "  warning: empty walk" << endl;
+    }
+}
+
+void benchmarkAllocator() {
+    const int count = 1000000;
+    cout << "Patient nodes (" << sizeof(Patient) << " bytes each): node pool vs one heap block per node, " << count << " nodes" << endl;
+    // The pool runs first: its slabs go back to the OS when it is destroyed, heap blocks may not
+    benchmarkNodeChurn<NodePool<Patient>>("node pool", count);
+    benchmarkNodeChurn<HeapNodes<Patient>>("new/delete", count);
+}
+
+void benchmarkStaffGrowth() {
+    const int count = 1000000;
+    cout << "Staff insert from an empty table to " << count << " entries (table doubles at load factor 0.75)" << endl;
+    StaffManagement staff;
+    LatencyHistogram insertTimes;
+    size_t growths = 0;
+    double growthSeconds = 0;
+    string name = "Staff member", role = "nurses", department = "Cardiology", shift = "night";
+
+    auto start = chrono::steady_clock::now();
+    for (int id = 1; id <= count; id++) {
+        size_t buckets = staff.getBucketCount();
+        auto insertStart = chrono::steady_clock::now();
+        staff.addStaff(id, name, role, department, shift);
+        double seconds = elapsedSeconds(insertStart);
+        insertTimes.record(static_cast<uint64_t>(seconds * 1e9));
+        if (staff.getBucketCount() != buckets) {
+            growths++;
+            growthSeconds += seconds;
+        }
+    }
+    double total = elapsedSeconds(start);
+    printBenchResult("insert", count, total);
+    cout << "  per insert (ns): p50 " << insertTimes.percentile(50) << ", p99 " << insertTimes.percentile(99)
+         << ", max " << insertTimes.getMax() << endl;
+    cout << "  " << growths << " growths to " << staff.getBucketCount() << " buckets took " << growthSeconds * 1000
+         << " ms (" << (total > 0 ? growthSeconds / total * 100 : 0) << "% of the run)" << endl;
+}
+
+void benchmarkStaffRoster() {
+    const int count = 50000;
+    const vector<string> roles = {"doctor", "nurses", "paramedics", "janitors"};
+    const vector<string> shifts = {"morning", "evening", "night"};
+    vector<string> departments;
+    for (const char* name : {"Cardiology", "Neurology", "Oncology", "Pediatrics", "Radiology", "Surgery", "Emergency", "Orthopedics",
+                             "Dermatology", "Psychiatry", "Urology", "Nephrology", "Pathology", "Anesthesia", "Gastroenterology", "Pulmonology"}) {
+        departments.push_back(name);
+    }
+    cout << "Roster queries on " << count << " staff (" << roles.size() << " roles, " << departments.size() << " departments, "
+         << shifts.size() << " shifts)" << endl;
+    StaffManagement staff;
+    mt19937 rng(3);
+    for (int id = 1; id <= count; id++) {
+        staff.addStaff(id, "Staff", roles[rng() % roles.size()], departments[rng() % departments.size()], shifts[rng() % shifts.size()]);
+    }
+
+    struct Query {
+        string role, department, shift;
+    };
+    vector<Query> queries;
+    for (int i = 0; i < 1000; i++) {
+        // Mix of one-, two- and three-attribute queries
+        Query query{roles[rng() % roles.size()], departments[rng() % departments.size()], shifts[rng() % shifts.size()]};
+        if (i % 3 == 1) query.shift.clear();
+        if (i % 3 == 2) query.department.clear(), query.shift.clear();
+        queries.push_back(query);
+    }
+
+    size_t scanned = 0, indexed = 0;
+    auto start = chrono::steady_clock::now();
+    for (const Query& query : queries) {
+        scanned += staff.scanStaff(query.role, query.department, query.shift).size();
+    }
+    double scanSeconds = elapsedSeconds(start);
+    printBenchResult("bucket walk", queries.size(), scanSeconds);
+
+    start = chrono::steady_clock::now();
+    for (const Query& query : queries) {
+        indexed += staff.queryStaff(query.role, query.department, query.shift).size();
+    }
+    double indexSeconds = elapsedSeconds(start);
+    printBenchResult("bitmap intersection", queries.size(), indexSeconds);
+    cout << "  " << indexed / queries.size() << " matches per query on average, " << (indexSeconds > 0 ? scanSeconds / indexSeconds : 0)
+         << "x faster" << endl;
+    if (scanned != indexed) {
+        cout << "  warning: index and walk disagree" << endl;
+    }
+}
+
+void benchmarkMedicalRecords() {
+    const int patients = 200000, encountersPerPatient = 5;
+    const size_t total = size_t(patients) * encountersPerPatient;
+    cout << "Medical records: " << total << " encounters for " << patients << " patients" << endl;
+    stringstream csv;
+    csv << "patient_id,name,age,history,prescriptions,notes\n";
+    for (int visit = 0; visit < encountersPerPatient; visit++) {
+        for (int id = 1; id <= patients; id++) {
+            csv << id << ",Patient," << 20 + id % 70 << ",\"Visit " << visit << ", follow-up\",Paracetamol,Stable\n";
+        }
+    }
+
+    MedicalSystem medical;
+    medical.reserve(patients);
+    auto start = chrono::steady_clock::now();
+    size_t imported = importMedicalRecords(medical, csv, "generated");
+    printBenchResult("bulk import from CSV", imported, elapsedSeconds(start));
+
+    mt19937 rng(9);
+    size_t lookups = 1000000, found = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) {
+        found += medical.getRecordCount(rng() % patients + 1);
+    }
+    printBenchResult("history lookup", lookups, elapsedSeconds(start));
+
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    start = chrono::steady_clock::now();
+    for (int id = 1; id <= patients; id++) {
+        medical.updateRecord(id, "Ibuprofen", "Improving");
+    }
+    double updateSeconds = elapsedSeconds(start);
+    start = chrono::steady_clock::now();
+    for (int id = 1; id <= patients; id++) {
+        medical.deleteRecord(id);
+    }
+    double deleteSeconds = elapsedSeconds(start);
+    cout.rdbuf(previous);
+    printBenchResult("update oldest", patients, updateSeconds);
+    printBenchResult("delete oldest", patients, deleteSeconds);
+
+    if (imported != total || found != lookups * encountersPerPatient) {
+        cout << "  warning: records missing after import" << endl;
+    }
+}
+
+void benchmarkTextSearch() {
+    const int count = 1000000;
+    const vector<string> conditions = {"Hypertension", "Diabetes type 2", "Asthma", "Atrial fibrillation", "COPD", "Migraine",
+                                       "Osteoarthritis", "Hypothyroidism", "Pneumonia", "Deep vein thrombosis", "Anemia", "Epilepsy"};
+    const vector<string> drugs = {"Warfarin", "Heparin", "Apixaban", "Metformin", "Insulin", "Salbutamol", "Amlodipine", "Lisinopril",
+                                  "Levothyroxine", "Amoxicillin", "Paracetamol", "Ibuprofen", "Sumatriptan", "Levetiracetam"};
+    const vector<string> symptoms = {"chest pain", "shortness of breath", "headache", "dizziness", "fatigue", "nausea",
+                                     "swollen leg", "fever", "cough", "palpitations", "joint pain", "wheezing"};
+    cout << "Full-text search over " << count << " medical records" << endl;
+
+    MedicalSystem medical;
+    mt19937 rng(21);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        medical.addRecord(i / 3 + 1, "Patient", 20 + i % 70, conditions[rng() % conditions.size()],
+                          drugs[rng() % drugs.size()] + " " + to_string(5 * (1 + rng() % 20)) + "mg daily",
+                          "Reports " + symptoms[rng() % symptoms.size()] + " and " + symptoms[rng() % symptoms.size()]);
+    }
+    printBenchResult("add with indexing", count, elapsedSeconds(start));
+    cout << "  " << medical.getTextIndex().getTermCount() << " terms, " << medical.getTextIndex().getPostingBytes() / (1024.0 * 1024.0)
+         << " MiB of compressed postings" << endl;
+
+    for (const char* query : {"warfarin", "chest pain", "warfarin palpitations", "warf* OR hepar* OR apix*", "epilepsy levetiracetam headache"}) {
+        start = chrono::steady_clock::now();
+        size_t indexed = medical.searchText(query).size();
+        double indexSeconds = elapsedSeconds(start);
+        start = chrono::steady_clock::now();
+        size_t scanned = medical.scanText(query).size();
+        double scanSeconds = elapsedSeconds(start);
+        cout << "  \"" << query << "\": index " << indexSeconds * 1000 << " ms (" << indexed << " hits), substring scan "
+             << scanSeconds * 1000 << " ms (" << scanned << " hits)" << endl;
+    }
+}
+
+void benchmarkRecordMemory() {
+    const int count = 1000000;
+    const vector<string> doctors = {"Dr. Ahmad", "Dr. Fatima", "Dr. Ibrahim", "Dr. Maham", "Dr. Shoaib", "Dr. Abbas", "Dr. Zarrar"};
+    const vector<string> times = {"9:00 AM on Monday", "10:00 AM on Tuesday", "2:00 PM on Thursday", "10:30 AM on Friday"};
+    const vector<string> roles = {"doctor", "nurses", "paramedics", "janitors"};
+    const vector<string> departments = {"Cardiology", "Neurology", "Emergency", "Pediatrics", "Orthopedics", "Gastroenterology"};
+    const vector<string> shifts = {"morning", "evening", "night"};
+    const vector<string> methods = {"Card", "Insurance", "Cash"};
+    cout << "Resident memory per record, " << count << " records of each type (including indexes)" << endl;
+
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    PatientList patients;
+    StaffManagement staff;
+    BillingSystem billing;
+    size_t start = residentBytes();
+    for (int id = 1; id <= count; id++) {
+        bool severe = id % 3 == 0;
+        patients.admitPatient(id, "Patient", 20 + id % 70, severe ? "severe" : "not_severe",
+                              severe ? "" : doctors[id % doctors.size()], severe ? "" : times[id % times.size()]);
+    }
+    size_t afterPatients = residentBytes();
+    for (int id = 1; id <= count; id++) {
+        staff.addStaff(id, "Staff", roles[id % roles.size()], departments[id % departments.size()], shifts[id % shifts.size()]);
+    }
+    size_t afterStaff = residentBytes();
+    for (int id = 1; id <= count; id++) {
+        billing.addBillingRecord(id, id % 5000, methods[id % methods.size()]);
+        if (id % 2) billing.markBillAsPaidByID(id);
+    }
+    size_t afterBilling = residentBytes();
+    cout.rdbuf(previous);
+
+    auto report = [&](const string& label, size_t nodeSize, size_t before, size_t after) {
+        cout << "  " << label << ": " << nodeSize << "-byte node, " << (after - before) / double(count) << " resident bytes/record" << endl;
+    };
+    report("patients", sizeof(Patient), start, afterPatients);
+    report("staff", sizeof(Staff), afterPatients, afterStaff);
+    report("bills", sizeof(BillingRecord), afterStaff, afterBilling);
+    cout << "  symbol table: " << symbolTable().size() << " distinct strings" << endl;
+}
+
+void benchmarkCensus() {
+    const int count = 2000000;
+    const vector<string> doctors = {"Dr. Ahmad", "Dr. Fatima", "Dr. Ibrahim", "Dr. Maham", "Dr. Shoaib", "Dr. Abbas", "Dr. Zarrar"};
+    cout << "Census over " << count << " patients: average age of severe patients (column kernels: " << columnKernelName() << ")" << endl;
+    PatientList patients;
+    mt19937 rng(17);
+    for (int id = 1; id <= count; id++) {
+        bool severe = rng() % 3 == 0;
+        patients.admitPatient(id, "Patient", 1 + rng() % 110, severe ? "severe" : "not_severe", severe ? "" : doctors[rng() % doctors.size()],
+                              severe ? "" : "9:00 AM on Monday");
+    }
+    Symbol severe("severe");
+
+    auto start = chrono::steady_clock::now();
+    const PatientColumns& columns = patients.getColumns();
+    printBenchResult("build columns", count, elapsedSeconds(start));
+
+    const int rounds = 20;
+    double walked = 0, scalar = 0, vectorized = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) walked += patients.averageAgeByWalk(severe);
+    double walkSeconds = elapsedSeconds(start) / rounds;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) scalar += columns.averageAgeScalar(severe);
+    double scalarSeconds = elapsedSeconds(start) / rounds;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) vectorized += columns.averageAge(severe);
+    double vectorSeconds = elapsedSeconds(start) / rounds;
+
+    // Each column scan reads one 4-byte condition and one 4-byte age per row
+    auto report = [&](const string& label, double seconds) {
+        cout << "  " << label << ": " << seconds * 1000 << " ms (" << seconds * 1e9 / count << " ns/row, "
+             << count * 8 / seconds / 1e9 << " GB/s of column data)" << endl;
+    };
+    report("linked list walk", walkSeconds);
+    report("columns, scalar kernel", scalarSeconds);
+    report(string("columns, ") + columnKernelName() + " kernel", vectorSeconds);
+
+    start = chrono::steady_clock::now();
+    size_t groups = columns.countByDoctor().size();
+    cout << "  count by doctor (" << groups << " groups): " << elapsedSeconds(start) * 1000 << " ms" << endl;
+    if (walked != scalar || scalar != vectorized) {
+        cout << "  warning: kernels disagree (" << walked / rounds << ", " << scalar / rounds << ", " << vectorized / rounds << ")" << endl;
+    }
+}
+
+void benchmarkScheduler() {
+    const int doctorCount = 800, specializations = 20, days = 30;
+    const int firstSlot = 16, lastSlot = 48; // 8:00 AM to midnight
+    cout << "Appointment scheduler: " << doctorCount << " doctors in " << specializations << " specializations, "
+         << (lastSlot - firstSlot) * doctorCount << " slots per day for " << days << " days" << endl;
+    AppointmentScheduler scheduler;
+    vector<Symbol> specialties;
+    for (int i = 0; i < specializations; i++) {
+        specialties.push_back(Symbol("Specialization" + to_string(i)));
+    }
+    auto start = chrono::steady_clock::now();
+    for (int d = 0; d < doctorCount; d++) {
+        uint32_t doctor = scheduler.addDoctor(specialties[d % specializations]);
+        for (int day = 0; day < days; day++) {
+            for (int slot = firstSlot; slot < lastSlot; slot++) {
+                scheduler.openSlot(doctor, day * slotsPerDay + slot);
+            }
+        }
+    }
+    size_t totalSlots = size_t(doctorCount) * days * (lastSlot - firstSlot);
+    printBenchResult("open slots", totalSlots, elapsedSeconds(start));
+
+    mt19937 rng(15);
+    vector<pair<uint32_t, SlotTime>> booked;
+    size_t attempts = totalSlots / 2;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < attempts; i++) {
+        SlotTime after = rng() % (days * slotsPerDay);
+        SlotTime time;
+        uint32_t doctor;
+        if (scheduler.findEarliest(specialties[rng() % specializations], after, time, doctor) && scheduler.book(doctor, time)) {
+            booked.emplace_back(doctor, time);
+        }
+    }
+    printBenchResult("book earliest free slot for a specialization", attempts, elapsedSeconds(start));
+
+    shuffle(booked.begin(), booked.end(), rng);
+    size_t moves = booked.size() / 4, moved = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < moves; i++) {
+        SlotTime to = booked[i].second + 1;
+        moved += scheduler.rebook(booked[i].first, booked[i].second, to);
+    }
+    printBenchResult("rebook to the next slot", moves, elapsedSeconds(start));
+
+    size_t queries = 200000, found = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; i++) {
+        SlotTime time;
+        uint32_t doctor;
+        found += scheduler.findEarliest(specialties[i % specializations], 0, time, doctor);
+    }
+    printBenchResult("earliest for a specialization, ordered set", queries, elapsedSeconds(start));
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; i++) {
+        SlotTime time;
+        uint32_t doctor;
+        found += scheduler.findEarliest(specialties[i % specializations], time, doctor);
+    }
+    printBenchResult("earliest for a specialization, tournament tree", queries, elapsedSeconds(start));
+
+    const size_t k = 10, scans = 20;
+    SlotTime checksum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < scans; i++) {
+        vector<pair<SlotTime, uint32_t>> slots;
+        for (uint32_t d = 0; d < scheduler.getDoctorCount(); d++) {
+            for (SlotTime time : scheduler.getFreeSlots(d)) {
+                slots.emplace_back(time, d);
+            }
+        }
+        partial_sort(slots.begin(), slots.begin() + k, slots.end());
+        checksum += slots[k - 1].first;
+    }
+    printBenchResult("top-10 soonest across all doctors, scan", scans, elapsedSeconds(start));
+    queries = 100000;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; i++) {
+        checksum += scheduler.findSoonest(k).back().first;
+    }
+    printBenchResult("top-10 soonest across all doctors, tournament tree", queries, elapsedSeconds(start));
+    cout << "  " << found << " found, checksum " << checksum << endl;
+
+    size_t cancels = booked.size() / 2;
+    start = chrono::steady_clock::now();
+    for (size_t i = moves; i < moves + cancels; i++) {
+        scheduler.cancel(booked[i].first, booked[i].second);
+    }
+    printBenchResult("cancel", cancels, elapsedSeconds(start));
+    cout << "  " << booked.size() << " booked, " << moved << " moved, " << scheduler.getBookedCount() << " still booked" << endl;
+}
+
+// Mixed front-desk load: 90% staff and patient lookups, 10% admit+discharge
+// and staff add+remove on fresh IDs, split evenly over the worker threads
+double runServiceLoad(HospitalService& service, WorkerPool& pool, int preloaded, size_t operations) {
+    size_t threads = pool.getThreadCount();
+    atomic<size_t> found(0);
+    auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++) {
+        pool.submit([&, t] {
+            mt19937 rng(static_cast<uint32_t>(t + 1));
+            int freshID = preloaded + 1 + static_cast<int>(t * operations);
+            size_t hits = 0;
+            for (size_t i = 0; i < operations / threads; i++) {
+                int id = rng() % preloaded + 1;
+                uint32_t kind = rng() % 20;
+                if (kind < 9) {
+                    hits += service.readStaff(id, [](const Staff&) {});
+                } else if (kind < 18) {
+                    hits += service.readPatient(id, [](const Patient&) {});
+                } else if (kind == 18) {
+                    service.admitPatient(freshID, "Walk-in", 40, "not_severe");
+                    service.dischargePatient(freshID++);
+                } else {
+                    service.addStaff(freshID, "Temp", "nurses", "Emergency", "night");
+                    service.removeStaff(freshID++);
+                }
+            }
+            found += hits;
+        });
+    }
+    pool.wait();
+    double seconds = elapsedSeconds(start);
+    if (found.load() == 0) cout << "  (no lookups hit)" << endl;
+    return seconds;
+}
+
+void benchmarkService() {
+    const int preloaded = 200000;
+    const size_t operations = 2000000;
+    size_t cores = max(1u, thread::hardware_concurrency());
+    cout << "Concurrent service: " << preloaded << " staff and patients, " << operations << " requests per run, "
+         << cores << " hardware threads" << endl;
+    for (size_t shardCount : {size_t(1), size_t(64)}) {
+        HospitalService service(shardCount);
+        for (int id = 1; id <= preloaded; id++) {
+            service.addStaff(id, "Staff" + to_string(id), "nurses", "Cardiology", "night");
+            service.admitPatient(id, "Patient" + to_string(id), 20 + id % 70, id % 3 ? "not_severe" : "severe");
+        }
+        for (size_t threads = 1; threads <= max<size_t>(2, cores); threads *= 2) {
+            WorkerPool pool(threads);
+            double seconds = runServiceLoad(service, pool, preloaded, operations);
+            printBenchResult(to_string(shardCount) + (shardCount == 1 ? " shard, " : " shards, ") + to_string(threads) +
+                                 (threads == 1 ? " thread" : " threads"),
+                             operations, seconds);
+        }
+    }
+}
+
+// Admitting desks on a half-full ward: each desk allocates beds and, once it
+// holds 16, releases a random one of them before the next allocation
+template <typename Allocate, typename Release>
+double runBedDesks(size_t threads, size_t operations, Allocate allocate, Release release) {
+    WorkerPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++) {
+        pool.submit([&, t] {
+            mt19937 rng(static_cast<uint32_t>(t + 1));
+            vector<int> held;
+            int patientId = static_cast<int>(t * operations) + 1;
+            for (size_t i = 0; i < operations / threads; i++) {
+                if (held.size() >= 16) {
+                    size_t pick = rng() % held.size();
+                    release(held[pick]);
+                    held[pick] = held.back();
+                    held.pop_back();
+                } else {
+                    int bed = allocate(patientId++, t);
+                    if (bed != -1) held.push_back(bed);
+                }
+            }
+            for (int bed : held) release(bed);
+        });
+    }
+    pool.wait();
+    return elapsedSeconds(start);
+}
+
+void benchmarkBedContention() {
+    const int bedCount = 100000;
+    const size_t operations = 2000000;
+    size_t cores = max(1u, thread::hardware_concurrency());
+    cout << "Concurrent bed allocation: " << bedCount << " beds, half occupied, " << operations << " allocate/release calls per run, "
+         << cores << " hardware threads" << endl;
+    BedManagement ward;
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    for (int bed = 1; bed <= bedCount; bed++) {
+        ward.addBeds(bed);
+    }
+    for (int patient = 1; patient <= bedCount / 2; patient++) {
+        ward.occupyBed(patient * 2, -patient - 1);
+    }
+    cout.rdbuf(previous);
+
+    for (size_t threads = 1; threads <= max<size_t>(2, cores); threads *= 2) {
+        string suffix = ", " + to_string(threads) + (threads == 1 ? " thread" : " threads");
+        {
+            ConcurrentBedAllocator beds(ward.getOccupancy());
+            double seconds = runBedDesks(threads, operations, [&](int patientId, size_t) { return beds.allocate(patientId); },
+                                         [&](int bed) { beds.release(bed); });
+            printBenchResult("lock-free bitmap, lowest bed first" + suffix, operations, seconds);
+        }
+        {
+            ConcurrentBedAllocator beds(ward.getOccupancy());
+            size_t stride = max<size_t>(1, beds.getWordCount() / threads);
+            double seconds = runBedDesks(threads, operations, [&](int patientId, size_t desk) { return beds.allocate(patientId, desk * stride); },
+                                         [&](int bed) { beds.release(bed); });
+            printBenchResult("lock-free bitmap, desks spread over the ward" + suffix, operations, seconds);
+            if (beds.getFreeBeds() != bedCount / 2) cout << "  free count mismatch: " << beds.getFreeBeds() << endl;
+        }
+        {
+            BedManagement tree;
+            streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+            for (const pair<int, int>& bed : ward.getOccupancy()) {
+                tree.addBeds(bed.first);
+                if (bed.second != -1) tree.occupyBed(bed.first, bed.second);
+            }
+            mutex treeLock;
+            double seconds = runBedDesks(
+                threads, operations,
+                [&](int patientId, size_t) {
+                    lock_guard<mutex> guard(treeLock);
+                    return tree.allocateBed(patientId);
+                },
+                [&](int bed) {
+                    lock_guard<mutex> guard(treeLock);
+                    tree.releaseBed(bed);
+                });
+            cout.rdbuf(previous);
+            printBenchResult("mutex + free-count AVL tree" + suffix, operations, seconds);
+        }
+    }
+}
+
+void fillPendingBills(BillingSystem& billing, int count) {
+    const char* methods[] = {"Card", "Insurance", "Cash"};
+    mt19937 rng(19);
+    for (int id = 1; id <= count; id++) {
+        billing.addBillingRecord(id, 50 + rng() % 500000 / 100.0, methods[rng() % 3]);
+    }
+}
+
+void benchmarkSettlement() {
+    const int billCount = 500000;
+    size_t cores = max(1u, thread::hardware_concurrency());
+    cout << "Month-end settlement of " << billCount << " pending bills, " << cores << " hardware threads" << endl;
+    ofstream nullOutput;
+    {
+        BillingSystem billing;
+        fillPendingBills(billing, billCount);
+        streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+        auto start = chrono::steady_clock::now();
+        while (billing.getPendingCount() > 0) {
+            billing.markAsPaid();
+        }
+        double seconds = elapsedSeconds(start);
+        cout.rdbuf(previous);
+        printBenchResult("markAsPaid loop", billCount, seconds);
+    }
+    SettlementRules rules;
+    rules.cashDiscount = 0.05;
+    double expectedPaid = -1;
+    for (size_t threads = 0; threads <= max<size_t>(2, cores); threads = threads ? threads * 2 : 1) {
+        BillingSystem billing;
+        fillPendingBills(billing, billCount);
+        unique_ptr<WorkerPool> pool;
+        if (threads > 0) pool = make_unique<WorkerPool>(threads);
+        SettlementSummary summary = billing.settleAll(rules, pool.get());
+        printBenchResult(threads == 0 ? string("settleAll, calling thread") : "settleAll, " + to_string(threads) + (threads == 1 ? " thread" : " threads"),
+                         billCount, summary.seconds);
+        if (expectedPaid < 0) expectedPaid = summary.total.paidByPatients;
+        if (summary.total.paidByPatients != expectedPaid || billing.getPaidCount() != size_t(billCount)) {
+            cout << "  settlement totals differ between runs" << endl;
+        }
+    }
+}
+
+// Per-call cost of logging a typical StaffAdd mutation: the async audit log
+// (from one and from several producer threads) vs. the synchronous write-ahead log
+void benchmarkAuditLog() {
+    const size_t events = 1000000;
+    BinaryWriter payload;
+    payload.putInt(42);
+    payload.putString("Sara Khan");
+    payload.putString("nurses");
+    payload.putString("Cardiology");
+    payload.putString("night");
+    filesystem::path directory = filesystem::temp_directory_path() / "hms_bench_audit";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    size_t cores = max(1u, thread::hardware_concurrency());
+    cout << "Audit logging of " << events << " mutations (" << payload.size() << "-byte payload), " << cores << " hardware threads" << endl;
+
+    auto report = [](const string& label, size_t operations, double seconds, const LatencyHistogram& latency) {
+        printBenchResult(label, operations, seconds);
+        cout << "    per call (ns): p50 " << latency.percentile(50) << ", p99 " << latency.percentile(99)
+             << ", p99.9 " << latency.percentile(99.9) << ", max " << latency.getMax() << endl;
+    };
+
+    for (size_t producers = 1; producers <= max<size_t>(2, cores); producers *= 2) {
+        AuditLog audit;
+        audit.open((directory / ("audit" + to_string(producers))).string());
+        vector<LatencyHistogram> latencies(producers);
+        WorkerPool pool(producers);
+        auto start = chrono::steady_clock::now();
+        for (size_t t = 0; t < producers; t++) {
+            pool.submit([&, t] {
+                for (size_t i = 0; i < events / producers; i++) {
+                    auto before = chrono::steady_clock::now();
+                    audit.append(MutationType::StaffAdd, payload);
+                    latencies[t].record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
+                }
+            });
+        }
+        pool.wait();
+        double appendSeconds = elapsedSeconds(start);
+        audit.flush();
+        double drainedSeconds = elapsedSeconds(start);
+        for (size_t t = 1; t < producers; t++) latencies[0].merge(latencies[t]);
+        report("audit log append, " + to_string(producers) + (producers == 1 ? " producer" : " producers"), events, appendSeconds, latencies[0]);
+        cout << "    on disk after " << drainedSeconds * 1000 << " ms in " << audit.getBatchCount() << " batched write+fsync calls, "
+             << audit.getFullWaits() << " full-ring waits" << endl;
+    }
+
+    {
+        WriteAheadLog wal;
+        wal.open((directory / "wal").string(), 1, true);
+        LatencyHistogram latency;
+        size_t calls = events / 10;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            auto before = chrono::steady_clock::now();
+            wal.append(MutationType::StaffAdd, payload);
+            latency.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
+        }
+        report("write-ahead log, write per record", calls, elapsedSeconds(start), latency);
+    }
+    filesystem::remove_all(directory);
+}
+
+void benchmarkChangeFeed() {
+    const size_t events = 1000000;
+    BinaryWriter payload;
+    payload.putInt(42);
+    payload.putString("Sara Khan");
+    payload.putString("nurses");
+    payload.putString("Cardiology");
+    payload.putString("night");
+    filesystem::path directory = filesystem::temp_directory_path() / "hms_bench_cdc";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    cout << "Change feed export of " << events << " mutations (" << payload.size() << "-byte payload)" << endl;
+
+    {
+        // Baseline: encode each event as JSON on the caller's thread and write it straight out
+        string path = (directory / "inline.jsonl").string();
+        ofstream out(path, ios::binary);
+        LatencyHistogram latency;
+        size_t calls = events / 10;
+        string line;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            auto before = chrono::steady_clock::now();
+            line.clear();
+            appendChangeEventJson(line, i + 1, 0, MutationType::StaffAdd, payload.data());
+            line += '\n';
+            out.write(line.data(), line.size());
+            out.flush();
+            latency.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
+        }
+        printBenchResult("inline JSON, write per event", calls, elapsedSeconds(start));
+        cout << "    per call (ns): p50 " << latency.percentile(50) << ", p99 " << latency.percentile(99) << ", max " << latency.getMax() << endl;
+    }
+
+    for (ChangeFeedFormat format : {ChangeFeedFormat::Json, ChangeFeedFormat::Binary}) {
+        string name = format == ChangeFeedFormat::Json ? "json" : "binary";
+        string path = (directory / ("feed." + name)).string();
+        ChangeFeed feed;
+        feed.open(path, format);
+        LatencyHistogram latency;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < events; i++) {
+            auto before = chrono::steady_clock::now();
+            feed.append(MutationType::StaffAdd, payload);
+            latency.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
+        }
+        double appendSeconds = elapsedSeconds(start);
+        feed.flush();
+        double drainedSeconds = elapsedSeconds(start);
+        printBenchResult("batched " + name + " feed append", events, appendSeconds);
+        cout << "    per call (ns): p50 " << latency.percentile(50) << ", p99 " << latency.percentile(99) << ", max " << latency.getMax() << endl;
+        cout << "    on disk after " << drainedSeconds * 1000 << " ms in " << feed.getBatchCount() << " writes, "
+             << filesystem::file_size(path) / events << " bytes per event" << endl;
+        feed.close();
+
+        // A consumer catching up from a cursor halfway through the feed
+        ChangeFeedCursor cursor;
+        readChangeFeed(path, 0, [&](uint64_t sequence, const string&, uint64_t next) {
+            if (sequence == events / 2) cursor = {sequence, next};
+        });
+        size_t read = 0;
+        start = chrono::steady_clock::now();
+        readChangeFeed(path, cursor.offset, [&](uint64_t, const string&, uint64_t) { read++; });
+        printBenchResult("resume " + name + " feed from cursor", read, elapsedSeconds(start));
+    }
+    filesystem::remove_all(directory);
+}
+
+void benchmarkBulkImport() {
+    const int count = 1000000;
+    const vector<string> roles = {"doctor", "nurses", "paramedics", "janitors"};
+    const vector<string> departments = {"Cardiology", "Neurology", "Emergency", "Pediatrics", "Orthopedics", "Gastroenterology"};
+    const vector<string> shifts = {"morning", "evening", "night"};
+    const vector<string> methods = {"Card", "Insurance", "Cash"};
+    cout << "Bulk import of " << count << " rows per file from disk" << endl;
+    filesystem::path directory = filesystem::temp_directory_path() / "hms_bench_import";
+    filesystem::create_directories(directory);
+    string staffCsv = (directory / "staff.csv").string(), staffTsv = (directory / "staff.tsv").string();
+    string patientsCsv = (directory / "patients.csv").string(), billsCsv = (directory / "bills.csv").string();
+    {
+        ofstream csv(staffCsv), tsv(staffTsv), patients(patientsCsv), bills(billsCsv);
+        csv << "id,name,role,department,shift\n";
+        tsv << "id\tname\trole\tdepartment\tshift\n";
+        patients << "id,name,age,condition,doctor,appointment\n";
+        bills << "patient_id,amount,payment_method,paid\n";
+        for (int id = 1; id <= count; id++) {
+            const string& role = roles[id % roles.size()];
+            const string& department = departments[id % departments.size()];
+            const string& shift = shifts[id % shifts.size()];
+            csv << id << ",Staff member," << role << ',' << department << ',' << shift << '\n';
+            tsv << id << "\tStaff member\t" << role << '\t' << department << '\t' << shift << '\n';
+            patients << id << ",Patient," << 1 + id % 110 << ',' << (id % 3 ? "not_severe,Dr. Ahmad,9:00 AM on Monday" : "severe,,") << '\n';
+            bills << id << ',' << id % 100000 / 100.0 << ',' << methods[id % methods.size()] << ',' << (id % 2 ? "1" : "0") << '\n';
+        }
+    }
+
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    double lineSeconds, csvSeconds, tsvSeconds, patientSeconds, billSeconds;
+    size_t lineRows = 0, csvRows, tsvRows, patientRows, billRows;
+    {
+        // Baseline: getline, one string per field, and a table that doubles as it fills
+        StaffManagement staff;
+        ifstream in(staffCsv);
+        auto start = chrono::steady_clock::now();
+        string line;
+        getline(in, line);
+        while (getline(in, line)) {
+            vector<string> f = parseCsvLine(line);
+            if (f.size() < 5 || !isValidRole(f[2])) continue;
+            lineRows += staff.addStaff(parseIntArgument(f[0]), f[1], f[2], f[3], f[4]);
+        }
+        lineSeconds = elapsedSeconds(start);
+    }
+    auto timeImport = [&](const string& path, auto import, size_t& rows) {
+        ifstream in(path, ios::binary);
+        auto start = chrono::steady_clock::now();
+        rows = import(in, path, delimiterFor(path));
+        return elapsedSeconds(start);
+    };
+    {
+        StaffManagement staff;
+        csvSeconds = timeImport(staffCsv, [&](istream& in, const string& path, char delimiter) { return importStaff(staff, in, path, delimiter); }, csvRows);
+    }
+    {
+        StaffManagement staff;
+        tsvSeconds = timeImport(staffTsv, [&](istream& in, const string& path, char delimiter) { return importStaff(staff, in, path, delimiter); }, tsvRows);
+    }
+    {
+        PatientList patients;
+        patientSeconds = timeImport(patientsCsv, [&](istream& in, const string& path, char delimiter) {
+            return importPatients(patients, in, path, delimiter);
+        }, patientRows);
+    }
+    {
+        BillingSystem billing;
+        billSeconds = timeImport(billsCsv, [&](istream& in, const string& path, char delimiter) { return importBills(billing, in, path, delimiter); }, billRows);
+    }
+    cout.rdbuf(previous);
+    filesystem::remove_all(directory);
+
+    auto report = [&](const string& label, size_t rows, double seconds) {
+        cout << "  " << label << ": " << rows << " rows in " << seconds * 1000 << " ms (" << (seconds > 0 ? rows / seconds / 1e6 : 0)
+             << "M rows/s)" << endl;
+    };
+    report("staff, getline + parseCsvLine + addStaff", lineRows, lineSeconds);
+    report("staff, CsvReader + reserve (CSV)", csvRows, csvSeconds);
+    report("staff, CsvReader + reserve (TSV)", tsvRows, tsvSeconds);
+    report("patients, CsvReader + reserve", patientRows, patientSeconds);
+    report("bills (half paid on load), CsvReader + reserve", billRows, billSeconds);
+    if (lineRows != size_t(count) || csvRows != size_t(count) || tsvRows != size_t(count) || patientRows != size_t(count) ||
+        billRows != size_t(count)) {
+        cout << "  warning: rows rejected during import" << endl;
+    }
+}
+
+// Times one listing written to a file through cout, so the stream's flushes
+// turn into real write calls
+template <typename Listing>
+double timeListing(const string& path, Listing listing) {
+    ofstream file(path, ios::trunc);
+    streambuf* previous = cout.rdbuf(file.rdbuf());
+    auto start = chrono::steady_clock::now();
+    listing();
+    double seconds = elapsedSeconds(start);
+    cout.rdbuf(previous);
+    return seconds;
+}
+
+void benchmarkListingDump() {
+    const int count = 1000000;
+    const vector<string> doctors = {"Dr. Ahmad", "Dr. Fatima", "Dr. Ibrahim", "Dr. Maham", "Dr. Shoaib", "Dr. Abbas", "Dr. Zarrar"};
+    const vector<string> roles = {"doctor", "nurses", "paramedics", "janitors"};
+    const vector<string> departments = {"Cardiology", "Neurology", "Emergency", "Pediatrics", "Orthopedics", "Gastroenterology"};
+    const vector<string> shifts = {"morning", "evening", "night"};
+    const vector<string> methods = {"Card", "Insurance", "Cash"};
+    cout << "Listing dump of " << count << " rows to a file: per-field cout with endl vs. buffered to_chars output" << endl;
+    string path = (filesystem::temp_directory_path() / "hms_bench_dump.txt").string();
+
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    PatientList patients;
+    StaffManagement staff;
+    BillingSystem billing;
+    mt19937 rng(23);
+    for (int id = 1; id <= count; id++) {
+        bool severe = id % 3 == 0;
+        patients.admitPatient(id, "Patient", 20 + id % 70, severe ? "severe" : "not_severe",
+                              severe ? "" : doctors[id % doctors.size()], severe ? "" : "9:00 AM on Monday");
+        staff.addStaff(id, "Staff", roles[id % roles.size()], departments[id % departments.size()], shifts[id % shifts.size()]);
+        billing.addBillingRecord(id, (rng() % 1000000) / 100.0, methods[id % methods.size()]);
+    }
+    cout.rdbuf(previous);
+
+    // The listings as they were written before the output buffer; rows are
+    // gathered up front so only the formatting and writing is timed
+    vector<const Staff*> staffRows = staff.queryStaff("", "", "");
+    vector<const BillingRecord*> billRows;
+    for (int id = 1; id <= count; id++) {
+        billRows.push_back(billing.findPendingBill(id));
+    }
+    auto patientsByStream = [&] {
+        for (const Patient* current = patients.searchPatientByID(count); current; current = current->next) {
+            cout << "ID: " << current->id << ", Name: " << current->name
+                 << ", Age: " << current->age << ", Condition: " << current->condition
+                 << ", Doctor: " << current->doctorName
+                 << ", Appointment: " << current->appointmentTime << endl;
+        }
+    };
+    auto staffByStream = [&] {
+        for (const Staff* current : staffRows) {
+            cout << "ID: " << current->id
+                 << ", Name: " << current->name
+                 << ", Role: " << current->role
+                 << ", Department: " << current->department
+                 << ", Shift: " << current->shift << endl;
+        }
+    };
+    auto billsByStream = [&] {
+        cout << "Pending Bills:" << endl;
+        for (const BillingRecord* record : billRows) {
+            cout << "Patient ID: " << record->patientID << ", Total Amount: " << record->totalAmount
+                 << ", Paid: " << (record->isPaid ? "Yes" : "No")
+                 << ", Payment Method: " << (record->isPaid ? record->paymentMethod.str() : "Not paid yet") << endl;
+        }
+    };
+
+    auto report = [&](const string& label, double before, double after) {
+        cout << "  " << label << ": " << before * 1000 << " ms -> " << after * 1000 << " ms (" << before * 1e9 / count << " -> "
+             << after * 1e9 / count << " ns/row, " << (after > 0 ? before / after : 0) << "x)" << endl;
+    };
+    report("patients", timeListing(path, patientsByStream), timeListing(path, [&] { patients.displayPatients(); }));
+    report("staff", timeListing(path, staffByStream), timeListing(path, [&] { staff.displayStaff(); }));
+    report("bills", timeListing(path, billsByStream), timeListing(path, [&] { billing.displayAllBills(); }));
+    cout << "  " << filesystem::file_size(path) / (1024.0 * 1024.0) << " MiB per bill listing" << endl;
+    filesystem::remove(path);
+}
+
+void benchmarkStartup() {
+    const int perManager = 250000;
+    string path = (filesystem::temp_directory_path() / "hms_bench_startup.snapshot").string();
+    cout << "Startup from a snapshot of " << perManager * 4 << " entities (patients, staff, bills, beds)" << endl;
+    {
+        Hospital hospital;
+        ofstream nullOutput;
+        streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+        for (int id = 1; id <= perManager; id++) {
+            hospital.patients.admitPatient(id, "Patient" + to_string(id), 20 + id % 70, id % 3 ? "not_severe" : "severe");
+            hospital.staff.addStaff(id, "Staff" + to_string(id), "nurses", "Cardiology", "night");
+            hospital.billing.addBillingRecord(id, id % 5000, "Card");
+            hospital.beds.addBeds(id);
+        }
+        cout.rdbuf(previous);
+        auto start = chrono::steady_clock::now();
+        writeHospitalSnapshot(hospital, path, 0);
+        printBenchResult("write snapshot", perManager * 4, elapsedSeconds(start));
+    }
+    cout << "  file size: " << filesystem::file_size(path) / (1024.0 * 1024.0) << " MiB" << endl;
+
+    auto start = chrono::steady_clock::now();
+    SnapshotView view;
+    view.open(path);
+    cout << "  map + validate header: " << elapsedSeconds(start) * 1000 << " ms" << endl;
+
+    mt19937 rng(5);
+    size_t lookups = 100000, hits = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) {
+        int id = rng() % perManager + 1;
+        hits += view.findPatient(id) != nullptr;
+        hits += view.findStaff(id) != nullptr;
+    }
+    printBenchResult("in-place lookups on the mapped file", lookups * 2, elapsedSeconds(start));
+
+    start = chrono::steady_clock::now();
+    bool intact = view.verifyPayload();
+    cout << "  verify payload checksum: " << elapsedSeconds(start) * 1000 << " ms" << (intact ? "" : " (MISMATCH)") << endl;
+
+    start = chrono::steady_clock::now();
+    {
+        Hospital hospital;
+        loadHospitalSnapshot(hospital, view);
+        cout << "  full load into the managers: " << elapsedSeconds(start) * 1000 << " ms" << endl;
+    }
+    if (hits != lookups * 2) {
+        cout << "  warning: missing entities during lookup" << endl;
+    }
+    filesystem::remove(path);
+}
+
+int runBenchmark(const string& name) {
+    if (name == "patients") {
+        benchmarkPatientLookup();
+    } else if (name == "beds") {
+        benchmarkBedAllocation();
+    } else if (name == "billing") {
+        benchmarkBilling();
+    } else if (name == "recovery") {
+        benchmarkRecovery();
+    } else if (name == "startup") {
+        benchmarkStartup();
+    } else if (name == "allocator") {
+        benchmarkAllocator();
+    } else if (name == "staff") {
+        benchmarkStaffGrowth();
+    } else if (name == "roster") {
+        benchmarkStaffRoster();
+    } else if (name == "records") {
+        benchmarkMedicalRecords();
+    } else if (name == "search") {
+        benchmarkTextSearch();
+    } else if (name == "memory") {
+        benchmarkRecordMemory();
+    } else if (name == "census") {
+        benchmarkCensus();
+    } else if (name == "scheduler") {
+        benchmarkScheduler();
+    } else if (name == "service") {
+        benchmarkService();
+    } else if (name == "bedsurge") {
+        benchmarkBedContention();
+    } else if (name == "settlement") {
+        benchmarkSettlement();
+    } else if (name == "audit") {
+        benchmarkAuditLog();
+    } else if (name == "dump") {
+        benchmarkListingDump();
+    } else if (name == "import") {
+        benchmarkBulkImport();
+    } else if (name == "cdc") {
+        benchmarkChangeFeed();
+    } else {
+        cerr << "Unknown benchmark '" << name << "'. Available: patients, beds, billing, recovery, startup, allocator, staff, roster, records, search, memory, census, scheduler, service, bedsurge, settlement, audit, dump, import, cdc" << endl;
+        return 1;
+    }
+    return 0;
+}
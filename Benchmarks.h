@@ -0,0 +1,9 @@
+#ifndef HMS_BENCHMARKS_H
+#define HMS_BENCHMARKS_H
+
+#include <string>
+
+// Runs the named micro-benchmark ("all" runs every one); returns the process exit code
+int runBenchmark(const std::string& name);
+
+#endif // HMS_BENCHMARKS_H
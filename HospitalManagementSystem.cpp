@@ -1,1171 +1,1143 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <stdexcept>
-#include <limits>
-#include <fstream>
-#include <sstream>
-#include <algorithm>
-#include <cctype>
-#include <unordered_map>
-#include <queue>
-
-using namespace std;
-
-// ================= Utility Functions =================
-bool isAlphaString(const string& str) {
-    for (char c : str) {
-        if (!isalpha(c)) return false;
-    }
-    return true;
-}
-
-bool isNumericString(const string& str) {
-    if (str.empty()) {
-        return false;
-    }
-    for (char c : str) {
-        if (!isdigit(c)) {
-            return false;
-        }
-    }
-    return true;
-}
-
-int getValidatedInt(const string& prompt) {
-    int value;
-    while (true) {
-        cout << prompt;
-        cin >> value;
-
-        if (cin.fail()) {
-            cout << "Invalid input. Please enter a valid integer." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        } else {
-            return value;
-        }
-    }
-}
-
-double getValidatedDouble(const string& prompt) {
-    double value;
-    while (true) {
-        cout << prompt;
-        cin >> value;
-
-        if (cin.fail()) {
-            cout << "Invalid input. Please enter a valid number." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        } else {
-            return value;
-        }
-    }
-}
-
-string getValidatedString(const string& prompt) {
-    string value;
-    while (true) {
-        cout << prompt;
-        getline(cin, value);
-        bool hasDigit = false;
-        for (char ch : value) {
-            if (isdigit(ch)) {
-                hasDigit = true;
-                break;
-            }
-        }
-        if (value.empty()) {
-            cout << "Input cannot be empty. Please try again.\n";
-        } else if (hasDigit) {
-            cout << "Input cannot contain numbers. Please enter a valid string.\n";
-        } else {
-            return value;
-        }
-    }
-}
-
-string getValidatedRole(const string& prompt) {
-    string value;
-    const vector<string> validRoles = {"doctor", "nurses", "paramedics", "janitors"};
-    while (true) {
-        cout << prompt;
-        getline(cin, value);
-        for (const string& role : validRoles) {
-            if (value == role) {
-                return value;
-            }
-        }
-        cout << "Invalid role. Please enter one of the following: doctor, nurses, paramedics, janitors.\n";
-    }
-}
-
-
-// ================= Patient Management =================
-struct Patient {
-    int id;
-    string name;
-    int age;
-    string condition;
-    string doctorName;
-    string appointmentTime;
-    Patient* next;
-
-    Patient(int id, string name, int age, string condition, string doctorName = "", string appointmentTime = "")
-        : id(id), name(name), age(age), condition(condition), doctorName(doctorName), appointmentTime(appointmentTime), next(nullptr) {}
-};
-
-class PatientList {
-private:
-    Patient* head;
-
-public:
-    PatientList() : head(nullptr) {}
-
-    void admitPatient(int id, string name, int age, string condition, string doctorName = "", string appointmentTime = "") {
-        Patient* newPatient = new Patient(id, name, age, condition, doctorName, appointmentTime);
-        newPatient->next = head;
-        head = newPatient;
-    }
-
-    void displayPatients() const {
-        Patient* current = head;
-        while (current) {
-            cout << "ID: " << current->id << ", Name: " << current->name
-                 << ", Age: " << current->age << ", Condition: " << current->condition
-                 << ", Doctor: " << current->doctorName
-                 << ", Appointment: " << current->appointmentTime << endl;
-            current = current->next;
-        }
-    }
-
-    Patient* searchPatientByID(int id) {
-        Patient* current = head;
-        while (current) {
-            if (current->id == id) {
-                return current;
-            }
-            current = current->next;
-        }
-        return nullptr;
-    }
-
-    ~PatientList() {
-        Patient* current = head;
-        while (current) {
-            Patient* temp = current;
-            current = current->next;
-            delete temp;
-        }
-    }
-};
-
-// ================= Doctor Management =================
-struct Doctor {
-    string name;
-    string specialization;
-    vector<pair<string, string>> availableTimes; // Time paired with day of the week
-    vector<bool> appointmentAvailable; // Tracks availability of appointment times
-
-    Doctor(string name, string specialization, vector<pair<string, string>> availableTimes)
-        : name(name), specialization(specialization), availableTimes(availableTimes), appointmentAvailable(availableTimes.size(), true) {}
-};
-
-class DoctorManagement {
-private:
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> appointmentPriorityQueue; // Using a min-heap for priority-based appointments
-    vector<Doctor> doctors;
-
-public:
-    DoctorManagement() {
-        doctors.push_back(Doctor("Dr. Ahmad", "Cardiologist", {{"9:00 AM", "Monday"}, {"10:00 AM", "Tuesday"}, {"11:00 AM", "Thursday"}}));
-        doctors.push_back(Doctor("Dr. Fatima", "Dermatologist", {{"9:30 AM", "Wednesday"}, {"10:30 AM", "Friday"}, {"1:00 PM", "Monday"}}));
-        doctors.push_back(Doctor("Dr. Ibrahim", "Neurologist", {{"10:00 AM", "Tuesday"}, {"12:00 PM", "Wednesday"}, {"2:00 PM", "Thursday"}}));
-        doctors.push_back(Doctor("Dr. Maham", "Orthopedist", {{"8:30 AM", "Monday"}, {"2:00 PM", "Tuesday"}, {"11:00 AM", "Wednesday"}}));
-        doctors.push_back(Doctor("Dr. Shoaib", "Pediatrician", {{"9:00 AM", "Friday"}, {"2:00 PM", "Saturday"}, {"10:00 AM", "Sunday"}}));
-        doctors.push_back(Doctor("Dr. Abbas", "Oncologist", {{"10:00 AM", "Monday"}, {"3:00 PM", "Wednesday"}, {"1:00 PM", "Friday"}}));
-        doctors.push_back(Doctor("Dr. Zarrar", "Gastroenterologist", {{"8:00 AM", "Tuesday"}, {"11:00 AM", "Thursday"}, {"2:30 PM", "Friday"}}));
-    }
-
-    void showDoctors() {
-        cout << "From whom you want a checkup:" << endl;
-        for (int i = 0; i < doctors.size(); i++) {
-            cout << i + 1 << ". " << doctors[i].name << " - " << doctors[i].specialization << endl;
-            cout << "Available times: " << endl;
-            for (size_t j = 0; j < doctors[i].availableTimes.size(); j++) {
-                if (doctors[i].appointmentAvailable[j]) {
-                    cout << doctors[i].availableTimes[j].first << " on " << doctors[i].availableTimes[j].second << endl;
-                }
-            }
-            cout << endl;
-        }
-    }
-
-    bool allocateDoctorAppointment(int doctorIndex, string& appointmentTime) {
-        if (doctorIndex < 0 || doctorIndex >= doctors.size()) return false;
-
-        Doctor& doctor = doctors[doctorIndex];
-
-        // Ask the user to select an appointment time from available options
-        cout << "Choose an available appointment time:\n";
-        vector<int> availableTimesIndex;
-        for (size_t i = 0; i < doctor.availableTimes.size(); ++i) {
-            if (doctor.appointmentAvailable[i]) {
-                cout << doctor.availableTimes[i].first << " on " << doctor.availableTimes[i].second << "\n";
-                availableTimesIndex.push_back(i);
-            }
-        }
-
-        if (availableTimesIndex.empty()) {
-            cout << "No appointments available for Dr. " << doctor.name << " in this week.\n";
-            return false;
-        }
-
-        int timeChoice;
-        while (true) {
-            cout << "Enter the number for your appointment choice: ";
-            string input;
-            cin >> input;
-
-            if (isNumericString(input)) {
-                timeChoice = stoi(input);
-
-                if (timeChoice > 0 && timeChoice <= availableTimesIndex.size()) {
-                    int selectedIndex = availableTimesIndex[timeChoice - 1];
-                    appointmentTime = doctor.availableTimes[selectedIndex].first + " on " + doctor.availableTimes[selectedIndex].second;
-                    doctor.appointmentAvailable[selectedIndex] = false; // Mark this time as booked
-                    return true;
-                } else {
-                    cout << "Invalid choice. Please try again.\n";
-                }
-            } else {
-                cout << "Wrong choice. Please enter a valid number.\n";
-            }
-        }
-
-        return false;
-    }
-
-    int getDoctorsCount() const {
-        return doctors.size();
-    }
-
-    string getDoctorName(int index) {
-        if (index < 0 || index >= doctors.size()) {
-            return "Invalid doctor index";
-        }
-        return doctors[index].name;
-    }
-
-    string getDoctorSpecialization(int index) {
-        if (index < 0 || index >= doctors.size()) {
-            return "Invalid doctor index";
-        }
-        return doctors[index].specialization;
-    }
-};
-
-// ================= Bed Management =================
-struct BedNode {
-    int bedNumber;
-    bool isAvailable;
-    int height;
-    BedNode* left;
-    BedNode* right;
-
-    BedNode(int bedNumber)
-        : bedNumber(bedNumber), isAvailable(true), height(1), left(nullptr), right(nullptr) {}
-};
-
-class BedManagement {
-private:
-    BedNode* root;
-    vector<int> waitingList;
-
-    int getHeight(BedNode* node) {
-        return node ? node->height : 0;
-    }
-
-    int getBalanceFactor(BedNode* node) {
-        return node ? getHeight(node->left) - getHeight(node->right) : 0;
-    }
-
-    BedNode* rotateRight(BedNode* y) {
-        BedNode* x = y->left;
-        BedNode* T2 = x->right;
-
-        x->right = y;
-        y->left = T2;
-
-        y->height = max(getHeight(y->left), getHeight(y->right)) + 1;
-        x->height = max(getHeight(x->left), getHeight(x->right)) + 1;
-
-        return x;
-    }
-
-    BedNode* rotateLeft(BedNode* x) {
-        BedNode* y = x->right;
-        BedNode* T2 = y->left;
-
-        y->left = x;
-        x->right = T2;
-
-        x->height = max(getHeight(x->left), getHeight(x->right)) + 1;
-        y->height = max(getHeight(y->left), getHeight(y->right)) + 1;
-
-        return y;
-    }
-
-    BedNode* balance(BedNode* node) {
-        int balanceFactor = getBalanceFactor(node);
-
-        if (balanceFactor > 1 && getBalanceFactor(node->left) >= 0)
-            return rotateRight(node);
-
-        if (balanceFactor < -1 && getBalanceFactor(node->right) <= 0)
-            return rotateLeft(node);
-
-        if (balanceFactor > 1 && getBalanceFactor(node->left) < 0) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
-        }
-
-        if (balanceFactor < -1 && getBalanceFactor(node->right) > 0) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
-        }
-
-        return node;
-    }
-
-    BedNode* addBed(BedNode* node, int bedNumber) {
-        if (!node) return new BedNode(bedNumber);
-
-        if (bedNumber < node->bedNumber)
-            node->left = addBed(node->left, bedNumber);
-        else if (bedNumber > node->bedNumber)
-            node->right = addBed(node->right, bedNumber);
-
-        node->height = max(getHeight(node->left), getHeight(node->right)) + 1;
-
-        return balance(node);
-    }
-
-    BedNode* searchBed(BedNode* node, bool* found) {
-        if (!node) return nullptr;
-
-        if (node->isAvailable) {
-            *found = true;
-            return node;
-        }
-
-        BedNode* leftSearch = searchBed(node->left, found);
-        if (*found) return leftSearch;
-
-        return searchBed(node->right, found);
-    }
-
-public:
-    BedManagement() : root(nullptr) {}
-
-    void addBeds(int bedNumber) {
-        root = addBed(root, bedNumber);
-    }
-
-    void allocateBed(int patientId) {
-        bool found = false;
-        BedNode* bed = searchBed(root, &found);
-
-        if (found && bed) {
-            bed->isAvailable = false;
-            cout << "Bed " << bed->bedNumber << " allocated to patient ID " << patientId << " successfully." << endl;
-        } else {
-            cout << "No beds available. Adding patient ID " << patientId << " to waiting list." << endl;
-            waitingList.push_back(patientId);
-        }
-    }
-};
-
-
-// ================= Billing System =================
-struct BillingRecord {
-    int patientID;
-    double totalAmount;
-    bool isPaid;
-    string paymentMethod;
-
-    BillingRecord(int id, double amount, const string& payment = "")
-        : patientID(id), totalAmount(amount), isPaid(false), paymentMethod(payment) {}
-
-    void displayBill() const {
-        cout << "Patient ID: " << patientID << ", Total Amount: " << totalAmount
-             << ", Paid: " << (isPaid ? "Yes" : "No")
-             << ", Payment Method: " << (isPaid ? paymentMethod : "Not paid yet") << endl;
-    }
-};
-
-class BillingSystem {
-private:
-    vector<BillingRecord> maxHeap;
-    vector<BillingRecord> paidBills;
-    vector<BillingRecord> records;
-    
-    void heapifyUp(int index) {
-        while (index > 0) {
-            int parent = (index - 1) / 2;
-            if (maxHeap[parent].totalAmount >= maxHeap[index].totalAmount) {
-                break;
-            }
-            swap(maxHeap[parent], maxHeap[index]);
-            index = parent;
-        }
-    }
-
-    void heapifyDown(int index) {
-        int size = maxHeap.size();
-        while (index < size) {
-            int leftChild = 2 * index + 1;
-            int rightChild = 2 * index + 2;
-            int largest = index;
-
-            if (leftChild < size && maxHeap[leftChild].totalAmount > maxHeap[largest].totalAmount) {
-                largest = leftChild;
-            }
-
-            if (rightChild < size && maxHeap[rightChild].totalAmount > maxHeap[largest].totalAmount) {
-                largest = rightChild;
-            }
-
-            if (largest == index) {
-                break;
-            }
-
-            swap(maxHeap[index], maxHeap[largest]);
-            index = largest;
-        }
-    }
-
-public:
-    void addBillingRecord(int patientID, double totalAmount, const string& paymentMethod) {
-        // Check if a billing record for the same patient ID exists
-        for (auto& record : maxHeap) {
-            if (record.patientID == patientID) {
-                record.totalAmount += totalAmount;
-                record.paymentMethod = paymentMethod;
-                cout << "Billing record updated for Patient ID " << patientID << endl;
-                return;
-            }
-        }
-        // If no existing record, create a new one
-        maxHeap.emplace_back(patientID, totalAmount, paymentMethod);
-        heapifyUp(maxHeap.size() - 1);
-    }
-    
-    void markAsPaid() {
-        if (maxHeap.empty()) {
-            throw runtime_error("No bills to mark as paid.");
-        }
-
-        BillingRecord record = maxHeap[0];
-        record.isPaid = true;
-        paidBills.push_back(record);
-
-        maxHeap[0] = maxHeap.back();
-        maxHeap.pop_back();
-        heapifyDown(0);
-
-        cout << "Bill for Patient ID " << record.patientID << " has been marked as paid." << endl;
-    }
-
-    void markBillAsPaidByID(int patientID) {
-        bool found = false;
-        // Search for the bill by Patient ID in the pending bills
-        for (auto& record : maxHeap) {
-            if (record.patientID == patientID && !record.isPaid) {
-                record.isPaid = true;  // Mark as paid
-                paidBills.push_back(record);  // Move to the paid bills
-                found = true;
-                break;  // Exit once the bill is found and processed
-            }
-        }
-    
-        if (found) {
-            // Remove the bill from pending bills (since it's now marked as paid)
-            for (auto it = maxHeap.begin(); it != maxHeap.end(); ++it) {
-                if (it->patientID == patientID && !it->isPaid) {
-                    maxHeap.erase(it);  // Erase the record from the pending list
-                    break;
-                }
-            }
-            cout << "Bill for Patient ID " << patientID << " has been marked as paid." << endl;
-        } else {
-            cout << "No pending bill found for Patient ID " << patientID << "." << endl;
-        }
-    }
-    
-    void displayAllBills() const {
-        if (maxHeap.empty()) {
-            cout << "No pending bills." << endl;
-        } else {
-            cout << "Pending Bills:" << endl;
-            for (const auto& record : maxHeap) {
-                record.displayBill();
-            }
-        }
-
-        if (paidBills.empty()) {
-            cout << "No paid bills." << endl;
-        } else {
-            cout << "Paid Bills:" << endl;
-            for (const auto& record : paidBills) {
-                record.displayBill();
-            }
-        }
-    }
-
-    void searchBillByID(int patientID) const {
-        bool found = false;
-        for (const auto& record : maxHeap) {
-            if (record.patientID == patientID) {
-                record.displayBill();
-                found = true;
-            }
-        }
-        for (const auto& record : paidBills) {
-            if (record.patientID == patientID) {
-                record.displayBill();
-                found = true;
-            }
-        }
-        if (!found) {
-            cout << "No bill found for Patient ID " << patientID << "." << endl;
-        }
-    }
-};
-
-
-string getValidatedPaymentMethod() {
-    string paymentMethod;
-    while (true) {
-        cout << "Enter Payment Method (Card, Insurance, Cash): ";
-        cin >> paymentMethod;
-
-        if (paymentMethod == "Card" || paymentMethod == "Insurance" || paymentMethod == "Cash") {
-            return paymentMethod;
-        } else {
-            cout << "Invalid payment method. Please choose from 'Card', 'Insurance', or 'Cash'." << endl;
-        }
-    }
-}
-
-// ================= Medical Records =================
-struct MedicalRecord {
-    int patientID;
-    string name;
-    int age;
-    string medicalHistory;
-    string prescriptions;
-    string doctorNotes;
-    MedicalRecord* next;
-};
-
-class MedicalSystem {
-private:
-    vector<MedicalRecord> records;
-
-public:
-    MedicalRecord* head = nullptr;
-    // Function to add a medical record
-    void addRecord() {
-        MedicalRecord* newRecord = new MedicalRecord;
-    
-        while (true) {
-        cout << "Enter Patient ID: " ;
-        cin >> newRecord->patientID;
-
-        if (cin.fail()) {
-            cin.clear();  // Clear error flag
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
-            cout << "Invalid input. Please enter a numeric Patient ID.\n";
-            continue;  // Retry the input
-        }
-        cin.ignore();  // Consume the leftover newline character
-        break;
-     } // To consume the leftover newline character
-    
-        cout << "Enter Name: ";
-        getline(cin, newRecord->name);
-    
-        while(true){
-            cout << "Enter Age: ";
-            cin >> newRecord->age;
-            if (cin.fail()) {
-                    cin.clear();  // Clear error flag
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
-                    cout << "Invalid input. Please enter a valid age.\n";
-                    continue;  // Retry the input
-                }
-                cin.ignore();  // Consume the leftover newline character
-                break;
-            }
-    
-        cout << "Enter Medical History: ";
-        getline(cin, newRecord->medicalHistory);
-    
-        cout << "Enter Prescriptions: ";
-        getline(cin, newRecord->prescriptions);
-    
-        cout << "Enter Doctor Notes: ";
-        getline(cin, newRecord->doctorNotes);
-    
-        newRecord->next = nullptr;
-    
-        // Insert at the end of the linked list
-        if (head == nullptr) {
-            head = newRecord;
-        } else {
-            MedicalRecord* temp = head;
-            while (temp->next != nullptr) {
-                temp = temp->next;
-            }
-            temp->next = newRecord;
-        }
-    
-        cout << "Record added successfully!\n";
-    }
-    
-    void searchRecord() {
-        int id;
-        while(true){
-            cout << "Enter Patient ID to search: ";
-            cin >> id;
-            if (cin.fail()) {
-                    cin.clear();  // Clear error flag
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
-                    cout << "Invalid input. Please enter a Patient id with valid integers.\n";
-                    continue;  // Retry the input
-                }
-                cin.ignore();  // Consume the leftover newline character
-                break;
-            }
-    
-        MedicalRecord* temp = head;
-        while (temp != nullptr) {
-            if (temp->patientID == id) {
-                cout << "\nRecord Found:\n";
-                cout << "Name: " << temp->name << "\nAge: " << temp->age << "\nMedical History: " 
-                     << temp->medicalHistory << "\nPrescriptions: " << temp->prescriptions 
-                     << "\nDoctor Notes: " << temp->doctorNotes << endl;
-                return;
-            }
-            temp = temp->next;
-        }
-        cout << "Record not found.\n";
-    }
-    
-    // Function to update a medical record by Patient ID
-    void updateRecord() {
-        int id;
-        while(true){
-            cout << "Enter Patient ID to update: ";
-            cin >> id;
-            if (cin.fail()) {
-                    cin.clear();  // Clear error flag
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
-                    cout << "Invalid input. Please enter a Patient id with valid integers.\n";
-                    continue;  // Retry the input
-                }
-                cin.ignore();  // Consume the leftover newline character
-                break;
-            }
-    
-        MedicalRecord* temp = head;
-        while (temp != nullptr) {
-            if (temp->patientID == id) {
-                cout << "Enter New Prescriptions: ";
-                getline(cin, temp->prescriptions);
-    
-                cout << "Enter New Doctor Notes: ";
-                getline(cin, temp->doctorNotes);
-    
-                cout << "Record updated successfully!\n";
-                return;
-            }
-            temp = temp->next;
-        }
-        cout << "Record not found.\n";
-    }
-    
-    void deleteRecord() {
-        int id;
-        while(true){
-        cout << "Enter Patient ID to delete: ";
-        cin >> id;
-        if (cin.fail()) {
-                cin.clear();  // Clear error flag
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
-                cout << "Invalid input. Please enter a Patient id with valid integers.\n";
-                continue;  // Retry the input
-            }
-            cin.ignore();  // Consume the leftover newline character
-            break;
-        }
-    
-        MedicalRecord* temp = head;
-        MedicalRecord* prev = nullptr;
-    
-        while (temp != nullptr && temp->patientID != id) {
-            prev = temp;
-            temp = temp->next;
-        }
-    
-        if (temp == nullptr) {
-            cout << "Record not found.\n";
-            return;
-        }
-    
-        if (prev == nullptr) { // Deleting the head node
-            head = temp->next;
-        } else {
-            prev->next = temp->next;
-        }
-        delete temp;
-        cout << "Record deleted successfully!\n";
-    }
-
-    void displayRecords() {
-        if (head == nullptr) {
-            cout << "No records to display.\n";
-            return;
-        }
-    
-        MedicalRecord* temp = head;
-        while (temp != nullptr) {
-            cout << "\nPatient ID: " << temp->patientID
-                 << "\nName: " << temp->name
-                 << "\nAge: " << temp->age
-                 << "\nMedical History: " << temp->medicalHistory
-                 << "\nPrescriptions: " << temp->prescriptions
-                 << "\nDoctor Notes: " << temp->doctorNotes
-                 << "\n-------------------------\n";
-            temp = temp->next;
-        }
-    }
-};
-
-// ================= Staff Management =================
-struct Staff {
-    int id;
-    string name;
-    string role;
-    string department;
-    string shift;
-    Staff* next; // Pointer for chaining
-};
-
-class StaffManagement {
-private:
-    vector<Staff> staffList;
-     vector<Staff*> table;
-    int numEntries; // Number of elements in the table
-    const double loadFactorThreshold = 0.75; // Resize when load factor exceeds this threshold
-    
-    // Hash function for staff ID
-    int hashFunction(int id) {
-        return id % table.size();
-    }
-
-    // Resize the hash table when the load factor is exceeded
-    void resizeTable() {
-        vector<Staff*> oldTable = table;
-        table.resize(oldTable.size() * 2, nullptr);
-        numEntries = 0;
-        for (Staff* head : oldTable) {
-            while (head != nullptr) {
-                Staff* temp = head;
-                head = head->next;
-                addStaff(temp->id, temp->name, temp->role, temp->department, temp->shift);
-                delete temp;
-            }
-        }
-    }
-
-public:
-    StaffManagement(int initialSize = 10) : numEntries(0) {
-        if (initialSize <= 0) {
-            throw invalid_argument("Initial size of the table must be greater than zero.");
-        }
-        table.resize(initialSize, nullptr);
-    }
-
-    ~StaffManagement() {
-        for (Staff* head : table) {
-            while (head != nullptr) {
-                Staff* temp = head;
-                head = head->next;
-                delete temp;
-            }
-        }
-    }
-    void addStaff(int id, const string& name, const string& role, const string& department, const string& shift) {
-    if (id < 0) {
-        throw invalid_argument("ID cannot be negative.");
-    }
-
-    // Check for duplicate ID
-    int index = hashFunction(id);
-    Staff* current = table[index];
-    while (current != nullptr) {
-        if (current->id == id) {
-            cout << "Error: Staff with ID " << id << " already exists." << endl;
-            return;
-        }
-        current = current->next;
-    }
-    // Add new staff if ID is unique
-    Staff* newStaff = new Staff{id, name, role, department, shift, table[index]};
-    table[index] = newStaff;
-    numEntries++;
-
-    if (static_cast<double>(numEntries) / table.size() > loadFactorThreshold) {
-        resizeTable();
-    }
-}
-
-
-    void displayStaff() {
-        for (size_t i = 0; i < table.size(); i++) {
-            Staff* current = table[i];
-            while (current != nullptr) {
-                cout << "ID: " << current->id
-                     << ", Name: " << current->name
-                     << ", Role: " << current->role
-                     << ", Department: " << current->department
-                     << ", Shift: " << current->shift << endl;
-                current = current->next;
-            }
-        }
-    }
-    
-    void searchStaff(int id) {
-        if (id < 0) {
-            cout << "Invalid ID. Please enter a non-negative integer." << endl;
-            return;
-        }
-        int index = hashFunction(id);
-        Staff* current = table[index];
-        while (current != nullptr) {
-            if (current->id == id) {
-                cout << "Staff found: " << endl;
-                cout << "ID: " << current->id
-                     << ", Name: " << current->name
-                     << ", Role: " << current->role
-                     << ", Department: " << current->department
-                     << ", Shift: " << current->shift << endl;
-                return;
-            }
-            current = current->next;
-        }
-        cout << "Staff with ID " << id << " not found." << endl;
-    }
-    
-    void deleteStaff(int id) {
-        if (id < 0) {
-            cout << "Invalid ID. Please enter a non-negative integer." << endl;
-            return;
-        }
-        int index = hashFunction(id);
-        Staff* current = table[index];
-        Staff* prev = nullptr;
-        while (current != nullptr) {
-            if (current->id == id) {
-                if (prev == nullptr) {
-                    table[index] = current->next;
-                } else {
-                    prev->next = current->next;
-                }
-                delete current;
-                numEntries--;
-                cout << "Staff with ID " << id << " has been deleted." << endl;
-                return;
-            }
-            prev = current;
-            current = current->next;
-        }
-        cout << "Staff with ID " << id << " not found." << endl;
-    }
-    
-    
-};
-
-
-// ================= Main System =================
-int main() {
-    MainMenu:
-    PatientList patientList;
-    BillingSystem billingSystem;
-    MedicalSystem medicalSystem;
-    BedManagement bedManagement;
-    StaffManagement staffManagement;
-    DoctorManagement doctorManagement;
-
-    int choice;
-    do {
-        cout << "\nWelcome to Hospital Management System\n";
-        cout << "1. Manage Staff\n";
-        cout << "2. Manage Patients\n";
-        cout << "3. Manage Medical Records\n";
-        cout << "4. Manage Billing\n";
-        cout << "5. Exit\n";
-        choice = getValidatedInt("Enter your choice: ");
-
-        switch (choice) {
-            case 1: {
-                int choice;
-                do {
-                    cout << "\n----Staff Management System----\n";
-                    cout << "1. Add Staff\n";
-                    cout << "2. Display Staff\n";
-                    cout << "3. Search Staff\n";
-                    cout << "4. Delete Staff\n";
-                    cout << "5. Back to Main Menu\n";
-                    choice = getValidatedInt("Enter your choice: ");
-                    
-                    switch (choice) {
-                        case 1: {
-                            int id = getValidatedInt("Enter ID: ");
-                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
-                            string name = getValidatedString("Enter Name: ");
-                            string role = getValidatedRole("Enter Role: ");
-                            string department = getValidatedString("Enter Department: ");
-                            string shift = getValidatedString("Enter Shift: ");
-                            try {
-                                staffManagement.addStaff(id, name, role, department, shift);
-                                cout << "Staff added successfully." << endl;
-                            } catch (const exception& e) {
-                                cout << "Error: " << e.what() << endl;
-                            }
-                            break;
-                        }
-                        case 2:
-                            staffManagement.displayStaff();
-                            break;
-                        case 3: {
-                            int id = getValidatedInt("Enter ID to search: ");
-                            staffManagement.searchStaff(id);
-                            break;
-                        }
-                        case 4: {
-                            int id = getValidatedInt("Enter ID to delete: ");
-                            staffManagement.deleteStaff(id);
-                            break;
-                        }
-                        case 5:
-                            goto MainMenu;   
-                        default:
-                            cout << "Invalid choice. Please try again." << endl;
-                    }
-                } while (choice != 5);
-                break;
-            }
-            
-            case 2: {
-                for (int i = 1; i <= 5; i++) {
-                    bedManagement.addBeds(i);
-                }
-
-                int patientCounter = 1;
-                while (true) {
-                    string name, condition;
-                    string ageInput;
-                    int age;
-
-                    cout << "\nEnter Patient Name (or 'back' to go to main Menu): ";
-                    cin >> name;
-
-                    if (name == "back") break;
-
-                    if (!isAlphaString(name)) {
-                        cout << "Please enter a valid name." << endl;
-                        continue;
-                    }
-
-                    while (true) { 
-                        cout << "Enter Patient Age: ";
-                        cin >> ageInput;
-
-                        try {
-                            if (!isNumericString(ageInput)) {
-                                throw invalid_argument("Age must be numeric.");
-                            }
-
-                            age = stoi(ageInput);
-                            if (age <= 0 || age > 110) {
-                                throw out_of_range("Age must be between 1 and 110.");
-                            }
-
-                            break; // Age input is valid, break the loop
-
-                        } catch (const invalid_argument& e) {
-                            cout << "Invalid input: " << e.what() << ". Please enter age again." << endl;
-                        } catch (const out_of_range& e) {
-                            cout << "Out of range error: " << e.what() << ". Please enter age again." << endl;
-                        }
-                    }
-
-                    cout << "Enter Condition (s for severe, ns for not_severe): ";
-                    cin >> condition;
-
-                    if (condition == "s") {
-                        // For severe patients, admit them and allocate a bed
-                        patientList.admitPatient(patientCounter, name, age, "severe", "", "");
-                        bedManagement.allocateBed(patientCounter);
-                        cout << "Patient " << name << " admitted successfully." << endl;
-                        ++patientCounter; // Increment the patient counter
-                    } else if (condition == "ns") {
-                        // For non-severe patients, show doctor options and schedule an appointment
-                        doctorManagement.showDoctors();
-
-                        int doctorChoice;
-
-                        while (true) {
-                            string doctorChoiceInput;
-
-                            cout << "Select a doctor by number: ";
-                            cin >> doctorChoiceInput;
-
-                            try {
-                                if (!isNumericString(doctorChoiceInput)) {
-                                    throw invalid_argument("Doctor choice must be numeric.");
-                                }
-
-                                doctorChoice = stoi(doctorChoiceInput);
-
-                                if (doctorChoice > 0 && doctorChoice <= doctorManagement.getDoctorsCount()) {
-                                    string appointmentTime;
-                                    if (doctorManagement.allocateDoctorAppointment(doctorChoice - 1, appointmentTime)) {
-                                        // Schedule appointment for non-severe patients
-                                        string selectedDoctorName = doctorManagement.getDoctorName(doctorChoice - 1);
-                                        string selectedDoctorSpecialization = doctorManagement.getDoctorSpecialization(doctorChoice - 1);
-                                        patientList.admitPatient(patientCounter, name, age, "not_severe", selectedDoctorName, appointmentTime);
-                                        cout << "Appointment scheduled with " << selectedDoctorName << " (" << selectedDoctorSpecialization << ") at " << appointmentTime << endl;
-                                        ++patientCounter; // Increment patient counter
-                                        break;
-                                    }
-                                } else {
-                                    cout << "Invalid doctor choice. Please choose again." << endl;
-                                }
-                            } catch (const invalid_argument& e) {
-                                cout << "Invalid input: " << e.what() << ". Please choose a valid doctor." << endl;
-                            }
-                        }
-                    } else {
-                        cout << "Invalid condition entered. Please try again.\n";
-                    }
-                }
-                break;
-            }
-            
-            case 3: {
-                int choice;
-                do {
-                    cout << "\n----Medical Records----";
-                    cout << "\n1. Add Record";
-                    cout << "\n2. Search Record";
-                    cout << "\n3. Update Record";
-                    cout << "\n4. Delete Record";
-                    cout << "\n5. Display All Records";
-                    cout << "\n6. Back to Main Menu";
-                    choice = getValidatedInt("\nEnter your choice: ");
-            
-                    switch (choice) {
-                        case 1: {
-                            medicalSystem.addRecord(); 
-                            break;
-                        }
-                        case 2: {
-                            medicalSystem.searchRecord(); 
-                            break;
-                        }
-                        case 3: {
-                            medicalSystem.updateRecord(); 
-                            break;
-                        }
-                        case 4: {
-                            medicalSystem.deleteRecord(); 
-                            break;
-                        }
-                        case 5: {
-                            medicalSystem.displayRecords(); 
-                            break;
-                        }
-                        case 6: {
-                            break;
-                        }
-                        default: cout << "Invalid choice. Please try again.\n";
-                    }
-                } while (choice != 6);
-                break;
-            }
-
-           case 4: {
-            int choice;
-            while (true) {
-                try {
-                    cout << "\n----Billing System----" << endl;
-                    cout << "1. Add Billing Record" << endl;
-                    cout << "2. Mark Top Bill as Paid" << endl;
-                    cout << "3. Display All Bills" << endl;
-                    cout << "4. Search Bill by Patient ID" << endl;
-                    cout << "5. Mark Bill as Paid by Patient ID" << endl;
-                    cout << "6. Back to Main Menu" << endl;
-                    choice = getValidatedInt("Enter your choice: ");
-        
-                    switch (choice) {
-                        case 1: {
-                            int patientID = getValidatedInt("Enter Patient ID: ");
-                            double totalAmount = getValidatedDouble("Enter Total Amount: ");
-                            string paymentMethod = getValidatedPaymentMethod();
-                            billingSystem.addBillingRecord(patientID, totalAmount, paymentMethod);
-                            break;
-                        }
-                        case 2:
-                            billingSystem.markAsPaid();
-                            break;
-                        case 3:
-                            billingSystem.displayAllBills();
-                            break;
-                        case 4: {
-                            int patientID = getValidatedInt("Enter Patient ID to search: ");
-                            billingSystem.searchBillByID(patientID);
-                            break;
-                        }
-                        case 5: {
-                            int patientID = getValidatedInt("Enter Patient ID to mark as paid: ");
-                            billingSystem.markBillAsPaidByID(patientID);
-                            break;
-                        }
-                        case 6:
-                            // Return to main menu
-                            goto MainMenu;
-                        default:
-                            cout << "Invalid choice. Please select a valid option." << endl;
-                    }
-                } catch (const exception& e) {
-                    cout << "Error: " << e.what() << endl;
-                }
-            }
-            break;
-        }
-
-            case 5:
-                cout << "Goodbye!" << endl;
-                break;
-            default:
-                cout << "Invalid choice. Please try again." << endl;
-        }
-    } while (choice != 5);
-
-    return 0;
-}
+#include "HospitalManagementSystem.h"
+
+// ================= Utility Functions =================
+bool isAlphaString(string_view str) {
+    for (char c : str) {
+        if (!isalpha(c)) return false;
+    }
+    return true;
+}
+
+bool isNumericString(const string& str) {
+    if (str.empty()) {
+        return false;
+    }
+    for (char c : str) {
+        if (!isdigit(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int getValidatedInt(const string& prompt) {
+    int value;
+    while (true) {
+        cout << prompt;
+        cin >> value;
+
+        if (cin.fail()) {
+            cout << "Invalid input. Please enter a valid integer." << endl;
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else {
+            return value;
+        }
+    }
+}
+
+double getValidatedDouble(const string& prompt) {
+    double value;
+    while (true) {
+        cout << prompt;
+        cin >> value;
+
+        if (cin.fail()) {
+            cout << "Invalid input. Please enter a valid number." << endl;
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else {
+            return value;
+        }
+    }
+}
+
+string getValidatedString(const string& prompt) {
+    string value;
+    while (true) {
+        cout << prompt;
+        getline(cin, value);
+        if (value.empty()) {
+            cout << "Input cannot be empty. Please try again.\n";
+        } else if (!isValidText(value)) {
+            cout << "Input cannot contain numbers. Please enter a valid string.\n";
+        } else {
+            return value;
+        }
+    }
+}
+
+bool isValidText(string_view value) {
+    if (value.empty()) return false;
+    for (char ch : value) {
+        if (isdigit(static_cast<unsigned char>(ch))) return false;
+    }
+    return true;
+}
+
+bool isValidRole(string_view value) {
+    static const string_view validRoles[] = {"doctor", "nurses", "paramedics", "janitors"};
+    for (string_view role : validRoles) {
+        if (value == role) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isValidPaymentMethod(string_view value) {
+    return value == "Card" || value == "Insurance" || value == "Cash";
+}
+
+int parseIntArgument(const string& value) {
+    size_t consumed = 0;
+    int result = 0;
+    try {
+        result = stoi(value, &consumed);
+    } catch (const exception&) {
+        consumed = 0;
+    }
+    if (consumed == 0 || consumed != value.size()) {
+        throw invalid_argument("Expected an integer but got '" + value + "'.");
+    }
+    return result;
+}
+
+double parseDoubleArgument(const string& value) {
+    size_t consumed = 0;
+    double result = 0;
+    try {
+        result = stod(value, &consumed);
+    } catch (const exception&) {
+        consumed = 0;
+    }
+    if (consumed == 0 || consumed != value.size()) {
+        throw invalid_argument("Expected a number but got '" + value + "'.");
+    }
+    return result;
+}
+
+string getValidatedRole(const string& prompt) {
+    string value;
+    while (true) {
+        cout << prompt;
+        getline(cin, value);
+        if (isValidRole(value)) {
+            return value;
+        }
+        cout << "Invalid role. Please enter one of the following: doctor, nurses, paramedics, janitors.\n";
+    }
+}
+
+// ================= Metrics =================
+const char* operationName(Operation operation) {
+    static const char* names[] = {"patient.admit", "patient.discharge", "patient.find", "staff.add", "staff.delete",
+                                  "staff.find", "staff.query", "bed.allocate", "bed.release", "bed.discharge",
+                                  "bill.add", "bill.pay", "bill.settle", "record.add", "record.find",
+                                  "record.update", "record.delete", "record.search", "record.scan", "doctor.book",
+                                  "doctor.cancel"};
+    return names[static_cast<size_t>(operation)];
+}
+
+const char* counterName(Counter counter) {
+    static const char* names[] = {"staff.chain_steps", "record.scanned"};
+    return names[static_cast<size_t>(counter)];
+}
+
+MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// ================= String Interning =================
+StringInterner& symbolTable() {
+    static StringInterner table;
+    return table;
+}
+
+ostream& operator<<(ostream& out, Symbol symbol) {
+    return out << symbol.str();
+}
+
+// ================= Mutation Log =================
+const char* mutationTypeName(MutationType type) {
+    switch (type) {
+        case MutationType::PatientAdmit: return "PatientAdmit";
+        case MutationType::PatientDischarge: return "PatientDischarge";
+        case MutationType::DoctorBook: return "DoctorBook";
+        case MutationType::BedAdd: return "BedAdd";
+        case MutationType::BedAllocate: return "BedAllocate";
+        case MutationType::BedRelease: return "BedRelease";
+        case MutationType::BedDischarge: return "BedDischarge";
+        case MutationType::BillAdd: return "BillAdd";
+        case MutationType::BillPaid: return "BillPaid";
+        case MutationType::RecordAdd: return "RecordAdd";
+        case MutationType::RecordUpdate: return "RecordUpdate";
+        case MutationType::RecordDelete: return "RecordDelete";
+        case MutationType::StaffAdd: return "StaffAdd";
+        case MutationType::StaffDelete: return "StaffDelete";
+        case MutationType::BedOccupy: return "BedOccupy";
+        case MutationType::DoctorCancel: return "DoctorCancel";
+        case MutationType::DoctorAdd: return "DoctorAdd";
+        case MutationType::BillSettle: return "BillSettle";
+        case MutationType::BedVacate: return "BedVacate";
+        case MutationType::BedServeWaiting: return "BedServeWaiting";
+    }
+    return "Unknown";
+}
+
+// ================= Patient Management =================
+// Column kernels for census scans. The scalar versions are written branch-free
+// so compilers can vectorize them; the SSE2/AVX2 versions are used when the
+// target supports them (build with -mavx2 or -march=native for AVX2).
+uint64_t countEqualScalar(const uint32_t* values, size_t n, uint32_t key) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        count += values[i] == key;
+    }
+    return count;
+}
+
+// Sum of ages over the rows whose key column equals key; matches receives the row count
+uint64_t sumWhereEqualScalar(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches) {
+    uint64_t sum = 0, count = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t hit = keys[i] == key;
+        sum += ages[i] & -static_cast<int32_t>(hit);
+        count += hit;
+    }
+    matches = count;
+    return sum;
+}
+
+#if defined(__AVX2__)
+// Adds the eight 32-bit lanes of v into a 64-bit total
+inline uint64_t horizontalSum(__m256i v) {
+    __m256i wide = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(half)) + static_cast<uint64_t>(_mm_extract_epi64(half, 1));
+}
+
+uint64_t sumWhereEqual(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches) {
+    const __m256i wanted = _mm256_set1_epi32(static_cast<int>(key));
+    uint64_t sum = 0, count = 0;
+    size_t i = 0;
+    // 32-bit lane accumulators are flushed every 2^16 blocks so they cannot overflow
+    while (i + 8 <= n) {
+        __m256i laneSums = _mm256_setzero_si256(), laneCounts = _mm256_setzero_si256();
+        size_t blockEnd = min(n - n % 8, i + (size_t(8) << 16));
+        for (; i < blockEnd; i += 8) {
+            __m256i mask = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), wanted);
+            laneSums = _mm256_add_epi32(laneSums, _mm256_and_si256(mask, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ages + i))));
+            laneCounts = _mm256_sub_epi32(laneCounts, mask);
+        }
+        sum += horizontalSum(laneSums);
+        count += horizontalSum(laneCounts);
+    }
+    uint64_t tailMatches;
+    sum += sumWhereEqualScalar(keys + i, ages + i, n - i, key, tailMatches);
+    matches = count + tailMatches;
+    return sum;
+}
+#elif defined(__SSE2__)
+inline uint64_t horizontalSum(__m128i v) {
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+uint64_t sumWhereEqual(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches) {
+    const __m128i wanted = _mm_set1_epi32(static_cast<int>(key));
+    uint64_t sum = 0, count = 0;
+    size_t i = 0;
+    // 32-bit lane accumulators are flushed every 2^16 blocks so they cannot overflow
+    while (i + 4 <= n) {
+        __m128i laneSums = _mm_setzero_si128(), laneCounts = _mm_setzero_si128();
+        size_t blockEnd = min(n - n % 4, i + (size_t(4) << 16));
+        for (; i < blockEnd; i += 4) {
+            __m128i mask = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), wanted);
+            laneSums = _mm_add_epi32(laneSums, _mm_and_si128(mask, _mm_loadu_si128(reinterpret_cast<const __m128i*>(ages + i))));
+            laneCounts = _mm_sub_epi32(laneCounts, mask);
+        }
+        sum += horizontalSum(laneSums);
+        count += horizontalSum(laneCounts);
+    }
+    uint64_t tailMatches;
+    sum += sumWhereEqualScalar(keys + i, ages + i, n - i, key, tailMatches);
+    matches = count + tailMatches;
+    return sum;
+}
+#else
+uint64_t sumWhereEqual(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches) {
+    return sumWhereEqualScalar(keys, ages, n, key, matches);
+}
+#endif
+
+const char* columnKernelName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+// ================= Doctor Management =================
+SlotTime makeSlotTime(uint32_t day, int hour, int minute) {
+    return day * slotsPerDay + (hour * 60 + minute) / 30;
+}
+
+string formatSlotTime(SlotTime time) {
+    uint32_t day = time / slotsPerDay;
+    int minutes = (time % slotsPerDay) * 30;
+    int hour = minutes / 60 % 12 == 0 ? 12 : minutes / 60 % 12;
+    char clock[16];
+    snprintf(clock, sizeof(clock), "%d:%02d %s", hour, minutes % 60, minutes < 720 ? "AM" : "PM");
+    string text = string(clock) + " on " + weekdayNames[day % 7];
+    if (day >= 7) text += ", week " + to_string(day / 7 + 1);
+    return text;
+}
+
+SlotTime parseSlotTime(const string& day, const string& clock) {
+    int dayNumber = -1;
+    for (int i = 0; i < 7; i++) {
+        if (day == weekdayNames[i]) dayNumber = i;
+    }
+    if (dayNumber < 0) {
+        dayNumber = parseIntArgument(day);
+        if (dayNumber < 0) throw invalid_argument("Day cannot be negative.");
+    }
+    size_t colon = clock.find(':');
+    if (colon == string::npos) {
+        throw invalid_argument("Expected a time as HH:MM but got '" + clock + "'.");
+    }
+    int hour = parseIntArgument(clock.substr(0, colon));
+    int minute = parseIntArgument(clock.substr(colon + 1));
+    if (hour < 0 || hour > 23 || (minute != 0 && minute != 30)) {
+        throw invalid_argument("Appointments start on the hour or half hour between 00:00 and 23:30.");
+    }
+    return makeSlotTime(dayNumber, hour, minute);
+}
+
+// ================= Billing System =================
+string getValidatedPaymentMethod() {
+    string paymentMethod;
+    while (true) {
+        cout << "Enter Payment Method (Card, Insurance, Cash): ";
+        cin >> paymentMethod;
+
+        if (isValidPaymentMethod(paymentMethod)) {
+            return paymentMethod;
+        } else {
+            cout << "Invalid payment method. Please choose from 'Card', 'Insurance', or 'Cash'." << endl;
+        }
+    }
+}
+
+// ================= Persistence =================
+vector<pair<string, double>> hospitalGauges(const Hospital& hospital) {
+    const StaffManagement& staff = hospital.staff;
+    return {
+        {"patients", static_cast<double>(hospital.patients.size())},
+        {"staff", static_cast<double>(staff.size())},
+        {"staff.buckets", static_cast<double>(staff.getBucketCount())},
+        {"staff.load_factor", static_cast<double>(staff.size()) / staff.getBucketCount()},
+        {"staff.longest_chain", static_cast<double>(staff.getLongestChain())},
+        {"beds", static_cast<double>(hospital.beds.getTotalBeds())},
+        {"beds.free", static_cast<double>(hospital.beds.getFreeBeds())},
+        {"beds.avl_height", static_cast<double>(hospital.beds.getTreeHeight())},
+        {"beds.waiting", static_cast<double>(hospital.beds.getWaitingCount())},
+        {"bills.heap_size", static_cast<double>(hospital.billing.getPendingCount())},
+        {"bills.paid", static_cast<double>(hospital.billing.getPaidCount())},
+        {"records", static_cast<double>(hospital.medical.getTotalRecords())},
+        {"records.terms", static_cast<double>(hospital.medical.getTextIndex().getTermCount())},
+        {"doctors.booked", static_cast<double>(hospital.doctors.getBookedCount())},
+    };
+}
+
+void writeMetrics(ostream& out, const Hospital& hospital, bool json) {
+#if HMS_METRICS
+    if (json) {
+        metrics().writeJson(out, hospitalGauges(hospital));
+    } else {
+        metrics().writeText(out, hospitalGauges(hospital));
+    }
+#else
+    (void)hospital;
+    out << (json ? "{\"disabled\":true}\n" : "Metrics are disabled in this build.\n");
+#endif
+}
+
+void applyMutation(Hospital& hospital, MutationType type, BinaryReader& in) {
+    switch (type) {
+        case MutationType::PatientAdmit: {
+            int id = in.getInt();
+            string name = in.getString();
+            int age = in.getInt();
+            string condition = in.getString();
+            string doctorName = in.getString();
+            string appointmentTime = in.getString();
+            hospital.patients.insertPatient(id, name, age, condition, doctorName, appointmentTime);
+            break;
+        }
+        case MutationType::PatientDischarge:
+            hospital.patients.dischargePatient(in.getInt());
+            break;
+        case MutationType::DoctorBook: {
+            int doctorIndex = in.getInt();
+            hospital.doctors.bookSlot(doctorIndex, in.getU32());
+            break;
+        }
+        case MutationType::DoctorCancel: {
+            int doctorIndex = in.getInt();
+            hospital.doctors.cancelAppointment(doctorIndex, in.getU32());
+            break;
+        }
+        case MutationType::DoctorAdd: {
+            string name = in.getString();
+            string specialization = in.getString();
+            vector<SlotTime> weeklyHours(in.getU32());
+            for (SlotTime& time : weeklyHours) {
+                time = in.getU32();
+            }
+            hospital.doctors.addDoctor(name, specialization, weeklyHours);
+            break;
+        }
+        case MutationType::BedAdd:
+            hospital.beds.addBeds(in.getInt());
+            break;
+        case MutationType::BedAllocate: {
+            int patientId = in.getInt();
+            hospital.beds.allocateBed(patientId, in.getBool());
+            break;
+        }
+        case MutationType::BedRelease:
+            hospital.beds.releaseBed(in.getInt());
+            break;
+        case MutationType::BedDischarge:
+            hospital.beds.dischargePatient(in.getInt());
+            break;
+        case MutationType::BedOccupy: {
+            int bedNumber = in.getInt();
+            hospital.beds.occupyBed(bedNumber, in.getInt());
+            break;
+        }
+        case MutationType::BedVacate:
+            hospital.beds.clearBed(in.getInt());
+            break;
+        case MutationType::BedServeWaiting:
+            hospital.beds.serveWaitingList();
+            break;
+        case MutationType::BillAdd: {
+            int patientID = in.getInt();
+            double totalAmount = in.getDouble();
+            hospital.billing.mergeBill(patientID, totalAmount, in.getString());
+            break;
+        }
+        case MutationType::BillPaid: {
+            int patientID = in.getInt();
+            if (in.remaining() == 0) {
+                hospital.billing.markBillAsPaidByID(patientID); // Logged before payments carried their split
+                break;
+            }
+            in.getDouble(); // Total amount, already known from the bill
+            double paidByPatient = in.getDouble();
+            double claimedFromInsurer = in.getDouble();
+            hospital.billing.payBill(patientID, paidByPatient, claimedFromInsurer, in.getDouble());
+            break;
+        }
+        case MutationType::BillSettle: { // Only in logs written before settlement logged each bill
+            SettlementRules rules;
+            rules.insuranceCoverage = in.getDouble();
+            rules.cashDiscount = in.getDouble();
+            hospital.billing.settleAll(rules);
+            break;
+        }
+        case MutationType::RecordAdd: {
+            int patientID = in.getInt();
+            string name = in.getString();
+            int age = in.getInt();
+            string medicalHistory = in.getString();
+            string prescriptions = in.getString();
+            hospital.medical.addRecord(patientID, name, age, medicalHistory, prescriptions, in.getString());
+            break;
+        }
+        case MutationType::RecordUpdate: {
+            int patientID = in.getInt();
+            string prescriptions = in.getString();
+            hospital.medical.updateRecord(patientID, prescriptions, in.getString());
+            break;
+        }
+        case MutationType::RecordDelete:
+            hospital.medical.deleteRecord(in.getInt());
+            break;
+        case MutationType::StaffAdd: {
+            int id = in.getInt();
+            string name = in.getString();
+            string role = in.getString();
+            string department = in.getString();
+            hospital.staff.insertStaff(id, name, role, department, in.getString());
+            break;
+        }
+        case MutationType::StaffDelete:
+            hospital.staff.removeStaff(in.getInt());
+            break;
+        default:
+            throw runtime_error("Unknown mutation type in log.");
+    }
+}
+
+void writeHospitalSnapshot(const Hospital& hospital, const string& path, uint64_t sequence) {
+    SnapshotBuilder out;
+    hospital.patients.saveSnapshot(out);
+    hospital.doctors.saveSnapshot(out);
+    hospital.beds.saveSnapshot(out);
+    hospital.billing.saveSnapshot(out);
+    hospital.medical.saveSnapshot(out);
+    hospital.staff.saveSnapshot(out);
+    out.write(path, sequence);
+}
+
+void loadHospitalSnapshot(Hospital& hospital, const SnapshotView& view) {
+    hospital.patients.loadSnapshot(view);
+    hospital.doctors.loadSnapshot(view);
+    hospital.beds.loadSnapshot(view);
+    hospital.billing.loadSnapshot(view);
+    hospital.medical.loadSnapshot(view);
+    hospital.staff.loadSnapshot(view);
+}
+
+// ================= Audit Log =================
+int printAuditLog(const string& path) {
+    bool valid = AuditLog::read(path, [](const AuditEventHeader& header, const string& payload) {
+        time_t seconds = static_cast<time_t>(header.timestampNs / 1000000000);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", gmtime(&seconds));
+        cout << header.sequence << " " << stamp << "." << setfill('0') << setw(6) << header.timestampNs % 1000000000 / 1000
+             << setfill(' ') << "Z " << mutationTypeName(static_cast<MutationType>(header.type)) << " (" << payload.size() << " bytes)\n";
+    });
+    if (!valid) {
+        cerr << path << " is not an audit log." << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// ================= Change Feed =================
+ChangeFeedFormat parseChangeFeedFormat(const string& name) {
+    if (name == "json") return ChangeFeedFormat::Json;
+    if (name == "binary") return ChangeFeedFormat::Binary;
+    throw invalid_argument("Unknown change feed format '" + name + "' (json or binary).");
+}
+
+ChangeFeedFormat detectChangeFeedFormat(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(changeFeedMagic)];
+    if (in.read(magic, sizeof(magic)) && memcmp(magic, changeFeedMagic, sizeof(magic)) == 0) {
+        return ChangeFeedFormat::Binary;
+    }
+    return ChangeFeedFormat::Json;
+}
+
+void appendJsonString(string& out, string_view value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Writes the fields of one flat JSON object into a string
+class JsonFields {
+private:
+    string& out;
+    bool first;
+
+    void key(const char* name) {
+        if (!first) out += ',';
+        first = false;
+        out += '"';
+        out += name;
+        out += "\":";
+    }
+
+    template <typename T>
+    void number(T value) {
+        char digits[32];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+public:
+    explicit JsonFields(string& out) : out(out), first(true) {}
+
+    void addInt(const char* name, int64_t value) {
+        key(name);
+        number(value);
+    }
+
+    void addDouble(const char* name, double value) {
+        key(name);
+        if (isfinite(value)) {
+            number(value);
+        } else {
+            out += "null";
+        }
+    }
+
+    void addBool(const char* name, bool value) {
+        key(name);
+        out += value ? "true" : "false";
+    }
+
+    void addString(const char* name, string_view value) {
+        key(name);
+        appendJsonString(out, value);
+    }
+
+    // An array of two-field objects, e.g. [{"patient_id":7,"bed":3}]
+    void addIntPairs(const char* name, const char* firstName, const char* secondName, const vector<pair<int, int>>& values) {
+        key(name);
+        out += '[';
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i) out += ',';
+            JsonFields object(out);
+            out += '{';
+            object.addInt(firstName, values[i].first);
+            object.addInt(secondName, values[i].second);
+            out += '}';
+        }
+        out += ']';
+    }
+
+    void addStrings(const char* name, const vector<string>& values) {
+        key(name);
+        out += '[';
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i) out += ',';
+            appendJsonString(out, values[i]);
+        }
+        out += ']';
+    }
+};
+
+// Field names follow the arguments the managers are called with on replay (see
+// applyMutation), then the outcome: beds given out and how each bill was paid
+void appendMutationFields(JsonFields& fields, MutationType type, BinaryReader& in) {
+    switch (type) {
+        case MutationType::PatientAdmit:
+            fields.addInt("id", in.getInt());
+            fields.addString("name", in.getString());
+            fields.addInt("age", in.getInt());
+            fields.addString("condition", in.getString());
+            fields.addString("doctor", in.getString());
+            fields.addString("appointment", in.getString());
+            break;
+        case MutationType::PatientDischarge:
+            fields.addInt("id", in.getInt());
+            break;
+        case MutationType::DoctorBook:
+        case MutationType::DoctorCancel:
+            fields.addInt("doctor", in.getInt() + 1);
+            fields.addString("slot", formatSlotTime(in.getU32()));
+            break;
+        case MutationType::DoctorAdd: {
+            fields.addString("name", in.getString());
+            fields.addString("specialization", in.getString());
+            vector<string> weeklyHours(in.getU32());
+            for (string& time : weeklyHours) {
+                time = formatSlotTime(in.getU32());
+            }
+            fields.addStrings("weekly_hours", weeklyHours);
+            break;
+        }
+        case MutationType::BedAdd:
+            fields.addInt("bed", in.getInt());
+            break;
+        case MutationType::BedAllocate:
+            fields.addInt("patient_id", in.getInt());
+            fields.addBool("urgent", in.getBool());
+            fields.addInt("bed", in.getInt()); // -1 if the patient is on the waiting list
+            break;
+        case MutationType::BedRelease:
+            fields.addInt("bed", in.getInt());
+            fields.addInt("patient_id", in.getInt());
+            fields.addInt("next_patient_id", in.getInt()); // Waiting patient given a bed, or -1
+            fields.addInt("next_bed", in.getInt());
+            break;
+        case MutationType::BedVacate:
+            fields.addInt("bed", in.getInt());
+            fields.addInt("patient_id", in.getInt());
+            break;
+        case MutationType::BedServeWaiting: {
+            vector<pair<int, int>> served(in.getU32());
+            for (pair<int, int>& assignment : served) {
+                assignment.first = in.getInt();
+                assignment.second = in.getInt();
+            }
+            fields.addIntPairs("served", "patient_id", "bed", served);
+            break;
+        }
+        case MutationType::BedDischarge:
+            fields.addInt("patient_id", in.getInt());
+            fields.addInt("bed", in.getInt()); // -1 if the patient was only waiting
+            fields.addInt("next_patient_id", in.getInt());
+            fields.addInt("next_bed", in.getInt());
+            break;
+        case MutationType::BedOccupy:
+            fields.addInt("bed", in.getInt());
+            fields.addInt("patient_id", in.getInt());
+            break;
+        case MutationType::BillAdd:
+            fields.addInt("patient_id", in.getInt());
+            fields.addDouble("amount", in.getDouble());
+            fields.addString("payment_method", in.getString());
+            break;
+        case MutationType::BillPaid:
+            fields.addInt("patient_id", in.getInt());
+            fields.addDouble("amount", in.getDouble());
+            fields.addDouble("paid_by_patient", in.getDouble());
+            fields.addDouble("claimed_from_insurer", in.getDouble());
+            fields.addDouble("discount", in.getDouble());
+            break;
+        case MutationType::BillSettle:
+            fields.addDouble("insurance_coverage", in.getDouble());
+            fields.addDouble("cash_discount", in.getDouble());
+            break;
+        case MutationType::RecordAdd:
+            fields.addInt("patient_id", in.getInt());
+            fields.addString("name", in.getString());
+            fields.addInt("age", in.getInt());
+            fields.addString("medical_history", in.getString());
+            fields.addString("prescriptions", in.getString());
+            fields.addString("doctor_notes", in.getString());
+            break;
+        case MutationType::RecordUpdate:
+            fields.addInt("patient_id", in.getInt());
+            fields.addString("prescriptions", in.getString());
+            fields.addString("doctor_notes", in.getString());
+            break;
+        case MutationType::RecordDelete:
+            fields.addInt("patient_id", in.getInt());
+            break;
+        case MutationType::StaffAdd:
+            fields.addInt("id", in.getInt());
+            fields.addString("name", in.getString());
+            fields.addString("role", in.getString());
+            fields.addString("department", in.getString());
+            fields.addString("shift", in.getString());
+            break;
+        case MutationType::StaffDelete:
+            fields.addInt("id", in.getInt());
+            break;
+        default:
+            throw runtime_error("Unknown mutation type in change feed.");
+    }
+}
+
+void appendChangeEventJson(string& out, uint64_t sequence, int64_t timestampNs, MutationType type, const string& payload) {
+    JsonFields event(out);
+    out += '{';
+    event.addInt("seq", static_cast<int64_t>(sequence));
+    event.addInt("ts_ns", timestampNs);
+    event.addString("type", mutationTypeName(type));
+    out += ",\"data\":{";
+    size_t dataStart = out.size();
+    try {
+        BinaryReader in(payload.data(), payload.size());
+        JsonFields data(out);
+        appendMutationFields(data, type, in);
+        out += "}}";
+    } catch (const exception&) {
+        // Keeps the event (and its sequence number) even if the payload cannot be decoded
+        out.resize(dataStart - 1);
+        out += "null}";
+    }
+}
+
+void readChangeFeed(const string& path, uint64_t offset, const function<void(uint64_t, const string&, uint64_t)>& visit) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        throw runtime_error("Cannot open change feed " + path);
+    }
+    string line;
+    if (detectChangeFeedFormat(path) == ChangeFeedFormat::Json) {
+        const string prefix = "{\"seq\":";
+        in.seekg(offset);
+        while (getline(in, line) && !in.eof()) {
+            uint64_t sequence;
+            if (line.compare(0, prefix.size(), prefix) != 0 ||
+                from_chars(line.data() + prefix.size(), line.data() + line.size(), sequence).ec != errc()) {
+                break;
+            }
+            offset += line.size() + 1;
+            visit(sequence, line, offset);
+        }
+        return;
+    }
+
+    const uint32_t fixedBytes = sizeof(uint64_t) + sizeof(int64_t) + 1 + sizeof(uint32_t);
+    offset = max<uint64_t>(offset, sizeof(changeFeedMagic));
+    in.seekg(offset);
+    string frame;
+    uint32_t length;
+    while (in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        if (length < fixedBytes || length > (1u << 30)) break;
+        frame.resize(length);
+        if (!in.read(&frame[0], length)) break;
+        uint32_t sum;
+        memcpy(&sum, frame.data() + length - sizeof(sum), sizeof(sum));
+        if (checksum(frame.data(), length - sizeof(sum)) != sum) break;
+        BinaryReader header(frame.data(), length - sizeof(sum));
+        uint64_t sequence = header.getU64();
+        int64_t timestampNs = static_cast<int64_t>(header.getU64());
+        MutationType type = static_cast<MutationType>(header.getU8());
+        line.clear();
+        appendChangeEventJson(line, sequence, timestampNs, type, frame.substr(fixedBytes - sizeof(sum), length - fixedBytes));
+        offset += sizeof(length) + length;
+        visit(sequence, line, offset);
+    }
+}
+
+int printChangeFeed(const string& feedPath, const string& cursorPath) {
+    try {
+        bool useCursor = cursorPath != "-";
+        ChangeFeedCursor cursor = useCursor ? ChangeFeedCursor::load(cursorPath) : ChangeFeedCursor();
+        if (!filesystem::exists(feedPath)) {
+            throw runtime_error("Cannot open change feed " + feedPath);
+        }
+        if (filesystem::file_size(feedPath) < cursor.offset) {
+            throw runtime_error("Change feed " + feedPath + " is shorter than the cursor; was it replaced?");
+        }
+        size_t events = 0;
+        {
+            OutputBuffer out;
+            readChangeFeed(feedPath, cursor.offset, [&](uint64_t sequence, const string& line, uint64_t next) {
+                if (events == 0 && cursor.sequence != 0 && sequence != cursor.sequence + 1) {
+                    throw runtime_error("Change feed " + feedPath + " does not continue after sequence " + to_string(cursor.sequence) + ".");
+                }
+                out << line << '\n';
+                cursor.sequence = sequence;
+                cursor.offset = next;
+                events++;
+            });
+        }
+        if (useCursor) cursor.save(cursorPath);
+        cerr << events << " events, cursor at sequence " << cursor.sequence << ", offset " << cursor.offset << endl;
+        return 0;
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
+
+// ================= CSV Conversion =================
+vector<string> parseCsvLine(const string& line, char delimiter) {
+    vector<string> fields;
+    string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field.push_back('"');
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field.push_back(c);
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field.push_back(c);
+        }
+    }
+    fields.push_back(field);
+    return fields;
+}
+
+int parseIntField(string_view value) {
+    int result = 0;
+    from_chars_result parsed = from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || parsed.ec != errc() || parsed.ptr != value.data() + value.size()) {
+        throw invalid_argument("Expected an integer but got '" + string(value) + "'.");
+    }
+    return result;
+}
+
+double parseDoubleField(string_view value) {
+    double result = 0;
+    from_chars_result parsed = from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || parsed.ec != errc() || parsed.ptr != value.data() + value.size()) {
+        throw invalid_argument("Expected a number but got '" + string(value) + "'.");
+    }
+    return result;
+}
+
+char delimiterFor(const string& path) {
+    string extension = filesystem::path(path).extension().string();
+    return extension == ".tsv" || extension == ".tab" ? '\t' : ',';
+}
+
+size_t importPatients(PatientList& patients, istream& in, const string& sourceName, char delimiter) {
+    CsvReader reader(in, delimiter);
+    patients.reserve(patients.size() + reader.getEstimatedRows());
+    return forEachCsvRow(reader, sourceName, 6, [&](const vector<string_view>& f) {
+        int id = parseIntField(f[0]);
+        int age = parseIntField(f[2]);
+        if (!isAlphaString(f[1])) throw invalid_argument("Invalid patient name '" + string(f[1]) + "'.");
+        if (age <= 0 || age > 110) throw out_of_range("Age must be between 1 and 110.");
+        if (!patients.insertPatient(id, string(f[1]), age, string(f[3]), string(f[4]), string(f[5]))) {
+            throw invalid_argument("duplicate patient ID");
+        }
+    });
+}
+
+size_t importStaff(StaffManagement& staff, istream& in, const string& sourceName, char delimiter) {
+    CsvReader reader(in, delimiter);
+    staff.reserve(staff.size() + reader.getEstimatedRows());
+    return forEachCsvRow(reader, sourceName, 5, [&](const vector<string_view>& f) {
+        int id = parseIntField(f[0]);
+        if (id < 0) throw invalid_argument("ID cannot be negative.");
+        if (!isValidText(f[1])) throw invalid_argument("Invalid name '" + string(f[1]) + "'.");
+        if (!isValidRole(f[2])) throw invalid_argument("Invalid role '" + string(f[2]) + "'.");
+        if (!isValidText(f[3])) throw invalid_argument("Invalid department '" + string(f[3]) + "'.");
+        if (!isValidText(f[4])) throw invalid_argument("Invalid shift '" + string(f[4]) + "'.");
+        if (!staff.insertStaff(id, string(f[1]), string(f[2]), string(f[3]), string(f[4]))) {
+            throw invalid_argument("duplicate staff ID");
+        }
+    });
+}
+
+size_t importBills(BillingSystem& billing, istream& in, const string& sourceName, char delimiter) {
+    CsvReader reader(in, delimiter);
+    billing.reserve(billing.getPendingCount() + reader.getEstimatedRows());
+    return forEachCsvRow(reader, sourceName, 4, [&](const vector<string_view>& f) {
+        int patientID = parseIntField(f[0]);
+        double amount = parseDoubleField(f[1]);
+        if (!isfinite(amount) || amount <= 0) throw invalid_argument("Amount must be a positive number.");
+        if (!isValidPaymentMethod(f[2])) throw invalid_argument("Invalid payment method '" + string(f[2]) + "'.");
+        // A paid row must be a bill of its own; merged into a pending bill it would pay the whole balance
+        bool paid = f[3] == "1" || f[3] == "yes" || f[3] == "true";
+        if (paid && billing.findPendingBill(patientID)) throw invalid_argument("paid bill for a patient with a pending bill");
+        billing.mergeBill(patientID, amount, string(f[2]));
+        if (paid) billing.payBill(patientID);
+    });
+}
+
+// A patient may have several records, but a row repeating the patient's latest record is a duplicate
+size_t importMedicalRecords(MedicalSystem& medical, istream& in, const string& sourceName, char delimiter) {
+    CsvReader reader(in, delimiter);
+    medical.reserve(medical.getTotalRecords() + reader.getEstimatedRows());
+    return forEachCsvRow(reader, sourceName, 6, [&](const vector<string_view>& f) {
+        int patientID = parseIntField(f[0]);
+        int age = parseIntField(f[2]);
+        if (!isAlphaString(f[1])) throw invalid_argument("Invalid patient name '" + string(f[1]) + "'.");
+        if (age <= 0 || age > 110) throw out_of_range("Age must be between 1 and 110.");
+        const MedicalRecord* latest = medical.findLatestRecord(patientID);
+        if (latest && latest->name == f[1] && latest->age == age && latest->medicalHistory == f[3] && latest->prescriptions == f[4] &&
+            latest->doctorNotes == f[5]) {
+            throw invalid_argument("duplicate medical record");
+        }
+        medical.addRecord(patientID, string(f[1]), age, string(f[3]), string(f[4]), string(f[5]));
+    });
+}
+
+size_t importCsvDirectory(Hospital& hospital, const string& directory) {
+    size_t loaded = 0;
+    auto importTable = [&](const string& table, auto importFile) {
+        for (const char* extension : {".csv", ".tsv"}) {
+            string fileName = table + extension;
+            ifstream in(directory + "/" + fileName, ios::binary);
+            if (in) {
+                loaded += importFile(in, fileName, delimiterFor(fileName));
+                return;
+            }
+        }
+    };
+
+    importTable("patients", [&](istream& in, const string& fileName, char delimiter) {
+        return importPatients(hospital.patients, in, fileName, delimiter);
+    });
+    importTable("staff", [&](istream& in, const string& fileName, char delimiter) {
+        return importStaff(hospital.staff, in, fileName, delimiter);
+    });
+    importTable("beds", [&](istream& in, const string& fileName, char delimiter) {
+        CsvReader reader(in, delimiter);
+        return forEachCsvRow(reader, fileName, 2, [&](const vector<string_view>& f) {
+            int bedNumber = parseIntField(f[0]);
+            hospital.beds.addBeds(bedNumber);
+            if (!f[1].empty() && !hospital.beds.occupyBed(bedNumber, parseIntField(f[1]))) {
+                throw invalid_argument("bed or patient already assigned");
+            }
+        });
+    });
+    importTable("bills", [&](istream& in, const string& fileName, char delimiter) {
+        return importBills(hospital.billing, in, fileName, delimiter);
+    });
+    importTable("records", [&](istream& in, const string& fileName, char delimiter) {
+        return importMedicalRecords(hospital.medical, in, fileName, delimiter);
+    });
+    return loaded;
+}
+
+int convertCsvToSnapshot(const string& csvDirectory, const string& snapshotPath) {
+    Hospital hospital;
+    ofstream nullOutput;
+    streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+    auto start = chrono::steady_clock::now();
+    size_t rows = importCsvDirectory(hospital, csvDirectory);
+    cout.rdbuf(previous);
+    try {
+        writeHospitalSnapshot(hospital, snapshotPath, 0);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    cerr << "Converted " << rows << " rows from " << csvDirectory << " into " << snapshotPath
+         << " in " << elapsedSeconds(start) * 1000 << " ms" << endl;
+    return 0;
+}
+
+int printSnapshotInfo(const string& path) {
+    auto start = chrono::steady_clock::now();
+    SnapshotView view;
+    try {
+        view.open(path);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    double openSeconds = elapsedSeconds(start);
+    cout << "Snapshot " << path << " (version " << snapshotVersion << ", " << view.getFileSize() << " bytes, log sequence "
+         << view.getSequence() << ", opened in " << openSeconds * 1000 << " ms)" << endl;
+    cout << "Patients: " << view.records<SnapshotPatient>(SnapshotSectionKind::Patients).size() << endl;
+    cout << "Staff: " << view.records<SnapshotStaff>(SnapshotSectionKind::Staff).size() << endl;
+    cout << "Pending bills: " << view.records<SnapshotBill>(SnapshotSectionKind::PendingBills).size()
+         << ", paid bills: " << view.records<SnapshotBill>(SnapshotSectionKind::PaidBills).size() << endl;
+    cout << "Medical records: " << view.records<SnapshotMedicalRecord>(SnapshotSectionKind::MedicalRecords).size() << endl;
+    cout << "Beds: " << view.records<SnapshotBed>(SnapshotSectionKind::Beds).size() << " (" << view.countFreeBeds() << " free), waiting: "
+         << view.records<int32_t>(SnapshotSectionKind::WaitingList).size() << endl;
+    cout << "Payload checksum: " << (view.verifyPayload() ? "ok" : "MISMATCH") << endl;
+    return 0;
+}
+
+// ================= Batch Command Engine =================
+vector<string> tokenizeCommand(const string& line) {
+    vector<string> tokens;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && isspace(static_cast<unsigned char>(line[i]))) i++;
+        if (i >= line.size() || line[i] == '#') break;
+
+        string token;
+        if (line[i] == '"') {
+            size_t close = line.find('"', i + 1);
+            if (close == string::npos) {
+                throw invalid_argument("Unterminated quote.");
+            }
+            token = line.substr(i + 1, close - i - 1);
+            i = close + 1;
+        } else {
+            size_t start = i;
+            while (i < line.size() && !isspace(static_cast<unsigned char>(line[i]))) i++;
+            token = line.substr(start, i - start);
+        }
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+string auditPathFor(const string& dataDirectory, const string& auditPath) {
+    if (!auditPath.empty() || dataDirectory.empty()) return auditPath;
+    return dataDirectory + "/hms.audit";
+}
+
+void addMutationSink(Hospital& hospital, Storage* storage, MutationFanout& sinks, MutationLog* sink) {
+    if (storage) {
+        storage->addSink(sink);
+    } else {
+        sinks.add(sink);
+        hospital.setMutationLog(&sinks);
+    }
+}
+
+void attachAuditLog(Hospital& hospital, Storage* storage, MutationFanout& sinks, AuditLog& audit, const string& auditPath) {
+    if (auditPath.empty()) return;
+    audit.open(auditPath);
+    addMutationSink(hospital, storage, sinks, &audit);
+}
+
+void attachChangeFeed(Hospital& hospital, Storage* storage, MutationFanout& sinks, ChangeFeed& feed, const ChangeFeedOptions& options) {
+    if (options.path.empty()) return;
+    feed.open(options.path, options.format);
+    addMutationSink(hospital, storage, sinks, &feed);
+}
+
+int runBatch(const string& path, const string& dataDirectory, const string& auditPath, const ChangeFeedOptions& changeFeed,
+             MetricsDumper* metricsDumper) {
+    ifstream file;
+    istream* in = &cin;
+    if (path != "-") {
+        file.open(path);
+        if (!file) {
+            cerr << "Cannot open batch file " << path << endl;
+            return 1;
+        }
+        in = &file;
+    }
+
+    ios::sync_with_stdio(false);
+    Hospital hospital;
+    AuditLog audit;
+    ChangeFeed feed;
+    MutationFanout sinks;
+    unique_ptr<Storage> storage;
+    if (!dataDirectory.empty()) {
+        // Batch runs commit the log in groups instead of after every record
+        storage.reset(new Storage(hospital, dataDirectory, false));
+        RecoveryStats stats = storage->recover();
+        cerr << "Recovered " << dataDirectory << (stats.snapshotLoaded ? " (snapshot + " : " (")
+             << stats.replayedRecords << " log records) in " << stats.seconds * 1000 << " ms" << endl;
+    }
+    try {
+        attachAuditLog(hospital, storage.get(), sinks, audit, auditPathFor(dataDirectory, auditPath));
+        attachChangeFeed(hospital, storage.get(), sinks, feed, changeFeed);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    CommandEngine engine(hospital, storage.get());
+    engine.setMetricsDumper(metricsDumper);
+    BlockOutputBuffer output(stdout);
+    streambuf* previous = cout.rdbuf(&output);
+
+    auto start = chrono::steady_clock::now();
+    engine.run(*in);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout.rdbuf(previous);
+    output.flushBlock();
+    if (storage) {
+        storage->checkpoint();
+    }
+    if (metricsDumper) metricsDumper->dump(hospital);
+
+    cerr << "Processed " << engine.getCommandCount() << " commands (" << engine.getErrorCount() << " errors) in "
+         << seconds << " s, " << (seconds > 0 ? engine.getCommandCount() / seconds : 0) << " ops/sec" << endl;
+    return engine.getErrorCount() == 0 ? 0 : 2;
+}
@@ -0,0 +1,6324 @@
+#ifndef HOSPITAL_MANAGEMENT_SYSTEM_H
+#define HOSPITAL_MANAGEMENT_SYSTEM_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <queue>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <bitset>
+#include <set>
+#include <iterator>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <cerrno>
+#include <ctime>
+#include <charconv>
+#include <cmath>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HMS_HAVE_MMAP 1
+#endif
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// ================= Utility Functions =================
+bool isAlphaString(string_view str);
+bool isNumericString(const string& str);
+int getValidatedInt(const string& prompt);
+double getValidatedDouble(const string& prompt);
+string getValidatedString(const string& prompt);
+// Rule for free-text prompts such as names and departments: not empty, no digits
+bool isValidText(string_view value);
+bool isValidRole(string_view value);
+bool isValidPaymentMethod(string_view value);
+
+inline double elapsedSeconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+inline int countSetBits(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    for (; value; value &= value - 1) count++;
+    return count;
+#endif
+}
+
+// Position of the lowest set bit; value must be non-zero
+inline int countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+int parseIntArgument(const string& value);
+double parseDoubleArgument(const string& value);
+string getValidatedRole(const string& prompt);
+
+// ================= ID Index =================
+// Open-addressing hash map from integer IDs to values. Linear probing over a
+// power-of-two table; erase shifts later entries back so no tombstones build up.
+template <typename T>
+class IdIndex {
+private:
+    struct Slot {
+        int key;
+        bool used;
+        T value;
+    };
+
+    vector<Slot> slots;
+    size_t count;
+    size_t mask;
+
+    size_t slotFor(int key) const {
+        // Fibonacci hashing spreads sequential IDs across the table
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(key)) * 11400714819323198485ull) >> 32) & mask;
+    }
+
+    void grow() {
+        vector<Slot> oldSlots;
+        oldSlots.swap(slots);
+        slots.assign(oldSlots.size() * 2, Slot{0, false, T()});
+        mask = slots.size() - 1;
+        count = 0;
+        for (Slot& slot : oldSlots) {
+            if (slot.used) {
+                insert(slot.key, slot.value);
+            }
+        }
+    }
+
+public:
+    IdIndex(size_t initialCapacity = 16) : count(0) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) capacity *= 2;
+        slots.assign(capacity, Slot{0, false, T()});
+        mask = capacity - 1;
+    }
+
+    // Returns false if the key is already present
+    bool insert(int key, const T& value) {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            grow();
+        }
+        size_t i = slotFor(key);
+        while (slots[i].used) {
+            if (slots[i].key == key) return false;
+            i = (i + 1) & mask;
+        }
+        slots[i] = Slot{key, true, value};
+        count++;
+        return true;
+    }
+
+    T* find(int key) {
+        size_t i = slotFor(key);
+        while (slots[i].used) {
+            if (slots[i].key == key) return &slots[i].value;
+            i = (i + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    const T* find(int key) const {
+        return const_cast<IdIndex*>(this)->find(key);
+    }
+
+    bool erase(int key) {
+        size_t i = slotFor(key);
+        while (slots[i].used && slots[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        if (!slots[i].used) return false;
+
+        // Backward-shift deletion keeps every probe chain contiguous
+        size_t hole = i;
+        size_t j = (i + 1) & mask;
+        while (slots[j].used) {
+            size_t home = slotFor(slots[j].key);
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+            j = (j + 1) & mask;
+        }
+        slots[hole].used = false;
+        slots[hole].value = T();
+        count--;
+        return true;
+    }
+
+    void reserve(size_t expected) {
+        while (expected * 4 > slots.size() * 3) {
+            grow();
+        }
+    }
+
+    void clear() {
+        slots.assign(slots.size(), Slot{0, false, T()});
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+// Log-linear histogram: 8 sub-buckets per power of two, so any recorded value
+// is reported within ~12.5% while the whole range of uint64_t fits in 496 counters.
+class LatencyHistogram {
+private:
+    static const int subBuckets = 8;
+    static const int bucketCount = 62 * subBuckets;
+
+    uint64_t counts[bucketCount];
+    uint64_t total;
+    uint64_t maxValue;
+    long double sum;
+
+    static int highestBit(uint64_t value) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+#endif
+    }
+
+    static int bucketFor(uint64_t value) {
+        if (value < subBuckets) return static_cast<int>(value);
+        int exponent = highestBit(value);
+        int sub = static_cast<int>((value >> (exponent - 3)) & (subBuckets - 1));
+        return (exponent - 2) * subBuckets + sub;
+    }
+
+    static uint64_t lowerBound(int bucket) {
+        if (bucket < subBuckets) return bucket;
+        int exponent = bucket / subBuckets + 2;
+        return static_cast<uint64_t>(subBuckets + bucket % subBuckets) << (exponent - 3);
+    }
+
+public:
+    LatencyHistogram() {
+        reset();
+    }
+
+    void record(uint64_t value) {
+        counts[bucketFor(value)]++;
+        total++;
+        sum += value;
+        maxValue = max(maxValue, value);
+    }
+
+    // Upper edge of the bucket holding the requested percentile (0-100)
+    uint64_t percentile(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+        rank = max<uint64_t>(1, min(rank, total));
+        uint64_t seen = 0;
+        for (int i = 0; i < bucketCount; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return i + 1 < bucketCount ? min(maxValue, lowerBound(i + 1) - 1) : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    // Adds another histogram's samples, e.g. to combine per-thread histograms
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < bucketCount; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        maxValue = max(maxValue, other.maxValue);
+    }
+
+    uint64_t getCount() const {
+        return total;
+    }
+
+    uint64_t getMax() const {
+        return maxValue;
+    }
+
+    double getMean() const {
+        return total ? static_cast<double>(sum / total) : 0.0;
+    }
+
+    void reset() {
+        fill(counts, counts + bucketCount, 0);
+        total = 0;
+        maxValue = 0;
+        sum = 0;
+    }
+};
+
+// ================= Node Pool =================
+// Allocates nodes from slabs of slabSize objects instead of one heap block per node.
+// Destroyed nodes go on an intrusive free list and are reused before a new slab is
+// taken. Nodes never move, so pointers held by indexes stay valid.
+template <typename T, size_t slabSize = 1024>
+class NodePool {
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    vector<unique_ptr<Slot[]>> slabs;
+    Slot* freeList;
+    size_t usedInLastSlab;
+    size_t live;
+
+public:
+    NodePool() : freeList(nullptr), usedInLastSlab(slabSize), live(0) {}
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = slot->nextFree;
+        } else {
+            if (usedInLastSlab == slabSize) {
+                slabs.emplace_back(new Slot[slabSize]);
+                usedInLastSlab = 0;
+            }
+            slot = &slabs.back()[usedInLastSlab++];
+        }
+        try {
+            T* node = new (slot->storage) T{std::forward<Args>(args)...};
+            live++;
+            return node;
+        } catch (...) {
+            slot->nextFree = freeList;
+            freeList = slot;
+            throw;
+        }
+    }
+
+    void destroy(T* node) {
+        node->~T();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->nextFree = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    size_t size() const {
+        return live;
+    }
+
+    size_t capacity() const {
+        return slabs.size() * slabSize;
+    }
+
+    size_t memoryUsage() const {
+        return slabs.size() * slabSize * sizeof(Slot);
+    }
+};
+
+// ================= Worker Pool =================
+// Fixed set of worker threads taking tasks from one queue. wait() blocks
+// until every submitted task has finished and rethrows the first failure.
+class WorkerPool {
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex lock;
+    condition_variable taskReady, allDone;
+    size_t running = 0;
+    bool stopping = false;
+    exception_ptr firstError;
+
+    void work() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            taskReady.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            function<void()> task = move(tasks.front());
+            tasks.pop_front();
+            running++;
+            guard.unlock();
+            try {
+                task();
+            } catch (...) {
+                guard.lock();
+                if (!firstError) firstError = current_exception();
+                guard.unlock();
+            }
+            guard.lock();
+            running--;
+            if (tasks.empty() && running == 0) allDone.notify_all();
+        }
+    }
+
+public:
+    explicit WorkerPool(size_t threadCount) {
+        if (threadCount == 0) {
+            throw invalid_argument("A worker pool needs at least one thread.");
+        }
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&WorkerPool::work, this);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> guard(lock);
+            tasks.push_back(move(task));
+        }
+        taskReady.notify_one();
+    }
+
+    void wait() {
+        unique_lock<mutex> guard(lock);
+        allDone.wait(guard, [this] { return tasks.empty() && running == 0; });
+        if (firstError) {
+            exception_ptr error = firstError;
+            firstError = nullptr;
+            rethrow_exception(error);
+        }
+    }
+
+    size_t getThreadCount() const {
+        return workers.size();
+    }
+};
+
+// ================= Metrics =================
+// Per-operation call counts and latency histograms, plus event counters.
+// Each thread records into its own block, so recording never contends;
+// dumps merge the blocks. Every call is counted but only one in
+// HMS_METRICS_SAMPLE is timed, since reading the clock costs more than most
+// operations. Build with -DHMS_METRICS=0 to compile the timers out entirely.
+#ifndef HMS_METRICS
+#define HMS_METRICS 1
+#endif
+#ifndef HMS_METRICS_SAMPLE
+#define HMS_METRICS_SAMPLE 8
+#endif
+
+enum class Operation : uint8_t {
+    PatientAdmit,
+    PatientDischarge,
+    PatientFind,
+    StaffAdd,
+    StaffDelete,
+    StaffFind,
+    StaffQuery,
+    BedAllocate,
+    BedRelease,
+    BedDischarge,
+    BillAdd,
+    BillPay,
+    BillSettle,
+    RecordAdd,
+    RecordFind,
+    RecordUpdate,
+    RecordDelete,
+    RecordSearch,
+    RecordScan,
+    DoctorBook,
+    DoctorCancel,
+    Count
+};
+
+enum class Counter : uint8_t {
+    StaffChainSteps, // Nodes visited walking staff hash chains
+    RecordsScanned,  // Records visited by substring scans
+    Count
+};
+
+const char* operationName(Operation operation);
+const char* counterName(Counter counter);
+
+class MetricsRegistry {
+private:
+    static const size_t operationCount = static_cast<size_t>(Operation::Count);
+    static const size_t counterCount = static_cast<size_t>(Counter::Count);
+
+    // One per recording thread. Counts have a single writer, so they are bumped
+    // with plain relaxed loads and stores; the lock guards the sampled histograms
+    // and is only contended while a dump reads them.
+    struct Block {
+        atomic<uint64_t> calls[operationCount];
+        atomic<uint64_t> counters[counterCount];
+        mutex lock;
+        LatencyHistogram latency[operationCount]; // Nanoseconds, sampled calls only
+
+        Block() {
+            for (atomic<uint64_t>& value : calls) value.store(0, memory_order_relaxed);
+            for (atomic<uint64_t>& value : counters) value.store(0, memory_order_relaxed);
+        }
+    };
+
+    mutex blocksLock;
+    vector<unique_ptr<Block>> blocks; // Kept after their thread exits
+
+    Block& localBlock() {
+        thread_local Block* block = nullptr;
+        if (!block) {
+            lock_guard<mutex> guard(blocksLock);
+            blocks.push_back(make_unique<Block>());
+            block = blocks.back().get();
+        }
+        return *block;
+    }
+
+    static void bump(atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+
+    void merge(uint64_t* calls, LatencyHistogram* latency, uint64_t* counters) {
+        lock_guard<mutex> guard(blocksLock);
+        for (const unique_ptr<Block>& block : blocks) {
+            lock_guard<mutex> blockGuard(block->lock);
+            for (size_t i = 0; i < operationCount; i++) {
+                calls[i] += block->calls[i].load(memory_order_relaxed);
+                latency[i].merge(block->latency[i]);
+            }
+            for (size_t i = 0; i < counterCount; i++) counters[i] += block->counters[i].load(memory_order_relaxed);
+        }
+    }
+
+public:
+    // Counts a call; true if this call should be timed
+    bool startCall(Operation operation) {
+        atomic<uint64_t>& calls = localBlock().calls[static_cast<size_t>(operation)];
+        uint64_t previous = calls.load(memory_order_relaxed);
+        calls.store(previous + 1, memory_order_relaxed);
+        return previous % HMS_METRICS_SAMPLE == 0;
+    }
+
+    void record(Operation operation, uint64_t nanoseconds) {
+        Block& block = localBlock();
+        lock_guard<mutex> guard(block.lock);
+        block.latency[static_cast<size_t>(operation)].record(nanoseconds);
+    }
+
+    void count(Counter counter, uint64_t amount = 1) {
+        bump(localBlock().counters[static_cast<size_t>(counter)], amount);
+    }
+
+    // Operations that ran at least once, counters and the given gauges as aligned text
+    void writeText(ostream& out, const vector<pair<string, double>>& gauges) {
+        uint64_t calls[operationCount] = {};
+        vector<LatencyHistogram> latency(operationCount);
+        uint64_t counters[counterCount] = {};
+        merge(calls, latency.data(), counters);
+        out << left << setw(20) << "operation" << right << setw(12) << "calls" << setw(10) << "mean ns" << setw(10) << "p50"
+            << setw(10) << "p99" << setw(10) << "p99.9" << setw(12) << "max" << "\n";
+        for (size_t i = 0; i < operationCount; i++) {
+            const LatencyHistogram& histogram = latency[i];
+            if (calls[i] == 0) continue;
+            out << left << setw(20) << operationName(static_cast<Operation>(i)) << right << setw(12) << calls[i]
+                << setw(10) << static_cast<uint64_t>(histogram.getMean()) << setw(10) << histogram.percentile(50) << setw(10)
+                << histogram.percentile(99) << setw(10) << histogram.percentile(99.9) << setw(12) << histogram.getMax() << "\n";
+        }
+        for (size_t i = 0; i < counterCount; i++) {
+            out << left << setw(20) << counterName(static_cast<Counter>(i)) << right << setw(12) << counters[i] << "\n";
+        }
+        for (const pair<string, double>& gauge : gauges) {
+            out << left << setw(20) << gauge.first << right << setw(12) << gauge.second << "\n";
+        }
+        out << left;
+    }
+
+    void writeJson(ostream& out, const vector<pair<string, double>>& gauges) {
+        uint64_t calls[operationCount] = {};
+        vector<LatencyHistogram> latency(operationCount);
+        uint64_t counters[counterCount] = {};
+        merge(calls, latency.data(), counters);
+        out << "{\"operations\":{";
+        bool first = true;
+        for (size_t i = 0; i < operationCount; i++) {
+            const LatencyHistogram& histogram = latency[i];
+            if (calls[i] == 0) continue;
+            out << (first ? "" : ",") << "\"" << operationName(static_cast<Operation>(i)) << "\":{\"calls\":" << calls[i]
+                << ",\"timed\":" << histogram.getCount()
+                << ",\"mean_ns\":" << histogram.getMean() << ",\"p50_ns\":" << histogram.percentile(50)
+                << ",\"p99_ns\":" << histogram.percentile(99) << ",\"p999_ns\":" << histogram.percentile(99.9)
+                << ",\"max_ns\":" << histogram.getMax() << "}";
+            first = false;
+        }
+        out << "},\"counters\":{";
+        for (size_t i = 0; i < counterCount; i++) {
+            out << (i ? "," : "") << "\"" << counterName(static_cast<Counter>(i)) << "\":" << counters[i];
+        }
+        out << "},\"gauges\":{";
+        for (size_t i = 0; i < gauges.size(); i++) {
+            out << (i ? "," : "") << "\"" << gauges[i].first << "\":" << gauges[i].second;
+        }
+        out << "}}\n";
+    }
+};
+
+MetricsRegistry& metrics();
+
+// Counts the call and, if it is sampled, records the time from construction
+// to the end of the enclosing scope
+class ScopedTimer {
+private:
+    Operation operation;
+    bool timed;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Operation operation) : operation(operation), timed(metrics().startCall(operation)) {
+        if (timed) start = chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (timed) {
+            metrics().record(operation, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        }
+    }
+};
+
+#define HMS_CONCAT_INNER(a, b) a##b
+#define HMS_CONCAT(a, b) HMS_CONCAT_INNER(a, b)
+#if HMS_METRICS
+#define HMS_TIME(operation) ScopedTimer HMS_CONCAT(operationTimer, __LINE__)(Operation::operation)
+#define HMS_COUNT(counter, amount) metrics().count(Counter::counter, amount)
+#else
+#define HMS_TIME(operation) ((void)0)
+#define HMS_COUNT(counter, amount) ((void)0)
+#endif
+
+// ================= String Interning =================
+// Keeps one copy of every distinct string and hands out dense 32-bit IDs.
+// Symbol 0 is always the empty string. Safe to use from several threads:
+// strings live in fixed-size chunks that never move, so lookup() reads them
+// without taking the lock.
+class StringInterner {
+private:
+    static const size_t chunkBits = 12;
+    static const size_t chunkSize = size_t(1) << chunkBits;
+    static const size_t maxChunks = 16384;
+
+    unique_ptr<atomic<string*>[]> chunks;
+    uint32_t count = 0;
+    unordered_map<string_view, uint32_t> ids; // Views into the chunks
+    mutable shared_mutex lock;
+
+public:
+    StringInterner() : chunks(new atomic<string*>[maxChunks]) {
+        for (size_t i = 0; i < maxChunks; i++) {
+            chunks[i].store(nullptr, memory_order_relaxed);
+        }
+        intern("");
+    }
+
+    ~StringInterner() {
+        for (size_t i = 0; i < maxChunks; i++) {
+            delete[] chunks[i].load(memory_order_relaxed);
+        }
+    }
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    uint32_t intern(string_view text) {
+        {
+            shared_lock<shared_mutex> reader(lock);
+            auto it = ids.find(text);
+            if (it != ids.end()) return it->second;
+        }
+        unique_lock<shared_mutex> writer(lock);
+        auto it = ids.find(text);
+        if (it != ids.end()) return it->second;
+        if (count == chunkSize * maxChunks) {
+            throw runtime_error("Too many distinct field values.");
+        }
+        string* chunk = chunks[count >> chunkBits].load(memory_order_relaxed);
+        if (!chunk) {
+            chunk = new string[chunkSize];
+            chunks[count >> chunkBits].store(chunk, memory_order_release);
+        }
+        string& slot = chunk[count & (chunkSize - 1)];
+        slot.assign(text);
+        ids.emplace(slot, count);
+        return count++;
+    }
+
+    // ID of an already interned string, or false without adding it
+    bool find(string_view text, uint32_t& id) const {
+        shared_lock<shared_mutex> reader(lock);
+        auto it = ids.find(text);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    const string& lookup(uint32_t id) const {
+        return chunks[id >> chunkBits].load(memory_order_acquire)[id & (chunkSize - 1)];
+    }
+
+    size_t size() const {
+        shared_lock<shared_mutex> reader(lock);
+        return count;
+    }
+};
+
+StringInterner& symbolTable();
+
+// Field value drawn from a small vocabulary (condition, role, payment method, ...),
+// stored as its interned ID so records stay small and comparisons are integer compares
+struct Symbol {
+    uint32_t id;
+
+    Symbol() : id(0) {}
+    Symbol(const string& text) : id(symbolTable().intern(text)) {}
+    Symbol(const char* text) : id(symbolTable().intern(text)) {}
+
+    const string& str() const {
+        return symbolTable().lookup(id);
+    }
+
+    bool empty() const {
+        return id == 0;
+    }
+
+    bool operator==(Symbol other) const {
+        return id == other.id;
+    }
+
+    bool operator!=(Symbol other) const {
+        return id != other.id;
+    }
+};
+
+ostream& operator<<(ostream& out, Symbol symbol);
+
+// ================= Output Formatting =================
+// Text buffer for listings. Numbers are formatted with to_chars straight into
+// the buffer and the text reaches the stream in large blocks, instead of going
+// through per-field stream inserts with an endl flush on every line. The memory
+// is kept per thread and handed to the next listing.
+class OutputBuffer {
+private:
+    ostream& out;
+    string buffer;
+    size_t blockSize;
+
+    static string& spare() {
+        thread_local string storage;
+        return storage;
+    }
+
+    void writeBlock() {
+        if (!buffer.empty()) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    template <typename Number>
+    OutputBuffer& appendNumber(Number value) {
+        char digits[24];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+        return *this << string_view(digits, result.ptr - digits);
+    }
+
+public:
+    explicit OutputBuffer(ostream& out = cout, size_t blockSize = 1 << 16) : out(out), blockSize(blockSize) {
+        buffer.swap(spare());
+        buffer.clear();
+        buffer.reserve(blockSize);
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer() {
+        flush();
+        buffer.swap(spare());
+    }
+
+    OutputBuffer& operator<<(string_view text) {
+        if (buffer.size() + text.size() > blockSize) writeBlock();
+        buffer.append(text.data(), text.size());
+        return *this;
+    }
+
+    OutputBuffer& operator<<(const char* text) { return *this << string_view(text); }
+    OutputBuffer& operator<<(const string& text) { return *this << string_view(text); }
+    OutputBuffer& operator<<(Symbol symbol) { return *this << string_view(symbol.str()); }
+
+    OutputBuffer& operator<<(char c) {
+        if (buffer.size() >= blockSize) writeBlock();
+        buffer.push_back(c);
+        return *this;
+    }
+
+    OutputBuffer& operator<<(int value) { return appendNumber(value); }
+    OutputBuffer& operator<<(long value) { return appendNumber(value); }
+    OutputBuffer& operator<<(long long value) { return appendNumber(value); }
+    OutputBuffer& operator<<(unsigned value) { return appendNumber(value); }
+    OutputBuffer& operator<<(unsigned long value) { return appendNumber(value); }
+    OutputBuffer& operator<<(unsigned long long value) { return appendNumber(value); }
+
+    // Same text as ostream's default formatting (%g, 6 significant digits)
+    OutputBuffer& operator<<(double value) {
+        char digits[32];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value, chars_format::general, 6);
+        return *this << string_view(digits, result.ptr - digits);
+    }
+
+    // Writes out what is buffered and flushes the stream
+    void flush() {
+        writeBlock();
+        out.flush();
+    }
+};
+
+// ================= Mutation Log =================
+// Values are encoded in native byte order; the files are not meant to move between machines.
+class BinaryWriter {
+private:
+    string buffer;
+
+public:
+    void putRaw(const void* data, size_t size) {
+        buffer.append(static_cast<const char*>(data), size);
+    }
+
+    void putU8(uint8_t value) { putRaw(&value, sizeof(value)); }
+    void putU32(uint32_t value) { putRaw(&value, sizeof(value)); }
+    void putU64(uint64_t value) { putRaw(&value, sizeof(value)); }
+    void putInt(int32_t value) { putRaw(&value, sizeof(value)); }
+    void putDouble(double value) { putRaw(&value, sizeof(value)); }
+    void putBool(bool value) { putU8(value ? 1 : 0); }
+
+    void putString(const string& value) {
+        putU32(static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    const string& data() const {
+        return buffer;
+    }
+
+    size_t size() const {
+        return buffer.size();
+    }
+
+    void clear() {
+        buffer.clear();
+    }
+};
+
+class BinaryReader {
+private:
+    const char* current;
+    const char* end;
+
+    void take(void* out, size_t size) {
+        if (static_cast<size_t>(end - current) < size) {
+            throw runtime_error("Unexpected end of data.");
+        }
+        memcpy(out, current, size);
+        current += size;
+    }
+
+    template <typename T>
+    T get() {
+        T value;
+        take(&value, sizeof(value));
+        return value;
+    }
+
+public:
+    BinaryReader(const char* data, size_t size) : current(data), end(data + size) {}
+
+    uint8_t getU8() { return get<uint8_t>(); }
+    uint32_t getU32() { return get<uint32_t>(); }
+    uint64_t getU64() { return get<uint64_t>(); }
+    int32_t getInt() { return get<int32_t>(); }
+    double getDouble() { return get<double>(); }
+    bool getBool() { return getU8() != 0; }
+
+    string getString() {
+        uint32_t size = getU32();
+        if (static_cast<size_t>(end - current) < size) {
+            throw runtime_error("Unexpected end of data.");
+        }
+        string value(current, size);
+        current += size;
+        return value;
+    }
+
+    size_t remaining() const {
+        return end - current;
+    }
+};
+
+enum class MutationType : uint8_t {
+    PatientAdmit = 1,
+    PatientDischarge,
+    DoctorBook,
+    BedAdd,
+    BedAllocate,
+    BedRelease,
+    BedDischarge,
+    BillAdd,
+    BillPaid,
+    RecordAdd,
+    RecordUpdate,
+    RecordDelete,
+    StaffAdd,
+    StaffDelete,
+    BedOccupy,
+    DoctorCancel,
+    DoctorAdd,
+    BillSettle,
+    BedVacate,
+    BedServeWaiting
+};
+
+const char* mutationTypeName(MutationType type);
+
+// Receives every successful state change of the managers, e.g. to write it
+// ahead to disk. Replaying the entries in order rebuilds the same state.
+class MutationLog {
+public:
+    virtual ~MutationLog() = default;
+    virtual void append(MutationType type, const BinaryWriter& payload) = 0;
+};
+
+// Passes every mutation on to several logs in the order they were added
+class MutationFanout : public MutationLog {
+private:
+    vector<MutationLog*> sinks;
+
+public:
+    void add(MutationLog* sink) {
+        sinks.push_back(sink);
+    }
+
+    void append(MutationType type, const BinaryWriter& payload) override {
+        for (MutationLog* sink : sinks) {
+            sink->append(type, payload);
+        }
+    }
+};
+
+// ================= Snapshot Format =================
+// Snapshots are laid out so they can be mapped into memory and used
+// in place: a header, a table of sections, then 8-byte aligned sections of
+// fixed-size records. Strings live in one pool and are referenced by offset.
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SnapshotHeader {
+    char magic[8];            // "HMSSNAP\0"
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t sequence;        // Last write-ahead log record covered by the snapshot
+    uint64_t fileSize;
+    uint32_t payloadChecksum; // FNV-1a over everything after the section table
+    uint32_t headerChecksum;  // FNV-1a over the header (this field zeroed) and section table
+};
+
+enum class SnapshotSectionKind : uint32_t {
+    Meta = 1,
+    Strings,
+    Patients,
+    PatientIndex,     // Positions into Patients sorted by patient ID
+    Staff,
+    StaffIndex,
+    PendingBills,     // In heap order
+    PendingBillIndex,
+    PaidBills,
+    MedicalRecords,
+    Beds,             // Sorted by bed number
+    BedFreeBitmap,    // Bit i set while Beds[i] is free
+    WaitingList,
+    DoctorBookings,   // Booked appointment times
+    Doctors,
+    DoctorHours       // Weekly working times of each doctor
+};
+
+struct SnapshotSection {
+    uint32_t kind;
+    uint32_t recordSize;
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct SnapshotMeta {
+    uint64_t staffTableSize;
+};
+
+struct SnapshotPatient {
+    int32_t id;
+    int32_t age;
+    StringRef name;
+    StringRef condition;
+    StringRef doctorName;
+    StringRef appointmentTime;
+};
+
+struct SnapshotStaff {
+    int32_t id;
+    StringRef name;
+    StringRef role;
+    StringRef department;
+    StringRef shift;
+};
+
+struct SnapshotBill {
+    int32_t patientID;
+    uint32_t isPaid;
+    double totalAmount;
+    StringRef paymentMethod;
+    double paidByPatient;
+    double claimedFromInsurer;
+    double discount;
+};
+
+struct SnapshotMedicalRecord {
+    int32_t patientID;
+    int32_t age;
+    StringRef name;
+    StringRef medicalHistory;
+    StringRef prescriptions;
+    StringRef doctorNotes;
+};
+
+struct SnapshotBed {
+    int32_t bedNumber;
+    int32_t patientID; // -1 while free
+};
+
+struct SnapshotBooking {
+    uint32_t doctorIndex;
+    uint32_t time;
+};
+
+struct SnapshotDoctor {
+    StringRef name;
+    StringRef specialization;
+};
+
+struct SnapshotDoctorHour {
+    uint32_t doctorIndex;
+    uint32_t time;
+};
+
+const uint32_t snapshotVersion = 4;
+
+template <typename T>
+struct RecordSpan {
+    const T* records = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return records; }
+    const T* end() const { return records + count; }
+    const T& operator[](size_t i) const { return records[i]; }
+    size_t size() const { return count; }
+};
+
+// Read-only view of a whole file. Uses mmap where available so opening costs
+// the same regardless of the file size; otherwise the file is read into memory.
+class MappedFile {
+private:
+    const char* data;
+    size_t length;
+    vector<char> fallback;
+
+public:
+    MappedFile() : data(nullptr), length(0) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    void open(const string& path) {
+        close();
+#if defined(HMS_HAVE_MMAP)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw runtime_error("Cannot stat " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Cannot map " + path);
+            }
+            data = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+#else
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open " + path);
+        }
+        fallback.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        data = fallback.data();
+        length = fallback.size();
+#endif
+    }
+
+    void close() {
+#if defined(HMS_HAVE_MMAP)
+        if (data && length > 0) {
+            munmap(const_cast<char*>(data), length);
+        }
+#endif
+        fallback.clear();
+        data = nullptr;
+        length = 0;
+    }
+
+    const char* getData() const {
+        return data;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
+
+// Forces a file's contents, or a directory's entries, to disk; needed before a
+// rename is trusted to survive a power loss
+inline void syncPath(const string& path) {
+#if defined(HMS_HAVE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open " + path);
+    }
+    int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw runtime_error("Cannot sync " + path + ": " + strerror(errno));
+    }
+#endif
+}
+
+// FNV-1a, used to detect torn or corrupted files and records
+inline uint32_t checksum(const char* data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Collects fixed-size sections and writes them out as a snapshot stamped with snapshotVersion
+class SnapshotBuilder {
+private:
+    struct PendingSection {
+        SnapshotSectionKind kind;
+        uint32_t recordSize;
+        uint64_t count;
+        string bytes;
+    };
+
+    string strings;
+    unordered_map<string, uint32_t> pooled; // Repeated values are stored once
+    vector<PendingSection> sections;
+
+public:
+    StringRef addString(Symbol value) {
+        return addString(value.str());
+    }
+
+    StringRef addString(const string& value) {
+        auto it = pooled.find(value);
+        if (it != pooled.end()) {
+            return StringRef{it->second, static_cast<uint32_t>(value.size())};
+        }
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(value);
+        pooled.emplace(value, offset);
+        return StringRef{offset, static_cast<uint32_t>(value.size())};
+    }
+
+    template <typename T>
+    void addSection(SnapshotSectionKind kind, const vector<T>& records) {
+        PendingSection section{kind, static_cast<uint32_t>(sizeof(T)), records.size(), string()};
+        section.bytes.assign(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+        sections.push_back(move(section));
+    }
+
+    // Adds the positions of ids sorted by id, so lookups can binary search the mapped file
+    void addIndexSection(SnapshotSectionKind kind, const vector<int32_t>& ids) {
+        vector<uint32_t> positions(ids.size());
+        for (size_t i = 0; i < ids.size(); i++) positions[i] = static_cast<uint32_t>(i);
+        sort(positions.begin(), positions.end(), [&](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+        addSection(kind, positions);
+    }
+
+    void write(const string& path, uint64_t sequence) {
+        PendingSection stringSection{SnapshotSectionKind::Strings, 1, strings.size(), strings};
+        vector<const PendingSection*> all;
+        all.push_back(&stringSection);
+        for (const PendingSection& section : sections) all.push_back(&section);
+
+        auto align = [](uint64_t value) { return (value + 7) & ~static_cast<uint64_t>(7); };
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "HMSSNAP\0", 8);
+        header.version = snapshotVersion;
+        header.sectionCount = static_cast<uint32_t>(all.size());
+        header.sequence = sequence;
+
+        vector<SnapshotSection> table;
+        uint64_t offset = align(sizeof(SnapshotHeader) + all.size() * sizeof(SnapshotSection));
+        uint64_t payloadStart = offset;
+        for (const PendingSection* section : all) {
+            table.push_back(SnapshotSection{static_cast<uint32_t>(section->kind), section->recordSize, offset, section->count});
+            offset = align(offset + section->bytes.size());
+        }
+        header.fileSize = offset;
+
+        string payload(offset - payloadStart, '\0');
+        for (size_t i = 0; i < all.size(); i++) {
+            memcpy(&payload[table[i].offset - payloadStart], all[i]->bytes.data(), all[i]->bytes.size());
+        }
+        header.payloadChecksum = checksum(payload.data(), payload.size());
+        header.headerChecksum = checksum(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SnapshotSection),
+                                         checksum(reinterpret_cast<const char*>(&header), sizeof(header)));
+
+        ofstream file(path, ios::binary | ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SnapshotSection));
+        file.write(string(payloadStart - sizeof(header) - table.size() * sizeof(SnapshotSection), '\0').data(),
+                   payloadStart - sizeof(header) - table.size() * sizeof(SnapshotSection));
+        file.write(payload.data(), payload.size());
+        file.flush();
+        if (!file) {
+            throw runtime_error("Failed to write snapshot " + path);
+        }
+    }
+};
+
+// Mapped, validated snapshot. Records are read in place; nothing is parsed or
+// copied until a caller asks for it.
+class SnapshotView {
+private:
+    MappedFile file;
+    const SnapshotHeader* header;
+    const SnapshotSection* table;
+
+    const SnapshotSection* findSection(SnapshotSectionKind kind) const {
+        for (uint32_t i = 0; i < header->sectionCount; i++) {
+            if (table[i].kind == static_cast<uint32_t>(kind)) return &table[i];
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    const T* findByID(SnapshotSectionKind recordKind, SnapshotSectionKind indexKind, int id) const {
+        RecordSpan<T> items = records<T>(recordKind);
+        RecordSpan<uint32_t> index = records<uint32_t>(indexKind);
+        const uint32_t* found = lower_bound(index.begin(), index.end(), id,
+            [&](uint32_t position, int key) { return getID(items[position]) < key; });
+        if (found != index.end() && getID(items[*found]) == id) {
+            return &items[*found];
+        }
+        return nullptr;
+    }
+
+    static int getID(const SnapshotPatient& patient) { return patient.id; }
+    static int getID(const SnapshotStaff& staff) { return staff.id; }
+    static int getID(const SnapshotBill& bill) { return bill.patientID; }
+
+public:
+    SnapshotView() : header(nullptr), table(nullptr) {}
+
+    void open(const string& path) {
+        file.open(path);
+        const char* data = file.getData();
+        if (file.size() < sizeof(SnapshotHeader) || memcmp(data, "HMSSNAP\0", 8) != 0) {
+            throw runtime_error(path + " is not a hospital snapshot.");
+        }
+        header = reinterpret_cast<const SnapshotHeader*>(data);
+        if (header->version != snapshotVersion) {
+            throw runtime_error("Unsupported snapshot version " + to_string(header->version) + " in " + path + ".");
+        }
+        size_t tableEnd = sizeof(SnapshotHeader) + static_cast<size_t>(header->sectionCount) * sizeof(SnapshotSection);
+        if (header->fileSize != file.size() || tableEnd > file.size()) {
+            throw runtime_error("Snapshot " + path + " is truncated.");
+        }
+        table = reinterpret_cast<const SnapshotSection*>(data + sizeof(SnapshotHeader));
+
+        SnapshotHeader copy = *header;
+        copy.headerChecksum = 0;
+        uint32_t expected = checksum(reinterpret_cast<const char*>(table), header->sectionCount * sizeof(SnapshotSection),
+                                     checksum(reinterpret_cast<const char*>(&copy), sizeof(copy)));
+        if (expected != header->headerChecksum) {
+            throw runtime_error("Snapshot " + path + " has a corrupted header.");
+        }
+        for (uint32_t i = 0; i < header->sectionCount; i++) {
+            if (table[i].offset % 8 != 0 || table[i].offset + table[i].count * table[i].recordSize > file.size()) {
+                throw runtime_error("Snapshot " + path + " has an invalid section table.");
+            }
+        }
+    }
+
+    // Checks every payload byte; recovery does this, quick read-only opens may skip it
+    bool verifyPayload() const {
+        uint64_t payloadStart = (sizeof(SnapshotHeader) + header->sectionCount * sizeof(SnapshotSection) + 7) & ~static_cast<uint64_t>(7);
+        return checksum(file.getData() + payloadStart, file.size() - payloadStart) == header->payloadChecksum;
+    }
+
+    template <typename T>
+    RecordSpan<T> records(SnapshotSectionKind kind) const {
+        RecordSpan<T> span;
+        const SnapshotSection* section = findSection(kind);
+        if (section) {
+            if (section->recordSize != sizeof(T)) {
+                throw runtime_error("Snapshot section has an unexpected record size.");
+            }
+            span.records = reinterpret_cast<const T*>(file.getData() + section->offset);
+            span.count = section->count;
+        }
+        return span;
+    }
+
+    string_view str(StringRef ref) const {
+        const SnapshotSection* strings = findSection(SnapshotSectionKind::Strings);
+        if (!strings || static_cast<uint64_t>(ref.offset) + ref.length > strings->count) {
+            throw runtime_error("Snapshot string reference out of range.");
+        }
+        return string_view(file.getData() + strings->offset + ref.offset, ref.length);
+    }
+
+    string text(StringRef ref) const {
+        return string(str(ref));
+    }
+
+    const SnapshotPatient* findPatient(int id) const {
+        return findByID<SnapshotPatient>(SnapshotSectionKind::Patients, SnapshotSectionKind::PatientIndex, id);
+    }
+
+    const SnapshotStaff* findStaff(int id) const {
+        return findByID<SnapshotStaff>(SnapshotSectionKind::Staff, SnapshotSectionKind::StaffIndex, id);
+    }
+
+    const SnapshotBill* findPendingBill(int patientID) const {
+        return findByID<SnapshotBill>(SnapshotSectionKind::PendingBills, SnapshotSectionKind::PendingBillIndex, patientID);
+    }
+
+    size_t countFreeBeds() const {
+        size_t free = 0;
+        for (uint64_t word : records<uint64_t>(SnapshotSectionKind::BedFreeBitmap)) {
+            free += bitset<64>(word).count();
+        }
+        return free;
+    }
+
+    uint64_t getSequence() const {
+        return header->sequence;
+    }
+
+    uint64_t getFileSize() const {
+        return header->fileSize;
+    }
+};
+
+// ================= Patient Management =================
+struct Patient {
+    int id;
+    string name;
+    int age;
+    Symbol condition;
+    Symbol doctorName;
+    Symbol appointmentTime;
+    Patient* next;
+    Patient* prev;
+
+    Patient(int id, string name, int age, string condition, string doctorName = "", string appointmentTime = "")
+        : id(id), name(name), age(age), condition(condition), doctorName(doctorName), appointmentTime(appointmentTime), next(nullptr), prev(nullptr) {}
+};
+
+// Column kernels for census scans. The scalar versions are written branch-free
+// so compilers can vectorize them; the SSE2/AVX2 versions are used when the
+// target supports them (build with -mavx2 or -march=native for AVX2).
+uint64_t countEqualScalar(const uint32_t* values, size_t n, uint32_t key);
+
+// Sum of ages over the rows whose key column equals key; matches receives the row count
+uint64_t sumWhereEqualScalar(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches);
+// Same result as sumWhereEqualScalar, using the widest kernel the target supports
+uint64_t sumWhereEqual(const uint32_t* keys, const int32_t* ages, size_t n, uint32_t key, uint64_t& matches);
+const char* columnKernelName();
+
+struct CensusGroup {
+    Symbol value;
+    uint64_t patients;
+    double averageAge;
+};
+
+// Column-wise copy of the patient list for analytics: one contiguous array per
+// field, rows kept dense by moving the last row into a discharged patient's place.
+class PatientColumns {
+private:
+    vector<int32_t> ids;
+    vector<int32_t> ages;
+    vector<uint32_t> conditions;   // Symbol IDs
+    vector<uint32_t> doctors;      // Symbol IDs
+    vector<uint32_t> appointments; // Symbol IDs
+    IdIndex<uint32_t> rowOf;
+
+    // Per-value counts and average ages over one symbol column
+    vector<CensusGroup> groupBy(const vector<uint32_t>& column) const {
+        vector<uint64_t> counts, sums;
+        for (size_t i = 0; i < column.size(); i++) {
+            if (column[i] >= counts.size()) {
+                counts.resize(column[i] + 1, 0);
+                sums.resize(column[i] + 1, 0);
+            }
+            counts[column[i]]++;
+            sums[column[i]] += ages[i];
+        }
+        vector<CensusGroup> groups;
+        for (uint32_t symbol = 0; symbol < counts.size(); symbol++) {
+            if (counts[symbol] == 0) continue;
+            Symbol value;
+            value.id = symbol;
+            groups.push_back(CensusGroup{value, counts[symbol], double(sums[symbol]) / counts[symbol]});
+        }
+        return groups;
+    }
+
+public:
+    void add(const Patient& patient) {
+        rowOf.insert(patient.id, static_cast<uint32_t>(ids.size()));
+        ids.push_back(patient.id);
+        ages.push_back(patient.age);
+        conditions.push_back(patient.condition.id);
+        doctors.push_back(patient.doctorName.id);
+        appointments.push_back(patient.appointmentTime.id);
+    }
+
+    void remove(int id) {
+        uint32_t* found = rowOf.find(id);
+        if (!found) return;
+        uint32_t row = *found;
+        size_t last = ids.size() - 1;
+        if (row != last) {
+            ids[row] = ids[last];
+            ages[row] = ages[last];
+            conditions[row] = conditions[last];
+            doctors[row] = doctors[last];
+            appointments[row] = appointments[last];
+            *rowOf.find(ids[row]) = row;
+        }
+        rowOf.erase(id);
+        ids.pop_back();
+        ages.pop_back();
+        conditions.pop_back();
+        doctors.pop_back();
+        appointments.pop_back();
+    }
+
+    void reserve(size_t count) {
+        ids.reserve(count);
+        ages.reserve(count);
+        conditions.reserve(count);
+        doctors.reserve(count);
+        appointments.reserve(count);
+        rowOf.reserve(count);
+    }
+
+    void clear() {
+        ids.clear();
+        ages.clear();
+        conditions.clear();
+        doctors.clear();
+        appointments.clear();
+        rowOf.clear();
+    }
+
+    size_t size() const {
+        return ids.size();
+    }
+
+    uint64_t countCondition(Symbol condition) const {
+        return countEqualScalar(conditions.data(), conditions.size(), condition.id);
+    }
+
+    // Average age of the patients with the given condition, 0 if there are none
+    double averageAge(Symbol condition, uint64_t* matches = nullptr) const {
+        uint64_t count;
+        uint64_t sum = sumWhereEqual(conditions.data(), ages.data(), ages.size(), condition.id, count);
+        if (matches) *matches = count;
+        return count ? double(sum) / count : 0;
+    }
+
+    double averageAgeScalar(Symbol condition) const {
+        uint64_t count;
+        uint64_t sum = sumWhereEqualScalar(conditions.data(), ages.data(), ages.size(), condition.id, count);
+        return count ? double(sum) / count : 0;
+    }
+
+    vector<CensusGroup> countByCondition() const {
+        return groupBy(conditions);
+    }
+
+    vector<CensusGroup> countByDoctor() const {
+        return groupBy(doctors);
+    }
+};
+
+class PatientList {
+private:
+    Patient* head;
+    NodePool<Patient> nodes;
+    IdIndex<Patient*> index; // Patient ID -> node, kept in step with the list
+    int maxID;
+    MutationLog* mutationLog;
+    unique_ptr<PatientColumns> columns; // Built on first use, then kept in step
+
+public:
+    PatientList() : head(nullptr), maxID(0), mutationLog(nullptr) {}
+
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    void reserve(size_t count) {
+        index.reserve(count);
+    }
+
+    bool admitPatient(int id, string name, int age, string condition, string doctorName = "", string appointmentTime = "") {
+        if (!insertPatient(id, name, age, condition, doctorName, appointmentTime)) {
+            cout << "Error: Patient with ID " << id << " already exists." << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Links in a new patient; false if the ID is already admitted
+    bool insertPatient(int id, const string& name, int age, const string& condition, const string& doctorName = "", const string& appointmentTime = "") {
+        HMS_TIME(PatientAdmit);
+        if (index.find(id)) {
+            return false;
+        }
+        Patient* newPatient = nodes.create(id, name, age, condition, doctorName, appointmentTime);
+        newPatient->next = head;
+        if (head) head->prev = newPatient;
+        head = newPatient;
+        index.insert(id, newPatient);
+        maxID = max(maxID, id);
+        if (columns) columns->add(*newPatient);
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(id);
+            entry.putString(name);
+            entry.putInt(age);
+            entry.putString(condition);
+            entry.putString(doctorName);
+            entry.putString(appointmentTime);
+            mutationLog->append(MutationType::PatientAdmit, entry);
+        }
+        return true;
+    }
+
+    // Visits the patients from the most recently admitted
+    template <typename Function>
+    void forEach(Function function) const {
+        for (const Patient* patient = head; patient != nullptr; patient = patient->next) {
+            function(*patient);
+        }
+    }
+
+    bool dischargePatient(int id) {
+        HMS_TIME(PatientDischarge);
+        Patient** slot = index.find(id);
+        if (!slot) {
+            return false;
+        }
+        Patient* patient = *slot;
+        if (patient->prev) {
+            patient->prev->next = patient->next;
+        } else {
+            head = patient->next;
+        }
+        if (patient->next) patient->next->prev = patient->prev;
+        index.erase(id);
+        nodes.destroy(patient);
+        if (columns) columns->remove(id);
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(id);
+            mutationLog->append(MutationType::PatientDischarge, entry);
+        }
+        return true;
+    }
+
+    void displayPatients() const {
+        OutputBuffer out;
+        Patient* current = head;
+        while (current) {
+            out << "ID: " << current->id << ", Name: " << current->name
+                << ", Age: " << current->age << ", Condition: " << current->condition
+                << ", Doctor: " << current->doctorName
+                << ", Appointment: " << current->appointmentTime << '\n';
+            current = current->next;
+        }
+    }
+
+    Patient* searchPatientByID(int id) {
+        HMS_TIME(PatientFind);
+        Patient** slot = index.find(id);
+        return slot ? *slot : nullptr;
+    }
+
+    const Patient* searchPatientByID(int id) const {
+        Patient* const* slot = index.find(id);
+        return slot ? *slot : nullptr;
+    }
+
+    // Linear walk over the list; kept as the baseline for benchmarks
+    Patient* scanPatientByID(int id) {
+        Patient* current = head;
+        while (current) {
+            if (current->id == id) {
+                return current;
+            }
+            current = current->next;
+        }
+        return nullptr;
+    }
+
+    size_t size() const {
+        return index.size();
+    }
+
+    // Columnar copy for census scans; the first call builds it from the list
+    const PatientColumns& getColumns() {
+        if (!columns) {
+            columns.reset(new PatientColumns());
+            columns->reserve(index.size());
+            for (Patient* current = head; current; current = current->next) {
+                columns->add(*current);
+            }
+        }
+        return *columns;
+    }
+
+    // Same aggregate by walking the list; kept as the baseline for benchmarks
+    double averageAgeByWalk(Symbol condition) const {
+        uint64_t sum = 0, count = 0;
+        for (Patient* current = head; current; current = current->next) {
+            if (current->condition == condition) {
+                sum += current->age;
+                count++;
+            }
+        }
+        return count ? double(sum) / count : 0;
+    }
+
+    void displayCensus() {
+        const PatientColumns& census = getColumns();
+        OutputBuffer out;
+        out << "Patients: " << census.size() << " (column kernels: " << columnKernelName() << ")\n";
+        for (const CensusGroup& group : census.countByCondition()) {
+            out << "Condition " << group.value << ": " << group.patients << " patients, average age " << group.averageAge << '\n';
+        }
+        for (const CensusGroup& group : census.countByDoctor()) {
+            out << "Doctor " << (group.value.empty() ? "(none)" : group.value.str()) << ": " << group.patients
+                << " patients, average age " << group.averageAge << '\n';
+        }
+    }
+
+    int getNextID() const {
+        return maxID + 1;
+    }
+
+    // Writes patients oldest first so that re-admitting them restores the list order
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<SnapshotPatient> records;
+        vector<int32_t> ids;
+        records.reserve(index.size());
+        ids.reserve(index.size());
+        Patient* tail = head;
+        while (tail && tail->next) tail = tail->next;
+        for (Patient* current = tail; current; current = current->prev) {
+            records.push_back(SnapshotPatient{current->id, current->age, out.addString(current->name), out.addString(current->condition),
+                                              out.addString(current->doctorName), out.addString(current->appointmentTime)});
+            ids.push_back(current->id);
+        }
+        out.addSection(SnapshotSectionKind::Patients, records);
+        out.addIndexSection(SnapshotSectionKind::PatientIndex, ids);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        clear();
+        RecordSpan<SnapshotPatient> records = in.records<SnapshotPatient>(SnapshotSectionKind::Patients);
+        index.reserve(records.size());
+        for (const SnapshotPatient& record : records) {
+            admitPatient(record.id, in.text(record.name), record.age, in.text(record.condition),
+                         in.text(record.doctorName), in.text(record.appointmentTime));
+        }
+    }
+
+    void clear() {
+        Patient* current = head;
+        while (current) {
+            Patient* temp = current;
+            current = current->next;
+            nodes.destroy(temp);
+        }
+        head = nullptr;
+        index.clear();
+        maxID = 0;
+        columns.reset();
+    }
+
+    ~PatientList() {
+        clear();
+    }
+};
+
+// ================= Doctor Management =================
+// Appointment times are 30-minute slots counted from Monday 00:00 of the first
+// scheduling week: time = day * slotsPerDay + slot of the day.
+typedef uint32_t SlotTime;
+const uint32_t slotsPerDay = 48;
+const char* const weekdayNames[] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday"};
+
+SlotTime makeSlotTime(uint32_t day, int hour, int minute);
+
+// "9:30 AM on Monday", with the week added after the first one
+string formatSlotTime(SlotTime time);
+
+// Reads a day (a weekday name for the first week, or a day number counted from
+// that Monday) and a 24-hour "HH:MM" time on a half-hour boundary
+SlotTime parseSlotTime(const string& day, const string& clock);
+
+// Min-tournament tree: players hold keys, every inner node holds the player
+// with the smallest key below it. The overall winner is at the root and
+// changing one player's key replays only its path, O(log n).
+class TournamentTree {
+private:
+    vector<uint32_t> keys;   // Per player
+    vector<uint32_t> winner; // Per node; leaves start at capacity
+    size_t capacity = 0;
+
+    uint32_t better(uint32_t a, uint32_t b) const {
+        if (a == none) return b;
+        if (b == none) return a;
+        return keys[b] < keys[a] ? b : a;
+    }
+
+    void replay(size_t node) {
+        for (node /= 2; node >= 1; node /= 2) {
+            winner[node] = better(winner[2 * node], winner[2 * node + 1]);
+        }
+    }
+
+public:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    uint32_t addPlayer(uint32_t key) {
+        uint32_t player = static_cast<uint32_t>(keys.size());
+        keys.push_back(key);
+        if (keys.size() > capacity) {
+            capacity = max<size_t>(1, capacity * 2);
+            winner.assign(2 * capacity, none);
+            for (uint32_t i = 0; i < keys.size(); i++) winner[capacity + i] = i;
+            for (size_t node = capacity - 1; node >= 1; node--) {
+                winner[node] = better(winner[2 * node], winner[2 * node + 1]);
+            }
+        } else {
+            winner[capacity + player] = player;
+            replay(capacity + player);
+        }
+        return player;
+    }
+
+    void update(uint32_t player, uint32_t key) {
+        keys[player] = key;
+        replay(capacity + player);
+    }
+
+    uint32_t getKey(uint32_t player) const {
+        return keys[player];
+    }
+
+    // Player with the smallest key (ties go to the lower player), none if empty
+    uint32_t getWinner() const {
+        return capacity ? winner[1] : none;
+    }
+
+    // Up to k players in key order, visiting only the nodes above them
+    vector<uint32_t> topPlayers(size_t k) const {
+        vector<uint32_t> players;
+        if (!capacity || winner[1] == none) return players;
+        auto later = [&](size_t a, size_t b) {
+            return keys[winner[a]] != keys[winner[b]] ? keys[winner[a]] > keys[winner[b]] : winner[a] > winner[b];
+        };
+        priority_queue<size_t, vector<size_t>, decltype(later)> frontier(later);
+        frontier.push(1);
+        while (!frontier.empty() && players.size() < k) {
+            size_t node = frontier.top();
+            frontier.pop();
+            if (node >= capacity) {
+                players.push_back(winner[node]);
+                continue;
+            }
+            for (size_t child : {2 * node, 2 * node + 1}) {
+                if (winner[child] != none) frontier.push(child);
+            }
+        }
+        return players;
+    }
+};
+
+// Availability of every doctor as one bitmap per day (bit = slot of the day),
+// plus an ordered set of free (time, doctor) pairs per specialization so the
+// earliest free slot after any time is one lower_bound. Booking, cancelling
+// and searching are O(log n) in the number of free slots. Each doctor's next
+// free slot also sits in tournament trees (one over all doctors, one per
+// specialization), which answer "earliest now" in O(1) and top-k in O(k log d).
+class AppointmentScheduler {
+private:
+    struct DoctorCalendar {
+        uint32_t specialization; // Symbol ID
+        vector<uint64_t> open;   // Slots the doctor works, per day
+        vector<uint64_t> free;   // Open slots that are not booked, per day
+        SlotTime nextFree;       // Earliest free slot, noSlot if none
+        uint32_t player;         // Position in the specialization's tree
+    };
+
+    struct SpecializationTree {
+        TournamentTree tree;
+        vector<uint32_t> doctors; // Player -> doctor
+    };
+
+    vector<DoctorCalendar> calendars;
+    unordered_map<uint32_t, set<pair<SlotTime, uint32_t>>> freeBySpecialization;
+    TournamentTree allDoctors; // Player = doctor
+    unordered_map<uint32_t, SpecializationTree> treeBySpecialization;
+    size_t bookedCount = 0;
+
+    void setNextFree(uint32_t doctor, SlotTime time) {
+        DoctorCalendar& calendar = calendars[doctor];
+        calendar.nextFree = time;
+        allDoctors.update(doctor, time);
+        treeBySpecialization[calendar.specialization].tree.update(calendar.player, time);
+    }
+
+    // First free slot of the doctor at or after `from`, noSlot if there is none
+    SlotTime findNextFree(uint32_t doctor, SlotTime from) const {
+        const vector<uint64_t>& free = calendars[doctor].free;
+        uint32_t day = from / slotsPerDay;
+        if (day >= free.size()) return noSlot;
+        uint64_t bits = free[day] & (~uint64_t(0) << (from % slotsPerDay));
+        while (!bits) {
+            if (++day >= free.size()) return noSlot;
+            bits = free[day];
+        }
+        return day * slotsPerDay + countTrailingZeros(bits);
+    }
+
+    // The k soonest free slots of the given tree's players. Only the k doctors
+    // whose next free slot is soonest can contribute, so their free slots are
+    // merged in time order.
+    vector<pair<SlotTime, uint32_t>> soonestFrom(const TournamentTree& tree, const vector<uint32_t>* doctorOf, size_t k) const {
+        typedef pair<SlotTime, uint32_t> Slot;
+        priority_queue<Slot, vector<Slot>, greater<Slot>> streams;
+        for (uint32_t player : tree.topPlayers(k)) {
+            if (tree.getKey(player) == noSlot) break;
+            streams.emplace(tree.getKey(player), doctorOf ? (*doctorOf)[player] : player);
+        }
+        vector<Slot> slots;
+        while (!streams.empty() && slots.size() < k) {
+            Slot slot = streams.top();
+            streams.pop();
+            slots.push_back(slot);
+            SlotTime next = findNextFree(slot.second, slot.first + 1);
+            if (next != noSlot) streams.emplace(next, slot.second);
+        }
+        return slots;
+    }
+
+    static uint64_t bitOf(SlotTime time) {
+        return uint64_t(1) << (time % slotsPerDay);
+    }
+
+    bool hasDay(uint32_t doctor, SlotTime time) const {
+        return doctor < calendars.size() && time / slotsPerDay < calendars[doctor].open.size();
+    }
+
+public:
+    static constexpr SlotTime noSlot = UINT32_MAX;
+
+    uint32_t addDoctor(Symbol specialization) {
+        uint32_t doctor = static_cast<uint32_t>(calendars.size());
+        SpecializationTree& group = treeBySpecialization[specialization.id];
+        calendars.push_back(DoctorCalendar{specialization.id, {}, {}, noSlot, group.tree.addPlayer(noSlot)});
+        group.doctors.push_back(doctor);
+        allDoctors.addPlayer(noSlot);
+        return doctor;
+    }
+
+    // Makes a time bookable for the doctor
+    void openSlot(uint32_t doctor, SlotTime time) {
+        DoctorCalendar& calendar = calendars.at(doctor);
+        uint32_t day = time / slotsPerDay;
+        if (day >= calendar.open.size()) {
+            calendar.open.resize(day + 1, 0);
+            calendar.free.resize(day + 1, 0);
+        }
+        if (calendar.open[day] & bitOf(time)) return;
+        calendar.open[day] |= bitOf(time);
+        calendar.free[day] |= bitOf(time);
+        freeBySpecialization[calendar.specialization].emplace(time, doctor);
+        if (time < calendar.nextFree) setNextFree(doctor, time);
+    }
+
+    bool isFree(uint32_t doctor, SlotTime time) const {
+        return hasDay(doctor, time) && (calendars[doctor].free[time / slotsPerDay] & bitOf(time));
+    }
+
+    bool isBooked(uint32_t doctor, SlotTime time) const {
+        return hasDay(doctor, time) && (calendars[doctor].open[time / slotsPerDay] & ~calendars[doctor].free[time / slotsPerDay] & bitOf(time));
+    }
+
+    bool book(uint32_t doctor, SlotTime time) {
+        if (!isFree(doctor, time)) return false;
+        DoctorCalendar& calendar = calendars[doctor];
+        calendar.free[time / slotsPerDay] &= ~bitOf(time);
+        freeBySpecialization[calendar.specialization].erase({time, doctor});
+        bookedCount++;
+        if (time == calendar.nextFree) setNextFree(doctor, findNextFree(doctor, time + 1));
+        return true;
+    }
+
+    bool cancel(uint32_t doctor, SlotTime time) {
+        if (!isBooked(doctor, time)) return false;
+        DoctorCalendar& calendar = calendars[doctor];
+        calendar.free[time / slotsPerDay] |= bitOf(time);
+        freeBySpecialization[calendar.specialization].emplace(time, doctor);
+        bookedCount--;
+        if (time < calendar.nextFree) setNextFree(doctor, time);
+        return true;
+    }
+
+    // Moves a booking to another free time of the same doctor
+    bool rebook(uint32_t doctor, SlotTime from, SlotTime to) {
+        if (!isBooked(doctor, from) || !isFree(doctor, to)) return false;
+        book(doctor, to);
+        cancel(doctor, from);
+        return true;
+    }
+
+    // Earliest free slot at or after `after` among the doctors with the specialization
+    bool findEarliest(Symbol specialization, SlotTime after, SlotTime& time, uint32_t& doctor) const {
+        auto it = freeBySpecialization.find(specialization.id);
+        if (it == freeBySpecialization.end()) return false;
+        auto slot = it->second.lower_bound({after, 0});
+        if (slot == it->second.end()) return false;
+        time = slot->first;
+        doctor = slot->second;
+        return true;
+    }
+
+    // Earliest free slot of any doctor with the specialization, read off the tree root
+    bool findEarliest(Symbol specialization, SlotTime& time, uint32_t& doctor) const {
+        auto it = treeBySpecialization.find(specialization.id);
+        if (it == treeBySpecialization.end()) return false;
+        uint32_t player = it->second.tree.getWinner();
+        if (player == TournamentTree::none || it->second.tree.getKey(player) == noSlot) return false;
+        time = it->second.tree.getKey(player);
+        doctor = it->second.doctors[player];
+        return true;
+    }
+
+    // The k soonest free (time, doctor) slots across all doctors
+    vector<pair<SlotTime, uint32_t>> findSoonest(size_t k) const {
+        return soonestFrom(allDoctors, nullptr, k);
+    }
+
+    // The k soonest free slots among doctors with the specialization
+    vector<pair<SlotTime, uint32_t>> findSoonest(size_t k, Symbol specialization) const {
+        auto it = treeBySpecialization.find(specialization.id);
+        if (it == treeBySpecialization.end()) return {};
+        return soonestFrom(it->second.tree, &it->second.doctors, k);
+    }
+
+    // The n-th (1-based) free slot of a doctor in time order
+    bool findNthFree(uint32_t doctor, int n, SlotTime& time) const {
+        if (doctor >= calendars.size() || n <= 0) return false;
+        const vector<uint64_t>& free = calendars[doctor].free;
+        for (uint32_t day = 0; day < free.size(); day++) {
+            int count = countSetBits(free[day]);
+            if (n > count) {
+                n -= count;
+                continue;
+            }
+            uint64_t bits = free[day];
+            while (--n > 0) bits &= bits - 1;
+            time = day * slotsPerDay + countTrailingZeros(bits);
+            return true;
+        }
+        return false;
+    }
+
+    vector<SlotTime> getFreeSlots(uint32_t doctor) const {
+        vector<SlotTime> times;
+        const vector<uint64_t>& free = calendars.at(doctor).free;
+        for (uint32_t day = 0; day < free.size(); day++) {
+            for (uint64_t bits = free[day]; bits; bits &= bits - 1) {
+                times.push_back(day * slotsPerDay + countTrailingZeros(bits));
+            }
+        }
+        return times;
+    }
+
+    vector<SlotTime> getBookedSlots(uint32_t doctor) const {
+        vector<SlotTime> times;
+        const DoctorCalendar& calendar = calendars.at(doctor);
+        for (uint32_t day = 0; day < calendar.open.size(); day++) {
+            for (uint64_t bits = calendar.open[day] & ~calendar.free[day]; bits; bits &= bits - 1) {
+                times.push_back(day * slotsPerDay + countTrailingZeros(bits));
+            }
+        }
+        return times;
+    }
+
+    size_t getBookedCount() const {
+        return bookedCount;
+    }
+
+    size_t getDoctorCount() const {
+        return calendars.size();
+    }
+
+    void clear() {
+        calendars.clear();
+        freeBySpecialization.clear();
+        allDoctors = TournamentTree();
+        treeBySpecialization.clear();
+        bookedCount = 0;
+    }
+};
+
+struct Doctor {
+    string name;
+    string specialization;
+    vector<SlotTime> weeklyHours; // Times within the first week (days 0-6), repeated every scheduled week
+
+    Doctor(string name, string specialization, vector<SlotTime> weeklyHours)
+        : name(name), specialization(specialization), weeklyHours(weeklyHours) {}
+};
+
+class DoctorManagement {
+private:
+    vector<Doctor> doctors;
+    AppointmentScheduler scheduler;
+    int scheduleWeeks;
+    MutationLog* mutationLog = nullptr;
+
+    void logBooking(MutationType type, int doctorIndex, SlotTime time) {
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(doctorIndex);
+            entry.putU32(time);
+            mutationLog->append(type, entry);
+        }
+    }
+
+    void addDefaultDoctors() {
+        addDoctor("Dr. Ahmad", "Cardiologist", {makeSlotTime(0, 9, 0), makeSlotTime(1, 10, 0), makeSlotTime(3, 11, 0)});
+        addDoctor("Dr. Fatima", "Dermatologist", {makeSlotTime(2, 9, 30), makeSlotTime(4, 10, 30), makeSlotTime(0, 13, 0)});
+        addDoctor("Dr. Ibrahim", "Neurologist", {makeSlotTime(1, 10, 0), makeSlotTime(2, 12, 0), makeSlotTime(3, 14, 0)});
+        addDoctor("Dr. Maham", "Orthopedist", {makeSlotTime(0, 8, 30), makeSlotTime(1, 14, 0), makeSlotTime(2, 11, 0)});
+        addDoctor("Dr. Shoaib", "Pediatrician", {makeSlotTime(4, 9, 0), makeSlotTime(5, 14, 0), makeSlotTime(6, 10, 0)});
+        addDoctor("Dr. Abbas", "Oncologist", {makeSlotTime(0, 10, 0), makeSlotTime(2, 15, 0), makeSlotTime(4, 13, 0)});
+        addDoctor("Dr. Zarrar", "Gastroenterologist", {makeSlotTime(1, 8, 0), makeSlotTime(3, 11, 0), makeSlotTime(4, 14, 30)});
+    }
+
+public:
+    DoctorManagement(int scheduleWeeks = 1) : scheduleWeeks(scheduleWeeks) {
+        addDefaultDoctors();
+    }
+
+    // Adds a doctor who works the given times of the week in every scheduled week
+    int addDoctor(const string& name, const string& specialization, const vector<SlotTime>& weeklyHours) {
+        for (SlotTime time : weeklyHours) {
+            if (time >= 7 * slotsPerDay) {
+                throw out_of_range("Weekly hours must fall within one week.");
+            }
+        }
+        uint32_t index = scheduler.addDoctor(Symbol(specialization));
+        for (int week = 0; week < scheduleWeeks; week++) {
+            for (SlotTime time : weeklyHours) {
+                scheduler.openSlot(index, time + week * 7 * slotsPerDay);
+            }
+        }
+        doctors.push_back(Doctor(name, specialization, weeklyHours));
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putString(name);
+            entry.putString(specialization);
+            entry.putU32(static_cast<uint32_t>(weeklyHours.size()));
+            for (SlotTime time : weeklyHours) {
+                entry.putU32(time);
+            }
+            mutationLog->append(MutationType::DoctorAdd, entry);
+        }
+        return static_cast<int>(index);
+    }
+
+    void showDoctors() {
+        OutputBuffer out;
+        out << "From whom you want a checkup:\n";
+        for (int i = 0; i < getDoctorsCount(); i++) {
+            out << i + 1 << ". " << doctors[i].name << " - " << doctors[i].specialization << '\n';
+            out << "Available times: \n";
+            for (SlotTime time : scheduler.getFreeSlots(i)) {
+                out << formatSlotTime(time) << '\n';
+            }
+            out << '\n';
+        }
+    }
+
+    bool allocateDoctorAppointment(int doctorIndex, string& appointmentTime) {
+        if (doctorIndex < 0 || doctorIndex >= getDoctorsCount()) return false;
+
+        Doctor& doctor = doctors[doctorIndex];
+
+        // Ask the user to select an appointment time from available options
+        cout << "Choose an available appointment time:\n";
+        vector<SlotTime> freeSlots = scheduler.getFreeSlots(doctorIndex);
+        for (SlotTime time : freeSlots) {
+            cout << formatSlotTime(time) << "\n";
+        }
+
+        if (freeSlots.empty()) {
+            cout << "No appointments available for Dr. " << doctor.name << " in this week.\n";
+            return false;
+        }
+
+        int timeChoice;
+        while (true) {
+            cout << "Enter the number for your appointment choice: ";
+            string input;
+            cin >> input;
+
+            if (isNumericString(input)) {
+                timeChoice = stoi(input);
+
+                if (bookAppointment(doctorIndex, timeChoice, appointmentTime)) {
+                    return true;
+                } else {
+                    cout << "Invalid choice. Please try again.\n";
+                }
+            } else {
+                cout << "Wrong choice. Please enter a valid number.\n";
+            }
+        }
+
+        return false;
+    }
+
+    // Books the n-th (1-based) currently available time of a doctor without prompting
+    bool bookAppointment(int doctorIndex, int timeChoice, string& appointmentTime) {
+        if (doctorIndex < 0 || doctorIndex >= getDoctorsCount()) return false;
+
+        SlotTime time;
+        if (!scheduler.findNthFree(doctorIndex, timeChoice, time)) return false;
+        bookSlot(doctorIndex, time);
+        appointmentTime = formatSlotTime(time);
+        return true;
+    }
+
+    // Books a specific free time of a doctor
+    void bookSlot(int doctorIndex, SlotTime time) {
+        HMS_TIME(DoctorBook);
+        if (doctorIndex < 0 || doctorIndex >= getDoctorsCount() || !scheduler.book(doctorIndex, time)) {
+            throw out_of_range("Appointment slot is not available.");
+        }
+        logBooking(MutationType::DoctorBook, doctorIndex, time);
+    }
+
+    bool cancelAppointment(int doctorIndex, SlotTime time) {
+        HMS_TIME(DoctorCancel);
+        if (doctorIndex < 0 || doctorIndex >= getDoctorsCount() || !scheduler.cancel(doctorIndex, time)) {
+            return false;
+        }
+        logBooking(MutationType::DoctorCancel, doctorIndex, time);
+        return true;
+    }
+
+    bool rebookAppointment(int doctorIndex, SlotTime from, SlotTime to) {
+        if (doctorIndex < 0 || doctorIndex >= getDoctorsCount() || !scheduler.rebook(doctorIndex, from, to)) {
+            return false;
+        }
+        logBooking(MutationType::DoctorBook, doctorIndex, to);
+        logBooking(MutationType::DoctorCancel, doctorIndex, from);
+        return true;
+    }
+
+    // Books the earliest free slot at or after `after` with any doctor of the specialization
+    bool bookEarliest(const string& specialization, SlotTime after, int& doctorIndex, string& appointmentTime) {
+        uint32_t symbol, doctor;
+        SlotTime time;
+        if (!symbolTable().find(specialization, symbol)) return false;
+        Symbol wanted;
+        wanted.id = symbol;
+        if (!scheduler.findEarliest(wanted, after, time, doctor)) return false;
+        bookSlot(doctor, time);
+        doctorIndex = static_cast<int>(doctor);
+        appointmentTime = formatSlotTime(time);
+        return true;
+    }
+
+    // Lists the k soonest free appointments, optionally only for one specialization
+    void showSoonest(size_t k, const string& specialization = "") const {
+        vector<pair<SlotTime, uint32_t>> slots;
+        if (specialization.empty()) {
+            slots = scheduler.findSoonest(k);
+        } else {
+            uint32_t symbol;
+            if (symbolTable().find(specialization, symbol)) {
+                Symbol wanted;
+                wanted.id = symbol;
+                slots = scheduler.findSoonest(k, wanted);
+            }
+        }
+        if (slots.empty()) {
+            cout << "No appointments available.\n";
+            return;
+        }
+        OutputBuffer out;
+        out << "Soonest available appointments:\n";
+        for (const pair<SlotTime, uint32_t>& slot : slots) {
+            const Doctor& doctor = doctors[slot.second];
+            out << slot.second + 1 << ". " << doctor.name << " (" << doctor.specialization << ") - " << formatSlotTime(slot.first) << '\n';
+        }
+    }
+
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<SnapshotDoctor> roster;
+        vector<SnapshotDoctorHour> hours;
+        vector<SnapshotBooking> bookings;
+        for (size_t i = 0; i < doctors.size(); i++) {
+            roster.push_back(SnapshotDoctor{out.addString(doctors[i].name), out.addString(doctors[i].specialization)});
+            for (SlotTime time : doctors[i].weeklyHours) {
+                hours.push_back(SnapshotDoctorHour{static_cast<uint32_t>(i), time});
+            }
+            for (SlotTime time : scheduler.getBookedSlots(i)) {
+                bookings.push_back(SnapshotBooking{static_cast<uint32_t>(i), time});
+            }
+        }
+        out.addSection(SnapshotSectionKind::Doctors, roster);
+        out.addSection(SnapshotSectionKind::DoctorHours, hours);
+        out.addSection(SnapshotSectionKind::DoctorBookings, bookings);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        RecordSpan<SnapshotDoctor> roster = in.records<SnapshotDoctor>(SnapshotSectionKind::Doctors);
+        vector<vector<SlotTime>> hours(roster.size());
+        for (const SnapshotDoctorHour& hour : in.records<SnapshotDoctorHour>(SnapshotSectionKind::DoctorHours)) {
+            if (hour.doctorIndex < hours.size()) hours[hour.doctorIndex].push_back(hour.time);
+        }
+        doctors.clear();
+        scheduler.clear();
+        for (size_t i = 0; i < roster.size(); i++) {
+            addDoctor(in.text(roster[i].name), in.text(roster[i].specialization), hours[i]);
+        }
+        if (roster.size() == 0) addDefaultDoctors();
+        for (const SnapshotBooking& booking : in.records<SnapshotBooking>(SnapshotSectionKind::DoctorBookings)) {
+            scheduler.book(booking.doctorIndex, booking.time);
+        }
+    }
+
+    int getDoctorsCount() const {
+        return static_cast<int>(doctors.size());
+    }
+
+    size_t getBookedCount() const {
+        return scheduler.getBookedCount();
+    }
+
+    string getDoctorName(int index) {
+        if (index < 0 || index >= getDoctorsCount()) {
+            return "Invalid doctor index";
+        }
+        return doctors[index].name;
+    }
+
+    string getDoctorSpecialization(int index) {
+        if (index < 0 || index >= getDoctorsCount()) {
+            return "Invalid doctor index";
+        }
+        return doctors[index].specialization;
+    }
+};
+
+// ================= Bed Management =================
+struct BedNode {
+    int bedNumber;
+    bool isAvailable;
+    int patientID;  // Occupant, -1 while the bed is free
+    int height;
+    int freeCount;  // Available beds in this subtree
+    BedNode* left;
+    BedNode* right;
+
+    BedNode(int bedNumber)
+        : bedNumber(bedNumber), isAvailable(true), patientID(-1), height(1), freeCount(1), left(nullptr), right(nullptr) {}
+};
+
+// FIFO of patients waiting for a bed, stored in a growable ring buffer so
+// enqueue/dequeue never allocate per element. Urgent patients jump to the front.
+// Cancelled entries stay in the ring and are skipped when they reach the head.
+class WaitingQueue {
+private:
+    struct Entry {
+        int patientID;
+        uint64_t ticket;
+        chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    vector<Entry> ring;
+    size_t head;
+    size_t used;            // Slots in the ring, including cancelled entries
+    IdIndex<uint64_t> waiting; // Patient ID -> ticket of its live entry
+    size_t peakDepth;
+    uint64_t enqueuedCount;
+    uint64_t servedCount;
+    LatencyHistogram waitTimes; // Microseconds from enqueue to bed assignment
+
+    void grow() {
+        vector<Entry> larger(ring.size() * 2);
+        for (size_t i = 0; i < used; i++) {
+            larger[i] = ring[(head + i) & (ring.size() - 1)];
+        }
+        ring.swap(larger);
+        head = 0;
+    }
+
+public:
+    WaitingQueue() : ring(16), head(0), used(0), peakDepth(0), enqueuedCount(0), servedCount(0) {}
+
+    bool push(int patientID, bool urgent = false) {
+        if (!waiting.insert(patientID, enqueuedCount)) return false;
+        if (used == ring.size()) grow();
+
+        Entry entry{patientID, enqueuedCount, chrono::steady_clock::now()};
+        if (urgent) {
+            head = (head - 1) & (ring.size() - 1);
+            ring[head] = entry;
+        } else {
+            ring[(head + used) & (ring.size() - 1)] = entry;
+        }
+        used++;
+        enqueuedCount++;
+        peakDepth = max(peakDepth, waiting.size());
+        return true;
+    }
+
+    // Removes the next live patient; returns -1 when nobody is waiting
+    int pop() {
+        while (used > 0) {
+            Entry entry = ring[head];
+            head = (head + 1) & (ring.size() - 1);
+            used--;
+            uint64_t* ticket = waiting.find(entry.patientID);
+            if (ticket && *ticket == entry.ticket) {
+                waiting.erase(entry.patientID);
+                servedCount++;
+                waitTimes.record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - entry.enqueuedAt).count());
+                return entry.patientID;
+            }
+        }
+        return -1;
+    }
+
+    bool cancel(int patientID) {
+        bool removed = waiting.erase(patientID);
+        if (waiting.size() == 0) {
+            head = 0;
+            used = 0;
+        }
+        return removed;
+    }
+
+    bool contains(int patientID) const {
+        return waiting.find(patientID) != nullptr;
+    }
+
+    size_t size() const {
+        return waiting.size();
+    }
+
+    size_t getPeakDepth() const {
+        return peakDepth;
+    }
+
+    uint64_t getEnqueuedCount() const {
+        return enqueuedCount;
+    }
+
+    uint64_t getServedCount() const {
+        return servedCount;
+    }
+
+    const LatencyHistogram& getWaitTimes() const {
+        return waitTimes;
+    }
+
+    // Live patients in the order they will be served
+    vector<int> getWaitingPatients() const {
+        vector<int> patients;
+        for (size_t i = 0; i < used; i++) {
+            const Entry& entry = ring[(head + i) & (ring.size() - 1)];
+            const uint64_t* ticket = waiting.find(entry.patientID);
+            if (ticket && *ticket == entry.ticket) {
+                patients.push_back(entry.patientID);
+            }
+        }
+        return patients;
+    }
+};
+
+class BedManagement {
+private:
+    BedNode* root;
+    NodePool<BedNode> nodes;
+    WaitingQueue waitingList;
+    IdIndex<int> bedOfPatient; // Patient ID -> occupied bed number
+    int bedCount;
+    MutationLog* mutationLog;
+
+    int getHeight(BedNode* node) {
+        return node ? node->height : 0;
+    }
+
+    int getFreeCount(BedNode* node) {
+        return node ? node->freeCount : 0;
+    }
+
+    // Recomputes the augmented fields from the children
+    void update(BedNode* node) {
+        node->height = max(getHeight(node->left), getHeight(node->right)) + 1;
+        node->freeCount = getFreeCount(node->left) + getFreeCount(node->right) + (node->isAvailable ? 1 : 0);
+    }
+
+    int getBalanceFactor(BedNode* node) {
+        return node ? getHeight(node->left) - getHeight(node->right) : 0;
+    }
+
+    BedNode* rotateRight(BedNode* y) {
+        BedNode* x = y->left;
+        BedNode* T2 = x->right;
+
+        x->right = y;
+        y->left = T2;
+
+        update(y);
+        update(x);
+
+        return x;
+    }
+
+    BedNode* rotateLeft(BedNode* x) {
+        BedNode* y = x->right;
+        BedNode* T2 = y->left;
+
+        y->left = x;
+        x->right = T2;
+
+        update(x);
+        update(y);
+
+        return y;
+    }
+
+    BedNode* balance(BedNode* node) {
+        int balanceFactor = getBalanceFactor(node);
+
+        if (balanceFactor > 1 && getBalanceFactor(node->left) >= 0)
+            return rotateRight(node);
+
+        if (balanceFactor < -1 && getBalanceFactor(node->right) <= 0)
+            return rotateLeft(node);
+
+        if (balanceFactor > 1 && getBalanceFactor(node->left) < 0) {
+            node->left = rotateLeft(node->left);
+            return rotateRight(node);
+        }
+
+        if (balanceFactor < -1 && getBalanceFactor(node->right) > 0) {
+            node->right = rotateRight(node->right);
+            return rotateLeft(node);
+        }
+
+        return node;
+    }
+
+    BedNode* addBed(BedNode* node, int bedNumber) {
+        if (!node) {
+            bedCount++;
+            return nodes.create(bedNumber);
+        }
+
+        if (bedNumber < node->bedNumber)
+            node->left = addBed(node->left, bedNumber);
+        else if (bedNumber > node->bedNumber)
+            node->right = addBed(node->right, bedNumber);
+
+        update(node);
+
+        return balance(node);
+    }
+
+    // Follows the free counts down to the lowest-numbered free bed: O(log n)
+    int claimLowestFree(BedNode* node, int patientId) {
+        int bedNumber;
+        if (getFreeCount(node->left) > 0) {
+            bedNumber = claimLowestFree(node->left, patientId);
+        } else if (node->isAvailable) {
+            node->isAvailable = false;
+            node->patientID = patientId;
+            bedNumber = node->bedNumber;
+        } else {
+            bedNumber = claimLowestFree(node->right, patientId);
+        }
+        node->freeCount--;
+        return bedNumber;
+    }
+
+    // Frees an occupied bed and fixes the free counts on the way back up
+    bool freeBed(BedNode* node, int bedNumber, int& patientId) {
+        if (!node) return false;
+
+        bool freed;
+        if (bedNumber < node->bedNumber) {
+            freed = freeBed(node->left, bedNumber, patientId);
+        } else if (bedNumber > node->bedNumber) {
+            freed = freeBed(node->right, bedNumber, patientId);
+        } else {
+            freed = !node->isAvailable;
+            patientId = node->patientID;
+            node->isAvailable = true;
+            node->patientID = -1;
+        }
+        if (freed) node->freeCount++;
+        return freed;
+    }
+
+    bool claimBed(BedNode* node, int bedNumber, int patientId) {
+        if (!node) return false;
+
+        bool claimed;
+        if (bedNumber < node->bedNumber) {
+            claimed = claimBed(node->left, bedNumber, patientId);
+        } else if (bedNumber > node->bedNumber) {
+            claimed = claimBed(node->right, bedNumber, patientId);
+        } else {
+            claimed = node->isAvailable;
+            if (claimed) {
+                node->isAvailable = false;
+                node->patientID = patientId;
+            }
+        }
+        if (claimed) node->freeCount--;
+        return claimed;
+    }
+
+    void destroy(BedNode* node) {
+        if (!node) return;
+        destroy(node->left);
+        destroy(node->right);
+        nodes.destroy(node);
+    }
+
+    void collectBeds(BedNode* node, vector<BedNode*>& out) const {
+        if (!node) return;
+        collectBeds(node->left, out);
+        out.push_back(node);
+        collectBeds(node->right, out);
+    }
+
+    // Builds a perfectly balanced subtree from beds sorted by number
+    BedNode* buildBalanced(const SnapshotBed* beds, int low, int high) {
+        if (low > high) return nullptr;
+        int middle = low + (high - low) / 2;
+        BedNode* node = nodes.create(beds[middle].bedNumber);
+        node->patientID = beds[middle].patientID;
+        node->isAvailable = node->patientID == -1;
+        node->left = buildBalanced(beds, low, middle - 1);
+        node->right = buildBalanced(beds, middle + 1, high);
+        update(node);
+        return node;
+    }
+
+    int assignBed(int patientId, bool urgent) {
+        if (int* bed = bedOfPatient.find(patientId)) {
+            cout << "Patient ID " << patientId << " already occupies bed " << *bed << "." << endl;
+            return *bed;
+        }
+        if (getFreeCount(root) > 0) {
+            int bedNumber = claimLowestFree(root, patientId);
+            bedOfPatient.insert(patientId, bedNumber);
+            cout << "Bed " << bedNumber << " allocated to patient ID " << patientId << " successfully." << endl;
+            return bedNumber;
+        } else {
+            if (waitingList.push(patientId, urgent)) {
+                cout << "No beds available. Adding patient ID " << patientId << " to waiting list." << endl;
+            } else {
+                cout << "Patient ID " << patientId << " is already on the waiting list." << endl;
+            }
+            return -1;
+        }
+    }
+
+    // Frees the bed and serves the head of the waiting list. Reports the patient
+    // who left and the one given a bed, with that bed (-1 if the list was empty).
+    bool vacateBed(int bedNumber, int& patientId, int& nextPatient, int& nextBed) {
+        patientId = -1;
+        nextPatient = -1;
+        nextBed = -1;
+        if (!freeBed(root, bedNumber, patientId)) {
+            cout << "Bed " << bedNumber << " is not occupied." << endl;
+            return false;
+        }
+        bedOfPatient.erase(patientId);
+        cout << "Bed " << bedNumber << " released." << endl;
+        nextPatient = waitingList.pop();
+        if (nextPatient != -1) {
+            nextBed = assignBed(nextPatient, false);
+        }
+        return true;
+    }
+
+    // Replay only reads the leading values; the rest record the outcome for the change feed
+    void logMutation(MutationType type, initializer_list<int32_t> values) {
+        if (mutationLog) {
+            BinaryWriter entry;
+            for (int32_t value : values) {
+                entry.putInt(value);
+            }
+            mutationLog->append(type, entry);
+        }
+    }
+
+    const BedNode* findBed(int bedNumber) const {
+        const BedNode* node = root;
+        while (node && node->bedNumber != bedNumber) {
+            node = bedNumber < node->bedNumber ? node->left : node->right;
+        }
+        return node;
+    }
+
+public:
+    BedManagement() : root(nullptr), bedCount(0), mutationLog(nullptr) {}
+
+    ~BedManagement() {
+        destroy(root);
+    }
+
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    void addBeds(int bedNumber) {
+        int previousCount = bedCount;
+        root = addBed(root, bedNumber);
+        if (bedCount != previousCount) {
+            logMutation(MutationType::BedAdd, {bedNumber});
+        }
+    }
+
+    // Returns the allocated bed number, or -1 if the patient was put on the waiting list.
+    // Urgent patients that have to wait are queued ahead of everyone else.
+    int allocateBed(int patientId, bool urgent = false) {
+        HMS_TIME(BedAllocate);
+        int bedNumber = assignBed(patientId, urgent);
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(patientId);
+            entry.putBool(urgent);
+            entry.putInt(bedNumber);
+            mutationLog->append(MutationType::BedAllocate, entry);
+        }
+        return bedNumber;
+    }
+
+    // Returns the bed to the pool and hands it straight to the head of the waiting list
+    bool releaseBed(int bedNumber) {
+        HMS_TIME(BedRelease);
+        int patientId, nextPatient, nextBed;
+        if (!vacateBed(bedNumber, patientId, nextPatient, nextBed)) {
+            return false;
+        }
+        logMutation(MutationType::BedRelease, {bedNumber, patientId, nextPatient, nextBed});
+        return true;
+    }
+
+    // Frees the patient's bed (serving the waiting list) or drops them from the queue
+    bool dischargePatient(int patientId) {
+        HMS_TIME(BedDischarge);
+        int* bed = bedOfPatient.find(patientId);
+        int bedNumber = bed ? *bed : -1;
+        int leaving, nextPatient = -1, nextBed = -1;
+        bool changed = bed ? vacateBed(bedNumber, leaving, nextPatient, nextBed) : waitingList.cancel(patientId);
+        if (changed) {
+            logMutation(MutationType::BedDischarge, {patientId, bedNumber, nextPatient, nextBed});
+        }
+        return changed;
+    }
+
+    // Gives a specific free bed to a patient, e.g. when importing an existing ward
+    bool occupyBed(int bedNumber, int patientId) {
+        if (bedOfPatient.find(patientId) || !claimBed(root, bedNumber, patientId)) {
+            return false;
+        }
+        bedOfPatient.insert(patientId, bedNumber);
+        waitingList.cancel(patientId);
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(bedNumber);
+            entry.putInt(patientId);
+            mutationLog->append(MutationType::BedOccupy, entry);
+        }
+        return true;
+    }
+
+    // Frees a bed without handing it to the waiting list
+    bool clearBed(int bedNumber) {
+        int patientId = -1;
+        if (!freeBed(root, bedNumber, patientId)) {
+            return false;
+        }
+        bedOfPatient.erase(patientId);
+        logMutation(MutationType::BedVacate, {bedNumber, patientId});
+        return true;
+    }
+
+    // Gives free beds, lowest first, to the waiting list in queue order; returns how many were served
+    int serveWaitingList() {
+        vector<pair<int, int>> served; // (patient ID, bed number)
+        while (getFreeCount(root) > 0) {
+            int patientId = waitingList.pop();
+            if (patientId == -1) break;
+            int bedNumber = claimLowestFree(root, patientId);
+            bedOfPatient.insert(patientId, bedNumber);
+            served.emplace_back(patientId, bedNumber);
+        }
+        if (!served.empty() && mutationLog) {
+            BinaryWriter entry;
+            entry.putU32(static_cast<uint32_t>(served.size()));
+            for (const pair<int, int>& assignment : served) {
+                entry.putInt(assignment.first);
+                entry.putInt(assignment.second);
+            }
+            mutationLog->append(MutationType::BedServeWaiting, entry);
+        }
+        return static_cast<int>(served.size());
+    }
+
+    // Makes the ward match occupancy taken from a ConcurrentBedAllocator, as
+    // (bed number, patient ID or -1) pairs: beds whose occupant changed are
+    // cleared and re-occupied, then free beds go to the waiting list. Every step
+    // is logged. Returns how many beds changed; beds the ward does not have and
+    // patients already in another bed are skipped.
+    size_t applyOccupancy(const vector<pair<int, int>>& beds) {
+        size_t changed = 0;
+        for (const pair<int, int>& bed : beds) {
+            const BedNode* node = findBed(bed.first);
+            if (node && node->patientID != -1 && node->patientID != bed.second && clearBed(bed.first)) {
+                changed++;
+            }
+        }
+        for (const pair<int, int>& bed : beds) {
+            const BedNode* node = findBed(bed.first);
+            if (node && bed.second != -1 && node->patientID != bed.second && occupyBed(bed.first, bed.second)) {
+                changed++;
+            }
+        }
+        serveWaitingList();
+        return changed;
+    }
+
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<BedNode*> nodes;
+        collectBeds(root, nodes);
+        vector<SnapshotBed> beds;
+        vector<uint64_t> freeBitmap((nodes.size() + 63) / 64, 0);
+        beds.reserve(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++) {
+            beds.push_back(SnapshotBed{nodes[i]->bedNumber, nodes[i]->patientID});
+            if (nodes[i]->isAvailable) {
+                freeBitmap[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+        vector<int32_t> waiting;
+        for (int patientId : waitingList.getWaitingPatients()) {
+            waiting.push_back(patientId);
+        }
+        out.addSection(SnapshotSectionKind::Beds, beds);
+        out.addSection(SnapshotSectionKind::BedFreeBitmap, freeBitmap);
+        out.addSection(SnapshotSectionKind::WaitingList, waiting);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        destroy(root);
+        bedOfPatient.clear();
+        waitingList = WaitingQueue();
+
+        RecordSpan<SnapshotBed> beds = in.records<SnapshotBed>(SnapshotSectionKind::Beds);
+        bedOfPatient.reserve(beds.size());
+        for (const SnapshotBed& bed : beds) {
+            if (bed.patientID != -1) {
+                bedOfPatient.insert(bed.patientID, bed.bedNumber);
+            }
+        }
+        root = buildBalanced(beds.begin(), 0, static_cast<int>(beds.size()) - 1);
+        bedCount = static_cast<int>(beds.size());
+
+        for (int32_t patientId : in.records<int32_t>(SnapshotSectionKind::WaitingList)) {
+            waitingList.push(patientId);
+        }
+    }
+
+    void displayWaitingStats() const {
+        const LatencyHistogram& waits = waitingList.getWaitTimes();
+        cout << "Beds: " << getTotalBeds() << " total, " << getFreeBeds() << " free" << endl;
+        cout << "Waiting list: " << waitingList.size() << " waiting (peak " << waitingList.getPeakDepth()
+             << "), " << waitingList.getEnqueuedCount() << " queued, " << waitingList.getServedCount() << " served" << endl;
+        cout << "Wait time (us): p50 " << waits.percentile(50) << ", p90 " << waits.percentile(90)
+             << ", p99 " << waits.percentile(99) << ", max " << waits.getMax() << endl;
+    }
+
+    int getTotalBeds() const {
+        return bedCount;
+    }
+
+    int getFreeBeds() const {
+        return root ? root->freeCount : 0;
+    }
+
+    int getTreeHeight() const {
+        return root ? root->height : 0;
+    }
+
+    size_t getWaitingCount() const {
+        return waitingList.size();
+    }
+
+    const WaitingQueue& getWaitingList() const {
+        return waitingList;
+    }
+
+    // (bed number, patient ID or -1) pairs in bed order
+    vector<pair<int, int>> getOccupancy() const {
+        vector<BedNode*> nodes;
+        collectBeds(root, nodes);
+        vector<pair<int, int>> beds;
+        beds.reserve(nodes.size());
+        for (const BedNode* node : nodes) {
+            beds.emplace_back(node->bedNumber, node->patientID);
+        }
+        return beds;
+    }
+};
+
+// Lock-free bed allocator for admission surges: one bit per free bed in atomic
+// 64-bit words, claimed with compare-and-swap. Beds are kept in the tree's
+// order, so position i holds the i-th lowest bed number and a scan from word 0
+// hands out the lowest free bed. Desks can start at different words to spread
+// contention. The set of beds is fixed when the allocator is built.
+class ConcurrentBedAllocator {
+private:
+    vector<int> bedNumbers; // Sorted
+    size_t wordCount;
+    unique_ptr<atomic<uint64_t>[]> freeWords;
+    unique_ptr<atomic<int>[]> occupants; // Patient ID per position, -1 while free
+
+    int positionOf(int bedNumber) const {
+        auto it = lower_bound(bedNumbers.begin(), bedNumbers.end(), bedNumber);
+        if (it == bedNumbers.end() || *it != bedNumber) return -1;
+        return static_cast<int>(it - bedNumbers.begin());
+    }
+
+public:
+    // Beds as (bed number, patient ID or -1) pairs sorted by bed number
+    explicit ConcurrentBedAllocator(const vector<pair<int, int>>& beds)
+        : wordCount((beds.size() + 63) / 64), freeWords(new atomic<uint64_t>[max<size_t>(1, wordCount)]),
+          occupants(new atomic<int>[max<size_t>(1, beds.size())]) {
+        bedNumbers.reserve(beds.size());
+        for (size_t w = 0; w < wordCount; w++) {
+            freeWords[w].store(0, memory_order_relaxed);
+        }
+        for (size_t i = 0; i < beds.size(); i++) {
+            if (i > 0 && beds[i].first <= beds[i - 1].first) {
+                throw invalid_argument("Beds must be sorted by bed number without duplicates.");
+            }
+            bedNumbers.push_back(beds[i].first);
+            occupants[i].store(beds[i].second, memory_order_relaxed);
+            if (beds[i].second == -1) {
+                freeWords[i / 64].fetch_or(uint64_t(1) << (i % 64), memory_order_relaxed);
+            }
+        }
+    }
+
+    // Claims the first free bed at or after the start word (wrapping around);
+    // returns its number, or -1 if the ward is full
+    int allocate(int patientId, size_t startWord = 0) {
+        for (size_t i = 0; i < wordCount; i++) {
+            size_t w = (startWord + i) % wordCount;
+            uint64_t word = freeWords[w].load(memory_order_relaxed);
+            while (word) {
+                uint64_t bit = word & (~word + 1);
+                if (freeWords[w].compare_exchange_weak(word, word & ~bit, memory_order_acquire, memory_order_relaxed)) {
+                    size_t position = w * 64 + countTrailingZeros(bit);
+                    occupants[position].store(patientId, memory_order_relaxed);
+                    return bedNumbers[position];
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Frees an occupied bed; returns the patient who had it, or -1 if it was not occupied
+    int release(int bedNumber) {
+        int position = positionOf(bedNumber);
+        if (position == -1) return -1;
+        int patientId = occupants[position].exchange(-1, memory_order_relaxed);
+        if (patientId == -1) return -1;
+        freeWords[position / 64].fetch_or(uint64_t(1) << (position % 64), memory_order_release);
+        return patientId;
+    }
+
+    int getOccupant(int bedNumber) const {
+        int position = positionOf(bedNumber);
+        return position == -1 ? -1 : occupants[position].load(memory_order_relaxed);
+    }
+
+    // Counts free bits; exact only while no allocation or release is in flight
+    int getFreeBeds() const {
+        int count = 0;
+        for (size_t w = 0; w < wordCount; w++) {
+            count += countSetBits(freeWords[w].load(memory_order_relaxed));
+        }
+        return count;
+    }
+
+    int getTotalBeds() const {
+        return static_cast<int>(bedNumbers.size());
+    }
+
+    size_t getWordCount() const {
+        return wordCount;
+    }
+
+    // (bed number, patient ID or -1) pairs in bed order
+    vector<pair<int, int>> getOccupancy() const {
+        vector<pair<int, int>> beds;
+        beds.reserve(bedNumbers.size());
+        for (size_t i = 0; i < bedNumbers.size(); i++) {
+            beds.emplace_back(bedNumbers[i], occupants[i].load(memory_order_relaxed));
+        }
+        return beds;
+    }
+};
+
+// ================= Billing System =================
+struct BillingRecord {
+    int patientID;
+    double totalAmount;
+    bool isPaid;
+    Symbol paymentMethod;
+    // How a paid bill was split. Settlement applies the payment method rules;
+    // a bill paid on its own is paid in full by the patient.
+    double paidByPatient;
+    double claimedFromInsurer;
+    double discount;
+
+    BillingRecord(int id, double amount, const string& payment = "")
+        : patientID(id), totalAmount(amount), isPaid(false), paymentMethod(payment), paidByPatient(0), claimedFromInsurer(0),
+          discount(0) {}
+
+    void payInFull() {
+        isPaid = true;
+        paidByPatient = totalAmount;
+        claimedFromInsurer = 0;
+        discount = 0;
+    }
+
+    void displayBill(OutputBuffer& out) const {
+        out << "Patient ID: " << patientID << ", Total Amount: " << totalAmount
+            << ", Paid: " << (isPaid ? "Yes" : "No")
+            << ", Payment Method: " << (isPaid ? paymentMethod.str() : "Not paid yet");
+        if (isPaid && (claimedFromInsurer != 0 || discount != 0)) {
+            out << ", Paid by Patient: " << paidByPatient << ", Claimed from Insurer: " << claimedFromInsurer
+                << ", Discount: " << discount;
+        }
+        out << '\n';
+    }
+
+    void displayBill() const {
+        OutputBuffer out;
+        displayBill(out);
+    }
+};
+
+// Payment method rules for month-end settlement: insurers cover a share of
+// insured bills, cash payers get a discount, card bills are paid in full
+struct SettlementRules {
+    double insuranceCoverage = 0.8;
+    double cashDiscount = 0.0; // No cash discount unless one is given, so cash bills are paid in full by default
+};
+
+struct SettlementTotals {
+    uint64_t bills = 0;
+    double billed = 0;
+    double paidByPatients = 0;
+    double claimedFromInsurers = 0;
+    double discounts = 0;
+
+    void add(const SettlementTotals& other) {
+        bills += other.bills;
+        billed += other.billed;
+        paidByPatients += other.paidByPatients;
+        claimedFromInsurers += other.claimedFromInsurers;
+        discounts += other.discounts;
+    }
+};
+
+struct SettlementSummary {
+    SettlementTotals total;
+    vector<pair<Symbol, SettlementTotals>> byMethod; // Sorted by method name
+    size_t partitions = 0;
+    size_t threads = 0;
+    double seconds = 0;
+};
+
+class BillingSystem {
+private:
+    vector<BillingRecord> maxHeap;
+    vector<BillingRecord> paidBills;
+    vector<BillingRecord> records;
+    IdIndex<int> heapPosition; // Patient ID -> index of its pending bill in maxHeap
+    MutationLog* mutationLog = nullptr;
+
+    // Carries the split so the change feed and replay see how the bill was paid
+    void logPaid(const BillingRecord& record) {
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(record.patientID);
+            entry.putDouble(record.totalAmount);
+            entry.putDouble(record.paidByPatient);
+            entry.putDouble(record.claimedFromInsurer);
+            entry.putDouble(record.discount);
+            mutationLog->append(MutationType::BillPaid, entry);
+        }
+    }
+
+    static SnapshotBill toSnapshot(SnapshotBuilder& out, const BillingRecord& record) {
+        return SnapshotBill{record.patientID, record.isPaid ? 1u : 0u, record.totalAmount, out.addString(record.paymentMethod),
+                            record.paidByPatient, record.claimedFromInsurer, record.discount};
+    }
+
+    static BillingRecord fromSnapshot(const SnapshotView& in, const SnapshotBill& bill) {
+        BillingRecord record(bill.patientID, bill.totalAmount, in.text(bill.paymentMethod));
+        record.isPaid = bill.isPaid != 0;
+        record.paidByPatient = bill.paidByPatient;
+        record.claimedFromInsurer = bill.claimedFromInsurer;
+        record.discount = bill.discount;
+        return record;
+    }
+
+    void swapNodes(int a, int b) {
+        swap(maxHeap[a], maxHeap[b]);
+        *heapPosition.find(maxHeap[a].patientID) = a;
+        *heapPosition.find(maxHeap[b].patientID) = b;
+    }
+
+    void heapifyUp(int index) {
+        while (index > 0) {
+            int parent = (index - 1) / 2;
+            if (maxHeap[parent].totalAmount >= maxHeap[index].totalAmount) {
+                break;
+            }
+            swapNodes(parent, index);
+            index = parent;
+        }
+    }
+
+    void heapifyDown(int index) {
+        int size = maxHeap.size();
+        while (index < size) {
+            int leftChild = 2 * index + 1;
+            int rightChild = 2 * index + 2;
+            int largest = index;
+
+            if (leftChild < size && maxHeap[leftChild].totalAmount > maxHeap[largest].totalAmount) {
+                largest = leftChild;
+            }
+
+            if (rightChild < size && maxHeap[rightChild].totalAmount > maxHeap[largest].totalAmount) {
+                largest = rightChild;
+            }
+
+            if (largest == index) {
+                break;
+            }
+
+            swapNodes(index, largest);
+            index = largest;
+        }
+    }
+
+    // Settlement splits the pending bills into a fixed number of partitions by
+    // patient ID, so totals and the order of paid bills do not depend on the
+    // number of threads
+    static const size_t settlementPartitions = 64;
+
+    static size_t partitionOf(int patientID) {
+        return (static_cast<uint32_t>(patientID) * 2654435761u) >> 26;
+    }
+
+    static void settleBill(BillingRecord& record, const SettlementRules& rules, unordered_map<uint32_t, SettlementTotals>& byMethod) {
+        static const Symbol insurance("Insurance"), cash("Cash");
+        record.payInFull();
+        double amount = record.totalAmount;
+        if (record.paymentMethod == insurance) {
+            record.claimedFromInsurer = amount * rules.insuranceCoverage;
+            record.paidByPatient = amount - record.claimedFromInsurer;
+        } else if (record.paymentMethod == cash) {
+            record.discount = amount * rules.cashDiscount;
+            record.paidByPatient = amount - record.discount;
+        }
+        SettlementTotals& totals = byMethod[record.paymentMethod.id];
+        totals.bills++;
+        totals.billed += amount;
+        totals.paidByPatients += record.paidByPatient;
+        totals.claimedFromInsurers += record.claimedFromInsurer;
+        totals.discounts += record.discount;
+    }
+
+    // Removes the pending bill at a heap position and restores the heap order: O(log n)
+    BillingRecord removeAt(int index) {
+        BillingRecord record = maxHeap[index];
+        heapPosition.erase(record.patientID);
+
+        int last = maxHeap.size() - 1;
+        if (index != last) {
+            maxHeap[index] = maxHeap[last];
+            *heapPosition.find(maxHeap[index].patientID) = index;
+        }
+        maxHeap.pop_back();
+        if (index < static_cast<int>(maxHeap.size())) {
+            int movedID = maxHeap[index].patientID;
+            heapifyUp(index);
+            heapifyDown(*heapPosition.find(movedID));
+        }
+        return record;
+    }
+
+public:
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    // Pre-sizes the pending heap and its index for a bulk load
+    void reserve(size_t count) {
+        maxHeap.reserve(count);
+        heapPosition.reserve(count);
+    }
+
+    void addBillingRecord(int patientID, double totalAmount, const string& paymentMethod) {
+        if (mergeBill(patientID, totalAmount, paymentMethod)) {
+            cout << "Billing record updated for Patient ID " << patientID << endl;
+        }
+    }
+
+    // Adds the amount to the patient's pending bill, opening one if needed; true if one already existed
+    bool mergeBill(int patientID, double totalAmount, const string& paymentMethod) {
+        HMS_TIME(BillAdd);
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(patientID);
+            entry.putDouble(totalAmount);
+            entry.putString(paymentMethod);
+            mutationLog->append(MutationType::BillAdd, entry);
+        }
+
+        // An existing pending bill for the patient grows in place and is re-positioned
+        if (int* position = heapPosition.find(patientID)) {
+            int index = *position;
+            maxHeap[index].totalAmount += totalAmount;
+            maxHeap[index].paymentMethod = paymentMethod;
+            heapifyUp(index);
+            heapifyDown(*heapPosition.find(patientID));
+            return true;
+        }
+        // If no existing record, create a new one
+        maxHeap.emplace_back(patientID, totalAmount, paymentMethod);
+        heapPosition.insert(patientID, maxHeap.size() - 1);
+        heapifyUp(maxHeap.size() - 1);
+        return false;
+    }
+    
+    void markAsPaid() {
+        HMS_TIME(BillPay);
+        if (maxHeap.empty()) {
+            throw runtime_error("No bills to mark as paid.");
+        }
+
+        BillingRecord record = removeAt(0);
+        record.payInFull();
+        paidBills.push_back(record);
+        logPaid(record);
+
+        cout << "Bill for Patient ID " << record.patientID << " has been marked as paid." << endl;
+    }
+
+    void markBillAsPaidByID(int patientID) {
+        if (payBill(patientID)) {
+            cout << "Bill for Patient ID " << patientID << " has been marked as paid." << endl;
+        } else {
+            cout << "No pending bill found for Patient ID " << patientID << "." << endl;
+        }
+    }
+
+    // Moves the patient's pending bill to the paid bills, paid in full; false if there is none
+    bool payBill(int patientID) {
+        HMS_TIME(BillPay);
+        int* position = heapPosition.find(patientID);
+        if (!position) {
+            return false;
+        }
+        BillingRecord record = removeAt(*position);
+        record.payInFull();
+        paidBills.push_back(record);
+        logPaid(record);
+        return true;
+    }
+
+    // Pays the pending bill with a logged split, as recorded by settleAll
+    bool payBill(int patientID, double paidByPatient, double claimedFromInsurer, double discount) {
+        HMS_TIME(BillPay);
+        int* position = heapPosition.find(patientID);
+        if (!position) {
+            return false;
+        }
+        BillingRecord record = removeAt(*position);
+        record.isPaid = true;
+        record.paidByPatient = paidByPatient;
+        record.claimedFromInsurer = claimedFromInsurer;
+        record.discount = discount;
+        paidBills.push_back(record);
+        logPaid(record);
+        return true;
+    }
+
+    // Month-end run: settles every pending bill and moves it to the paid bills.
+    // Bills are scattered into partitions by patient ID, each partition is sorted
+    // and settled on the pool with its own totals, and the partitions are merged
+    // in order. Without a pool the same steps run on the calling thread. Each
+    // settled bill is logged as paid with its split, in the order it was settled.
+    SettlementSummary settleAll(const SettlementRules& rules, WorkerPool* pool = nullptr) {
+        HMS_TIME(BillSettle);
+        if (rules.insuranceCoverage < 0 || rules.insuranceCoverage > 1 || rules.cashDiscount < 0 || rules.cashDiscount > 1) {
+            throw invalid_argument("Coverage and discount must be between 0 and 1.");
+        }
+        auto start = chrono::steady_clock::now();
+        size_t threads = pool ? pool->getThreadCount() : 1;
+        vector<vector<BillingRecord>> partitions(settlementPartitions);
+        vector<unordered_map<uint32_t, SettlementTotals>> partitionTotals(settlementPartitions);
+
+        // Scatter: each thread splits a contiguous slice of the heap into its own buckets
+        vector<vector<vector<BillingRecord>>> buckets(threads, vector<vector<BillingRecord>>(settlementPartitions));
+        auto scatter = [&](size_t t) {
+            size_t begin = maxHeap.size() * t / threads, end = maxHeap.size() * (t + 1) / threads;
+            for (size_t i = begin; i < end; i++) {
+                buckets[t][partitionOf(maxHeap[i].patientID)].push_back(maxHeap[i]);
+            }
+        };
+        auto settlePartition = [&](size_t p) {
+            vector<BillingRecord>& bills = partitions[p];
+            for (size_t t = 0; t < threads; t++) {
+                bills.insert(bills.end(), buckets[t][p].begin(), buckets[t][p].end());
+                vector<BillingRecord>().swap(buckets[t][p]);
+            }
+            sort(bills.begin(), bills.end(), [](const BillingRecord& a, const BillingRecord& b) { return a.patientID < b.patientID; });
+            for (BillingRecord& record : bills) {
+                settleBill(record, rules, partitionTotals[p]);
+            }
+        };
+        if (pool) {
+            for (size_t t = 0; t < threads; t++) pool->submit([&, t] { scatter(t); });
+            pool->wait();
+            for (size_t p = 0; p < settlementPartitions; p++) pool->submit([&, p] { settlePartition(p); });
+            pool->wait();
+        } else {
+            scatter(0);
+            for (size_t p = 0; p < settlementPartitions; p++) settlePartition(p);
+        }
+
+        SettlementSummary summary;
+        unordered_map<uint32_t, SettlementTotals> byMethod;
+        paidBills.reserve(paidBills.size() + maxHeap.size());
+        size_t firstSettled = paidBills.size();
+        for (size_t p = 0; p < settlementPartitions; p++) {
+            paidBills.insert(paidBills.end(), partitions[p].begin(), partitions[p].end());
+            for (const auto& entry : partitionTotals[p]) {
+                byMethod[entry.first].add(entry.second);
+            }
+        }
+        for (const auto& entry : byMethod) {
+            Symbol method;
+            method.id = entry.first;
+            summary.byMethod.emplace_back(method, entry.second);
+        }
+        sort(summary.byMethod.begin(), summary.byMethod.end(),
+             [](const pair<Symbol, SettlementTotals>& a, const pair<Symbol, SettlementTotals>& b) { return a.first.str() < b.first.str(); });
+        for (const auto& entry : summary.byMethod) {
+            summary.total.add(entry.second);
+        }
+        maxHeap.clear();
+        heapPosition.clear();
+
+        for (size_t i = firstSettled; i < paidBills.size(); i++) {
+            logPaid(paidBills[i]);
+        }
+        summary.partitions = settlementPartitions;
+        summary.threads = threads;
+        summary.seconds = elapsedSeconds(start);
+        return summary;
+    }
+
+    static void displaySettlement(const SettlementSummary& summary) {
+        cout << "Settled " << summary.total.bills << " bills in " << summary.seconds * 1000 << " ms ("
+             << summary.partitions << " partitions, " << summary.threads << (summary.threads == 1 ? " thread)" : " threads)") << endl;
+        for (const auto& entry : summary.byMethod) {
+            const SettlementTotals& totals = entry.second;
+            cout << (entry.first.empty() ? string("(none)") : entry.first.str()) << ": " << totals.bills << " bills, billed " << totals.billed
+                 << ", paid by patients " << totals.paidByPatients << ", claimed from insurers " << totals.claimedFromInsurers
+                 << ", discounts " << totals.discounts << endl;
+        }
+        cout << "Total: billed " << summary.total.billed << ", paid by patients " << summary.total.paidByPatients
+             << ", claimed from insurers " << summary.total.claimedFromInsurers << ", discounts " << summary.total.discounts << endl;
+    }
+
+    const BillingRecord* findPendingBill(int patientID) const {
+        const int* position = heapPosition.find(patientID);
+        return position ? &maxHeap[*position] : nullptr;
+    }
+
+    size_t getPendingCount() const {
+        return maxHeap.size();
+    }
+
+    size_t getPaidCount() const {
+        return paidBills.size();
+    }
+
+    const vector<BillingRecord>& getPaidBills() const {
+        return paidBills;
+    }
+
+    // The heap array is stored as-is, so it is already in heap order when loaded
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<SnapshotBill> pending, paid;
+        vector<int32_t> ids;
+        pending.reserve(maxHeap.size());
+        ids.reserve(maxHeap.size());
+        for (const BillingRecord& record : maxHeap) {
+            pending.push_back(toSnapshot(out, record));
+            ids.push_back(record.patientID);
+        }
+        paid.reserve(paidBills.size());
+        for (const BillingRecord& record : paidBills) {
+            paid.push_back(toSnapshot(out, record));
+        }
+        out.addSection(SnapshotSectionKind::PendingBills, pending);
+        out.addIndexSection(SnapshotSectionKind::PendingBillIndex, ids);
+        out.addSection(SnapshotSectionKind::PaidBills, paid);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        maxHeap.clear();
+        paidBills.clear();
+        heapPosition.clear();
+
+        RecordSpan<SnapshotBill> pending = in.records<SnapshotBill>(SnapshotSectionKind::PendingBills);
+        maxHeap.reserve(pending.size());
+        heapPosition.reserve(pending.size());
+        for (const SnapshotBill& bill : pending) {
+            maxHeap.push_back(fromSnapshot(in, bill));
+            heapPosition.insert(bill.patientID, static_cast<int>(maxHeap.size() - 1));
+        }
+        RecordSpan<SnapshotBill> paid = in.records<SnapshotBill>(SnapshotSectionKind::PaidBills);
+        paidBills.reserve(paid.size());
+        for (const SnapshotBill& bill : paid) {
+            paidBills.push_back(fromSnapshot(in, bill));
+        }
+    }
+
+    void displayAllBills() const {
+        OutputBuffer out;
+        if (maxHeap.empty()) {
+            out << "No pending bills.\n";
+        } else {
+            out << "Pending Bills:\n";
+            for (const auto& record : maxHeap) {
+                record.displayBill(out);
+            }
+        }
+
+        if (paidBills.empty()) {
+            out << "No paid bills.\n";
+        } else {
+            out << "Paid Bills:\n";
+            for (const auto& record : paidBills) {
+                record.displayBill(out);
+            }
+        }
+    }
+
+    void searchBillByID(int patientID) const {
+        OutputBuffer out;
+        bool found = false;
+        if (const BillingRecord* pending = findPendingBill(patientID)) {
+            pending->displayBill(out);
+            found = true;
+        }
+        for (const auto& record : paidBills) {
+            if (record.patientID == patientID) {
+                record.displayBill(out);
+                found = true;
+            }
+        }
+        if (!found) {
+            out << "No bill found for Patient ID " << patientID << ".\n";
+        }
+    }
+};
+
+string getValidatedPaymentMethod();
+
+// ================= Medical Records =================
+struct MedicalRecord {
+    int patientID;
+    string name;
+    int age;
+    string medicalHistory;
+    string prescriptions;
+    string doctorNotes;
+    MedicalRecord* next;
+    MedicalRecord* prev = nullptr;
+    MedicalRecord* nextForPatient = nullptr; // Next (newer) record of the same patient
+    uint32_t documentID = 0;                 // Position in the full-text index
+};
+
+// Encounter history of one patient, oldest first
+struct PatientRecords {
+    MedicalRecord* first = nullptr;
+    MedicalRecord* last = nullptr;
+    size_t count = 0;
+};
+
+// Document IDs of one term in ascending order, stored as varint-encoded gaps
+struct PostingList {
+    vector<uint8_t> bytes;
+    uint32_t lastDocument = 0;
+    uint32_t count = 0;
+
+    void append(uint32_t document) {
+        uint32_t gap = count ? document - lastDocument : document;
+        while (gap >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(gap));
+        lastDocument = document;
+        count++;
+    }
+
+    void decode(vector<uint32_t>& out) const {
+        out.reserve(out.size() + count);
+        uint32_t document = 0;
+        size_t i = 0;
+        while (i < bytes.size()) {
+            uint32_t gap = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = bytes[i++];
+                gap |= uint32_t(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            document += gap;
+            out.push_back(document);
+        }
+    }
+};
+
+// Inverted index from lower-cased words to the documents containing them.
+// Documents must be added with increasing IDs; removal is left to the caller,
+// which filters out dead IDs and rebuilds the index when enough pile up.
+class TextIndex {
+private:
+    unordered_map<string, PostingList> postings;
+    set<string> dictionary; // Sorted terms for prefix queries
+    size_t postingBytes = 0;
+
+    static vector<uint32_t> intersect(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(result));
+        return result;
+    }
+
+    static vector<uint32_t> unite(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result;
+        set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(result));
+        return result;
+    }
+
+    vector<uint32_t> lookupTerm(const string& term) const {
+        vector<uint32_t> documents;
+        auto it = postings.find(term);
+        if (it != postings.end()) it->second.decode(documents);
+        return documents;
+    }
+
+    vector<uint32_t> lookupPrefix(const string& prefix) const {
+        vector<uint32_t> documents;
+        for (auto it = dictionary.lower_bound(prefix); it != dictionary.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+            vector<uint32_t> matches;
+            postings.at(*it).decode(matches);
+            documents = documents.empty() ? matches : unite(documents, matches);
+        }
+        return documents;
+    }
+
+    // Documents for one query word; "warf*" matches every term starting with "warf".
+    // The word is tokenized like the indexed text, so "Warf*" and "dr.*" match too;
+    // with several tokens all must match and only the last is a prefix.
+    vector<uint32_t> lookupWord(const string& word) const {
+        bool prefixMatch = word.size() > 1 && word.back() == '*';
+        vector<string> tokens;
+        tokenize(prefixMatch ? word.substr(0, word.size() - 1) : word, tokens);
+        vector<uint32_t> documents;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            vector<uint32_t> matches = prefixMatch && i + 1 == tokens.size() ? lookupPrefix(tokens[i]) : lookupTerm(tokens[i]);
+            documents = i == 0 ? matches : intersect(documents, matches);
+            if (documents.empty()) break;
+        }
+        return documents;
+    }
+
+public:
+    // Appends the lower-cased runs of letters and digits in text to tokens
+    static void tokenize(const string& text, vector<string>& tokens) {
+        string token;
+        for (char c : text) {
+            if (isalnum(static_cast<unsigned char>(c))) {
+                token.push_back(static_cast<char>(tolower(static_cast<unsigned char>(c))));
+            } else if (!token.empty()) {
+                tokens.push_back(token);
+                token.clear();
+            }
+        }
+        if (!token.empty()) tokens.push_back(token);
+    }
+
+    // terms may contain duplicates; each distinct term is posted once
+    void addDocument(uint32_t document, vector<string>& terms) {
+        sort(terms.begin(), terms.end());
+        terms.erase(unique(terms.begin(), terms.end()), terms.end());
+        for (const string& term : terms) {
+            auto it = postings.find(term);
+            if (it == postings.end()) {
+                it = postings.emplace(term, PostingList()).first;
+                dictionary.insert(term);
+            }
+            size_t before = it->second.bytes.size();
+            it->second.append(document);
+            postingBytes += it->second.bytes.size() - before;
+        }
+    }
+
+    // Query words are ANDed; OR separates alternatives ("warfarin OR heparin"),
+    // and a trailing * makes a word a prefix match. Returns sorted document IDs.
+    vector<uint32_t> search(const string& query) const {
+        vector<uint32_t> result, clause;
+        bool clauseStarted = false;
+        istringstream words(query);
+        string word;
+        auto closeClause = [&]() {
+            if (clauseStarted) result = unite(result, clause);
+            clause.clear();
+            clauseStarted = false;
+        };
+        while (words >> word) {
+            if (word == "OR") {
+                closeClause();
+                continue;
+            }
+            if (word == "AND") continue;
+            vector<uint32_t> matches = lookupWord(word);
+            clause = clauseStarted ? intersect(clause, matches) : matches;
+            clauseStarted = true;
+        }
+        closeClause();
+        return result;
+    }
+
+    void clear() {
+        postings.clear();
+        dictionary.clear();
+        postingBytes = 0;
+    }
+
+    size_t getTermCount() const {
+        return postings.size();
+    }
+
+    size_t getPostingBytes() const {
+        return postingBytes;
+    }
+};
+
+class MedicalSystem {
+private:
+    vector<MedicalRecord> records;
+    MutationLog* mutationLog = nullptr;
+    NodePool<MedicalRecord> nodes;
+    MedicalRecord* tail = nullptr;
+    IdIndex<PatientRecords> byPatient; // Patient ID -> that patient's records
+
+    // Full-text index over history, prescriptions and notes. Updated records are
+    // re-indexed under a new document ID; dead IDs map to nullptr until compaction.
+    TextIndex textIndex;
+    vector<MedicalRecord*> documents;
+    size_t deadDocuments = 0;
+    vector<string> termBuffer;
+
+    void indexRecord(MedicalRecord* record) {
+        record->documentID = static_cast<uint32_t>(documents.size());
+        documents.push_back(record);
+        termBuffer.clear();
+        TextIndex::tokenize(record->medicalHistory, termBuffer);
+        TextIndex::tokenize(record->prescriptions, termBuffer);
+        TextIndex::tokenize(record->doctorNotes, termBuffer);
+        textIndex.addDocument(record->documentID, termBuffer);
+    }
+
+    void unindexRecord(MedicalRecord* record) {
+        documents[record->documentID] = nullptr;
+        deadDocuments++;
+    }
+
+    // Rebuilds the index from the live records once most document IDs are dead
+    void compactTextIndex() {
+        if (deadDocuments <= 1024 || deadDocuments <= documents.size() / 2) return;
+        textIndex.clear();
+        documents.clear();
+        deadDocuments = 0;
+        for (MedicalRecord* record = head; record != nullptr; record = record->next) {
+            indexRecord(record);
+        }
+    }
+
+    // Links a record at the end of the list and of its patient's history
+    MedicalRecord* appendRecord(int patientID, const string& name, int age, const string& medicalHistory,
+                                const string& prescriptions, const string& doctorNotes) {
+        MedicalRecord* record = nodes.create(patientID, name, age, medicalHistory, prescriptions, doctorNotes, nullptr, tail);
+        if (tail) {
+            tail->next = record;
+        } else {
+            head = record;
+        }
+        tail = record;
+
+        PatientRecords* history = byPatient.find(patientID);
+        if (history) {
+            history->last->nextForPatient = record;
+            history->last = record;
+            history->count++;
+        } else {
+            byPatient.insert(patientID, PatientRecords{record, record, 1});
+        }
+        indexRecord(record);
+        return record;
+    }
+
+    int readPatientID(const string& prompt, const string& errorMessage) {
+        int id;
+        while (true) {
+            cout << prompt;
+            cin >> id;
+            if (cin.fail()) {
+                cin.clear();  // Clear error flag
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
+                cout << errorMessage;
+                continue;  // Retry the input
+            }
+            cin.ignore();  // Consume the leftover newline character
+            return id;
+        }
+    }
+
+public:
+    MedicalRecord* head = nullptr;
+    // Function to add a medical record
+    void addRecord() {
+        int patientID = readPatientID("Enter Patient ID: ", "Invalid input. Please enter a numeric Patient ID.\n");
+
+        string name;
+        cout << "Enter Name: ";
+        getline(cin, name);
+
+        int age;
+        while(true){
+            cout << "Enter Age: ";
+            cin >> age;
+            if (cin.fail()) {
+                    cin.clear();  // Clear error flag
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard invalid input
+                    cout << "Invalid input. Please enter a valid age.\n";
+                    continue;  // Retry the input
+                }
+                cin.ignore();  // Consume the leftover newline character
+                break;
+            }
+
+        string medicalHistory, prescriptions, doctorNotes;
+        cout << "Enter Medical History: ";
+        getline(cin, medicalHistory);
+
+        cout << "Enter Prescriptions: ";
+        getline(cin, prescriptions);
+
+        cout << "Enter Doctor Notes: ";
+        getline(cin, doctorNotes);
+
+        addRecord(patientID, name, age, medicalHistory, prescriptions, doctorNotes);
+        cout << "Record added successfully!\n";
+    }
+
+    // Adds a fully specified record without prompting
+    void addRecord(int patientID, const string& name, int age, const string& medicalHistory,
+                   const string& prescriptions, const string& doctorNotes) {
+        HMS_TIME(RecordAdd);
+        appendRecord(patientID, name, age, medicalHistory, prescriptions, doctorNotes);
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(patientID);
+            entry.putString(name);
+            entry.putInt(age);
+            entry.putString(medicalHistory);
+            entry.putString(prescriptions);
+            entry.putString(doctorNotes);
+            mutationLog->append(MutationType::RecordAdd, entry);
+        }
+    }
+
+    // Sizes the patient index ahead of a bulk load
+    void reserve(size_t patientCount) {
+        byPatient.reserve(patientCount);
+    }
+
+    // Oldest record of the patient, the one update and delete act on
+    MedicalRecord* findRecord(int id) {
+        HMS_TIME(RecordFind);
+        PatientRecords* history = byPatient.find(id);
+        return history ? history->first : nullptr;
+    }
+
+    // Newest record of the patient
+    const MedicalRecord* findLatestRecord(int id) const {
+        const PatientRecords* history = byPatient.find(id);
+        return history ? history->last : nullptr;
+    }
+
+    size_t getRecordCount(int id) {
+        PatientRecords* history = byPatient.find(id);
+        return history ? history->count : 0;
+    }
+
+    // Records whose history, prescriptions or notes match the query (see TextIndex::search),
+    // in the order they were added or last updated
+    vector<const MedicalRecord*> searchText(const string& query) const {
+        HMS_TIME(RecordSearch);
+        vector<const MedicalRecord*> matches;
+        for (uint32_t document : textIndex.search(query)) {
+            if (documents[document]) matches.push_back(documents[document]);
+        }
+        return matches;
+    }
+
+    // Case-insensitive substring scan over every record; kept as the baseline for benchmarks.
+    // Same query syntax, but words match anywhere inside the text rather than whole words.
+    vector<const MedicalRecord*> scanText(const string& query) const {
+        HMS_TIME(RecordScan);
+        vector<vector<string>> clauses(1);
+        istringstream words(query);
+        string word;
+        while (words >> word) {
+            if (word == "OR") {
+                clauses.emplace_back();
+            } else if (word != "AND") {
+                if (word.size() > 1 && word.back() == '*') word.pop_back();
+                transform(word.begin(), word.end(), word.begin(), [](unsigned char c) { return tolower(c); });
+                clauses.back().push_back(word);
+            }
+        }
+        auto contains = [](const string& text, const string& word) {
+            return search(text.begin(), text.end(), word.begin(), word.end(),
+                          [](char a, char b) { return tolower(static_cast<unsigned char>(a)) == b; }) != text.end();
+        };
+        vector<const MedicalRecord*> matches;
+        for (const MedicalRecord* record = head; record != nullptr; record = record->next) {
+            for (const vector<string>& clause : clauses) {
+                if (clause.empty()) continue;
+                bool all = true;
+                for (const string& term : clause) {
+                    if (!contains(record->medicalHistory, term) && !contains(record->prescriptions, term) &&
+                        !contains(record->doctorNotes, term)) {
+                        all = false;
+                        break;
+                    }
+                }
+                if (all) {
+                    matches.push_back(record);
+                    break;
+                }
+            }
+        }
+        HMS_COUNT(RecordsScanned, getTotalRecords());
+        return matches;
+    }
+
+    size_t getTotalRecords() const {
+        return nodes.size();
+    }
+
+    const TextIndex& getTextIndex() const {
+        return textIndex;
+    }
+
+    void displaySearchResults(const string& query) const {
+        vector<const MedicalRecord*> matches = searchText(query);
+        OutputBuffer out;
+        for (const MedicalRecord* temp : matches) {
+            out << "Patient ID: " << temp->patientID << ", Name: " << temp->name
+                << ", Medical History: " << temp->medicalHistory
+                << ", Prescriptions: " << temp->prescriptions
+                << ", Doctor Notes: " << temp->doctorNotes << '\n';
+        }
+        out << matches.size() << " records found.\n";
+    }
+
+    void searchRecord() {
+        searchRecord(readPatientID("Enter Patient ID to search: ", "Invalid input. Please enter a Patient id with valid integers.\n"));
+    }
+
+    // Shows the patient's whole encounter history, oldest first
+    void searchRecord(int id) {
+        PatientRecords* history = byPatient.find(id);
+        if (history == nullptr) {
+            cout << "Record not found.\n";
+            return;
+        }
+        OutputBuffer out;
+        if (history->count == 1) {
+            out << "\nRecord Found:\n";
+        } else {
+            out << "\n" << history->count << " Records Found:\n";
+        }
+        for (MedicalRecord* temp = history->first; temp != nullptr; temp = temp->nextForPatient) {
+            out << "Name: " << temp->name << "\nAge: " << temp->age << "\nMedical History: "
+                << temp->medicalHistory << "\nPrescriptions: " << temp->prescriptions
+                << "\nDoctor Notes: " << temp->doctorNotes << '\n';
+            if (temp->nextForPatient) out << "-------------------------\n";
+        }
+    }
+    
+    // Function to update a medical record by Patient ID
+    void updateRecord() {
+        int id = readPatientID("Enter Patient ID to update: ", "Invalid input. Please enter a Patient id with valid integers.\n");
+
+        if (findRecord(id) == nullptr) {
+            cout << "Record not found.\n";
+            return;
+        }
+
+        string prescriptions, doctorNotes;
+        cout << "Enter New Prescriptions: ";
+        getline(cin, prescriptions);
+
+        cout << "Enter New Doctor Notes: ";
+        getline(cin, doctorNotes);
+
+        updateRecord(id, prescriptions, doctorNotes);
+    }
+
+    void updateRecord(int id, const string& prescriptions, const string& doctorNotes) {
+        HMS_TIME(RecordUpdate);
+        MedicalRecord* temp = findRecord(id);
+        if (temp == nullptr) {
+            cout << "Record not found.\n";
+            return;
+        }
+        unindexRecord(temp);
+        temp->prescriptions = prescriptions;
+        temp->doctorNotes = doctorNotes;
+        indexRecord(temp);
+        compactTextIndex();
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(id);
+            entry.putString(prescriptions);
+            entry.putString(doctorNotes);
+            mutationLog->append(MutationType::RecordUpdate, entry);
+        }
+        cout << "Record updated successfully!\n";
+    }
+    
+    void deleteRecord() {
+        deleteRecord(readPatientID("Enter Patient ID to delete: ", "Invalid input. Please enter a Patient id with valid integers.\n"));
+    }
+
+    // Removes the patient's oldest record
+    void deleteRecord(int id) {
+        HMS_TIME(RecordDelete);
+        PatientRecords* history = byPatient.find(id);
+        if (history == nullptr) {
+            cout << "Record not found.\n";
+            return;
+        }
+
+        MedicalRecord* temp = history->first;
+        unindexRecord(temp);
+        history->first = temp->nextForPatient;
+        history->count--;
+        if (history->first == nullptr) {
+            byPatient.erase(id);
+        }
+
+        if (temp->prev == nullptr) { // Deleting the head node
+            head = temp->next;
+        } else {
+            temp->prev->next = temp->next;
+        }
+        if (temp->next == nullptr) {
+            tail = temp->prev;
+        } else {
+            temp->next->prev = temp->prev;
+        }
+        nodes.destroy(temp);
+        compactTextIndex();
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(id);
+            mutationLog->append(MutationType::RecordDelete, entry);
+        }
+        cout << "Record deleted successfully!\n";
+    }
+
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<SnapshotMedicalRecord> snapshot;
+        for (MedicalRecord* temp = head; temp != nullptr; temp = temp->next) {
+            snapshot.push_back(SnapshotMedicalRecord{temp->patientID, temp->age, out.addString(temp->name), out.addString(temp->medicalHistory),
+                                                     out.addString(temp->prescriptions), out.addString(temp->doctorNotes)});
+        }
+        out.addSection(SnapshotSectionKind::MedicalRecords, snapshot);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        clear();
+        for (const SnapshotMedicalRecord& saved : in.records<SnapshotMedicalRecord>(SnapshotSectionKind::MedicalRecords)) {
+            appendRecord(saved.patientID, in.text(saved.name), saved.age, in.text(saved.medicalHistory),
+                         in.text(saved.prescriptions), in.text(saved.doctorNotes));
+        }
+    }
+
+    void clear() {
+        while (head != nullptr) {
+            MedicalRecord* temp = head;
+            head = head->next;
+            nodes.destroy(temp);
+        }
+        tail = nullptr;
+        byPatient.clear();
+        textIndex.clear();
+        documents.clear();
+        deadDocuments = 0;
+    }
+
+    ~MedicalSystem() {
+        clear();
+    }
+
+    void displayRecords() {
+        if (head == nullptr) {
+            cout << "No records to display.\n";
+            return;
+        }
+    
+        OutputBuffer out;
+        MedicalRecord* temp = head;
+        while (temp != nullptr) {
+            out << "\nPatient ID: " << temp->patientID
+                << "\nName: " << temp->name
+                << "\nAge: " << temp->age
+                << "\nMedical History: " << temp->medicalHistory
+                << "\nPrescriptions: " << temp->prescriptions
+                << "\nDoctor Notes: " << temp->doctorNotes
+                << "\n-------------------------\n";
+            temp = temp->next;
+        }
+    }
+};
+
+// ================= Staff Management =================
+struct Staff {
+    int id;
+    string name;
+    Symbol role;
+    Symbol department;
+    Symbol shift;
+    Staff* next; // Pointer for chaining
+    int slot;    // Dense position used by the secondary indexes
+};
+
+// Set of dense slot numbers stored as a bitmap
+class SlotSet {
+private:
+    vector<uint64_t> words;
+    size_t count = 0;
+
+public:
+    void insert(size_t slot) {
+        if (slot / 64 >= words.size()) words.resize(slot / 64 + 1, 0);
+        uint64_t bit = uint64_t(1) << (slot % 64);
+        if (!(words[slot / 64] & bit)) {
+            words[slot / 64] |= bit;
+            count++;
+        }
+    }
+
+    void erase(size_t slot) {
+        uint64_t bit = uint64_t(1) << (slot % 64);
+        if (slot / 64 < words.size() && (words[slot / 64] & bit)) {
+            words[slot / 64] &= ~bit;
+            count--;
+        }
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    const vector<uint64_t>& getWords() const {
+        return words;
+    }
+};
+
+class StaffManagement {
+private:
+    vector<Staff> staffList;
+     vector<Staff*> table;
+    NodePool<Staff> nodes;
+    int numEntries; // Number of elements in the table
+    const double loadFactorThreshold = 0.75; // Resize when load factor exceeds this threshold
+    
+    // Hash function for staff ID
+    int hashFunction(int id) const {
+        return id % table.size();
+    }
+
+    static void writeStaff(OutputBuffer& out, const Staff& staff) {
+        out << "ID: " << staff.id
+            << ", Name: " << staff.name
+            << ", Role: " << staff.role
+            << ", Department: " << staff.department
+            << ", Shift: " << staff.shift << '\n';
+    }
+
+    MutationLog* mutationLog = nullptr;
+
+    const Staff* findInChain(int id) const {
+        if (id < 0) return nullptr;
+        uint64_t steps = 0;
+        const Staff* current = table[hashFunction(id)];
+        while (current != nullptr && current->id != id) {
+            current = current->next;
+            steps++;
+        }
+        HMS_COUNT(StaffChainSteps, steps);
+        return current;
+    }
+
+    // Secondary indexes: each node owns a dense slot and every role, department
+    // and shift value maps to the set of slots that hold it
+    vector<Staff*> slots;
+    vector<int> freeSlots;
+    SlotSet liveSlots;
+    unordered_map<uint32_t, SlotSet> byRole, byDepartment, byShift; // Keyed by symbol ID
+
+    void indexNode(Staff* node) {
+        if (freeSlots.empty()) {
+            node->slot = static_cast<int>(slots.size());
+            slots.push_back(node);
+        } else {
+            node->slot = freeSlots.back();
+            freeSlots.pop_back();
+            slots[node->slot] = node;
+        }
+        liveSlots.insert(node->slot);
+        byRole[node->role.id].insert(node->slot);
+        byDepartment[node->department.id].insert(node->slot);
+        byShift[node->shift.id].insert(node->slot);
+    }
+
+    static void eraseSlot(unordered_map<uint32_t, SlotSet>& index, Symbol value, int slot) {
+        auto it = index.find(value.id);
+        it->second.erase(slot);
+        if (it->second.size() == 0) index.erase(it);
+    }
+
+    void unindexNode(Staff* node) {
+        eraseSlot(byRole, node->role, node->slot);
+        eraseSlot(byDepartment, node->department, node->slot);
+        eraseSlot(byShift, node->shift, node->slot);
+        liveSlots.erase(node->slot);
+        slots[node->slot] = nullptr;
+        freeSlots.push_back(node->slot);
+    }
+
+    // Links a new entry at the head of its bucket without any checks
+    void insert(int id, const string& name, const string& role, const string& department, const string& shift) {
+        int index = hashFunction(id);
+        table[index] = nodes.create(id, name, role, department, shift, table[index]);
+        indexNode(table[index]);
+        numEntries++;
+    }
+
+    // Resize the hash table when the load factor is exceeded
+    void resizeTable() {
+        rehash(table.size() * 2);
+    }
+
+    // Existing nodes are relinked into the new buckets, so growing never copies
+    // or allocates a node
+    void rehash(size_t bucketCount) {
+        vector<Staff*> oldTable(bucketCount, nullptr);
+        table.swap(oldTable);
+        for (Staff* head : oldTable) {
+            while (head != nullptr) {
+                Staff* node = head;
+                head = head->next;
+                int index = hashFunction(node->id);
+                node->next = table[index];
+                table[index] = node;
+            }
+        }
+    }
+
+    void clear() {
+        for (Staff*& head : table) {
+            while (head != nullptr) {
+                Staff* temp = head;
+                head = head->next;
+                nodes.destroy(temp);
+            }
+        }
+        numEntries = 0;
+        slots.clear();
+        freeSlots.clear();
+        liveSlots = SlotSet();
+        byRole.clear();
+        byDepartment.clear();
+        byShift.clear();
+    }
+
+public:
+    StaffManagement(int initialSize = 10) : numEntries(0) {
+        if (initialSize <= 0) {
+            throw invalid_argument("Initial size of the table must be greater than zero.");
+        }
+        table.resize(initialSize, nullptr);
+    }
+
+    ~StaffManagement() {
+        clear();
+    }
+
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    size_t size() const {
+        return numEntries;
+    }
+
+    size_t getBucketCount() const {
+        return table.size();
+    }
+
+    // Sizes the table for count staff in one rehash, so a bulk load never
+    // triggers the repeated doublings of resizeTable
+    void reserve(size_t count) {
+        size_t needed = static_cast<size_t>(count / loadFactorThreshold) + 1;
+        if (needed > table.size()) {
+            rehash(needed);
+        }
+        slots.reserve(count);
+    }
+
+    size_t getLongestChain() const {
+        size_t longest = 0;
+        for (const Staff* head : table) {
+            size_t length = 0;
+            for (const Staff* current = head; current != nullptr; current = current->next) length++;
+            longest = max(longest, length);
+        }
+        return longest;
+    }
+
+    bool addStaff(int id, const string& name, const string& role, const string& department, const string& shift) {
+        if (id < 0) {
+            throw invalid_argument("ID cannot be negative.");
+        }
+        if (!insertStaff(id, name, role, department, shift)) {
+            cout << "Error: Staff with ID " << id << " already exists." << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Adds the staff member; false for a negative or duplicate ID
+    bool insertStaff(int id, const string& name, const string& role, const string& department, const string& shift) {
+        HMS_TIME(StaffAdd);
+        if (id < 0 || findInChain(id)) {
+            return false;
+        }
+        // Add new staff if ID is unique
+        insert(id, name, role, department, shift);
+
+        if (mutationLog) {
+            BinaryWriter entry;
+            entry.putInt(id);
+            entry.putString(name);
+            entry.putString(role);
+            entry.putString(department);
+            entry.putString(shift);
+            mutationLog->append(MutationType::StaffAdd, entry);
+        }
+
+        if (static_cast<double>(numEntries) / table.size() > loadFactorThreshold) {
+            resizeTable();
+        }
+        return true;
+    }
+
+    // Chains are written tail first so re-inserting at the head restores their order
+    void saveSnapshot(SnapshotBuilder& out) const {
+        vector<SnapshotStaff> records;
+        vector<int32_t> ids;
+        records.reserve(numEntries);
+        ids.reserve(numEntries);
+        vector<Staff*> chain;
+        for (Staff* head : table) {
+            chain.clear();
+            for (Staff* current = head; current != nullptr; current = current->next) {
+                chain.push_back(current);
+            }
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                const Staff* staff = *it;
+                records.push_back(SnapshotStaff{staff->id, out.addString(staff->name), out.addString(staff->role),
+                                                out.addString(staff->department), out.addString(staff->shift)});
+                ids.push_back(staff->id);
+            }
+        }
+        out.addSection(SnapshotSectionKind::Meta, vector<SnapshotMeta>{SnapshotMeta{table.size()}});
+        out.addSection(SnapshotSectionKind::Staff, records);
+        out.addIndexSection(SnapshotSectionKind::StaffIndex, ids);
+    }
+
+    void loadSnapshot(const SnapshotView& in) {
+        clear();
+        RecordSpan<SnapshotMeta> meta = in.records<SnapshotMeta>(SnapshotSectionKind::Meta);
+        table.assign(meta.size() > 0 ? max<uint64_t>(1, meta[0].staffTableSize) : 10, nullptr);
+        for (const SnapshotStaff& staff : in.records<SnapshotStaff>(SnapshotSectionKind::Staff)) {
+            insert(staff.id, in.text(staff.name), in.text(staff.role), in.text(staff.department), in.text(staff.shift));
+        }
+    }
+
+    void displayStaff() {
+        OutputBuffer out;
+        for (size_t i = 0; i < table.size(); i++) {
+            Staff* current = table[i];
+            while (current != nullptr) {
+                writeStaff(out, *current);
+                current = current->next;
+            }
+        }
+    }
+    
+    const Staff* findStaff(int id) const {
+        HMS_TIME(StaffFind);
+        return findInChain(id);
+    }
+
+    void searchStaff(int id) {
+        if (id < 0) {
+            cout << "Invalid ID. Please enter a non-negative integer." << endl;
+            return;
+        }
+        if (const Staff* current = findStaff(id)) {
+            OutputBuffer out;
+            out << "Staff found: \n";
+            writeStaff(out, *current);
+            return;
+        }
+        cout << "Staff with ID " << id << " not found." << endl;
+    }
+    
+    // Staff matching every given attribute; an empty value matches anything.
+    // Intersects the bitmaps of the given values a word at a time, smallest first.
+    vector<const Staff*> queryStaff(const string& role, const string& department, const string& shift) const {
+        HMS_TIME(StaffQuery);
+        vector<const SlotSet*> sets;
+        const unordered_map<uint32_t, SlotSet>* indexes[] = {&byRole, &byDepartment, &byShift};
+        const string* values[] = {&role, &department, &shift};
+        for (int i = 0; i < 3; i++) {
+            if (values[i]->empty()) continue;
+            uint32_t symbol;
+            if (!symbolTable().find(*values[i], symbol)) return {};
+            auto it = indexes[i]->find(symbol);
+            if (it == indexes[i]->end()) return {};
+            sets.push_back(&it->second);
+        }
+        if (sets.empty()) sets.push_back(&liveSlots);
+        sort(sets.begin(), sets.end(), [](const SlotSet* a, const SlotSet* b) { return a->size() < b->size(); });
+
+        vector<const Staff*> matches;
+        matches.reserve(sets[0]->size());
+        size_t wordCount = sets[0]->getWords().size();
+        for (const SlotSet* set : sets) wordCount = min(wordCount, set->getWords().size());
+        for (size_t w = 0; w < wordCount; w++) {
+            uint64_t bits = sets[0]->getWords()[w];
+            for (size_t i = 1; i < sets.size() && bits; i++) {
+                bits &= sets[i]->getWords()[w];
+            }
+            while (bits) {
+                matches.push_back(slots[w * 64 + countTrailingZeros(bits)]);
+                bits &= bits - 1;
+            }
+        }
+        return matches;
+    }
+
+    // Same result by walking every bucket; kept as the baseline for benchmarks
+    vector<const Staff*> scanStaff(const string& role, const string& department, const string& shift) const {
+        vector<const Staff*> matches;
+        for (const Staff* head : table) {
+            for (const Staff* current = head; current; current = current->next) {
+                if ((role.empty() || current->role.str() == role) && (department.empty() || current->department.str() == department) &&
+                    (shift.empty() || current->shift.str() == shift)) {
+                    matches.push_back(current);
+                }
+            }
+        }
+        return matches;
+    }
+
+    void displayStaffQuery(const string& role, const string& department, const string& shift) const {
+        vector<const Staff*> matches = queryStaff(role, department, shift);
+        OutputBuffer out;
+        for (const Staff* current : matches) {
+            writeStaff(out, *current);
+        }
+        out << matches.size() << " staff found.\n";
+    }
+
+    // Unlinks and frees the staff member; false if there is none with the ID
+    bool removeStaff(int id) {
+        HMS_TIME(StaffDelete);
+        if (id < 0) return false;
+        int index = hashFunction(id);
+        Staff* current = table[index];
+        Staff* prev = nullptr;
+        while (current != nullptr) {
+            if (current->id == id) {
+                if (prev == nullptr) {
+                    table[index] = current->next;
+                } else {
+                    prev->next = current->next;
+                }
+                unindexNode(current);
+                nodes.destroy(current);
+                numEntries--;
+
+                if (mutationLog) {
+                    BinaryWriter entry;
+                    entry.putInt(id);
+                    mutationLog->append(MutationType::StaffDelete, entry);
+                }
+                return true;
+            }
+            prev = current;
+            current = current->next;
+        }
+        return false;
+    }
+
+    void deleteStaff(int id) {
+        if (id < 0) {
+            cout << "Invalid ID. Please enter a non-negative integer." << endl;
+            return;
+        }
+        if (removeStaff(id)) {
+            cout << "Staff with ID " << id << " has been deleted." << endl;
+        } else {
+            cout << "Staff with ID " << id << " not found." << endl;
+        }
+    }
+    
+    
+};
+
+// ================= Persistence =================
+struct Hospital {
+    PatientList patients;
+    BillingSystem billing;
+    MedicalSystem medical;
+    BedManagement beds;
+    StaffManagement staff;
+    DoctorManagement doctors;
+
+    void setMutationLog(MutationLog* log) {
+        patients.setMutationLog(log);
+        billing.setMutationLog(log);
+        medical.setMutationLog(log);
+        beds.setMutationLog(log);
+        staff.setMutationLog(log);
+        doctors.setMutationLog(log);
+    }
+};
+
+// Structure sizes reported next to the operation metrics
+vector<pair<string, double>> hospitalGauges(const Hospital& hospital);
+
+void writeMetrics(ostream& out, const Hospital& hospital, bool json);
+
+// Rewrites a metrics file at most once per interval; JSON if its name ends in .json
+class MetricsDumper {
+private:
+    string path;
+    chrono::steady_clock::duration interval;
+    chrono::steady_clock::time_point lastDump;
+
+public:
+    MetricsDumper(const string& path, double intervalSeconds)
+        : path(path), interval(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(intervalSeconds))),
+          lastDump(chrono::steady_clock::now()) {}
+
+    void dump(const Hospital& hospital) {
+        string temporaryPath = path + ".tmp";
+        {
+            ofstream out(temporaryPath);
+            if (!out) {
+                throw runtime_error("Cannot write metrics file " + path);
+            }
+            bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+            writeMetrics(out, hospital, json);
+        }
+        filesystem::rename(temporaryPath, path);
+        lastDump = chrono::steady_clock::now();
+    }
+
+    void dumpIfDue(const Hospital& hospital) {
+        if (chrono::steady_clock::now() - lastDump >= interval) {
+            dump(hospital);
+        }
+    }
+};
+
+// Re-executes one logged mutation without printing. Recovery detaches the
+// managers' log first; with a log attached the mutation is logged again.
+void applyMutation(Hospital& hospital, MutationType type, BinaryReader& in);
+
+// Append-only file of mutations. Each record is
+//   [u32 body size][u64 sequence number][u8 type][payload][u32 checksum of body]
+// Records are buffered and written in groups; syncEachRecord writes every record immediately.
+class WriteAheadLog : public MutationLog {
+private:
+    string path;
+#if defined(HMS_HAVE_MMAP)
+    int fd;
+#else
+    ofstream file;
+#endif
+    string pending;
+    chrono::steady_clock::time_point pendingSince; // When the oldest uncommitted record was appended
+    uint64_t nextSequence;
+    uint64_t recordsSinceReset;
+    bool commitEachRecord;
+    static const size_t groupCommitBytes = 1 << 20;
+    static constexpr chrono::milliseconds groupCommitDelay{10};
+
+    bool isOpen() const {
+#if defined(HMS_HAVE_MMAP)
+        return fd >= 0;
+#else
+        return file.is_open();
+#endif
+    }
+
+public:
+    WriteAheadLog() :
+#if defined(HMS_HAVE_MMAP)
+                      fd(-1),
+#endif
+                      nextSequence(1), recordsSinceReset(0), commitEachRecord(true) {}
+
+    ~WriteAheadLog() {
+        try {
+            commit();
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+        }
+#if defined(HMS_HAVE_MMAP)
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    // With commitEachRecord every append is written and synced before it
+    // returns; otherwise appends are group-committed once 1 MiB or 10 ms of
+    // records are pending, or when the owner calls commit()
+    void open(const string& logPath, uint64_t sequence, bool commitEachRecord) {
+        path = logPath;
+        nextSequence = sequence;
+        this->commitEachRecord = commitEachRecord;
+#if defined(HMS_HAVE_MMAP)
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw runtime_error("Cannot open write-ahead log " + path);
+        }
+#else
+        file.open(path, ios::binary | ios::app);
+        if (!file) {
+            throw runtime_error("Cannot open write-ahead log " + path);
+        }
+#endif
+    }
+
+    void append(MutationType type, const BinaryWriter& payload) override {
+        if (pending.empty() && !commitEachRecord) {
+            pendingSince = chrono::steady_clock::now();
+        }
+        uint32_t bodySize = static_cast<uint32_t>(sizeof(uint64_t) + 1 + payload.size());
+        size_t start = pending.size();
+        pending.append(reinterpret_cast<const char*>(&bodySize), sizeof(bodySize));
+        pending.append(reinterpret_cast<const char*>(&nextSequence), sizeof(nextSequence));
+        pending.push_back(static_cast<char>(type));
+        pending.append(payload.data());
+        uint32_t sum = checksum(pending.data() + start + sizeof(bodySize), bodySize);
+        pending.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+
+        nextSequence++;
+        recordsSinceReset++;
+        if (commitEachRecord || pending.size() >= groupCommitBytes ||
+            chrono::steady_clock::now() - pendingSince >= groupCommitDelay) {
+            commit();
+        }
+    }
+
+    // Writes the pending records and syncs them to disk
+    void commit() {
+        if (pending.empty() || !isOpen()) return;
+#if defined(HMS_HAVE_MMAP)
+        size_t offset = 0;
+        while (offset < pending.size()) {
+            ssize_t written = ::write(fd, pending.data() + offset, pending.size() - offset);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error("Cannot write write-ahead log " + path + ": " + strerror(errno));
+            }
+            offset += written;
+        }
+        if (::fsync(fd) != 0) {
+            throw runtime_error("Cannot sync write-ahead log " + path + ": " + strerror(errno));
+        }
+#else
+        file.write(pending.data(), pending.size());
+        file.flush();
+        if (!file) {
+            throw runtime_error("Cannot write write-ahead log " + path);
+        }
+#endif
+        pending.clear();
+    }
+
+    // Empties the log once a snapshot covers everything in it
+    void reset() {
+        commit();
+#if defined(HMS_HAVE_MMAP)
+        if (fd >= 0 && ::ftruncate(fd, 0) != 0) {
+            throw runtime_error("Cannot truncate write-ahead log " + path + ": " + strerror(errno));
+        }
+#else
+        file.close();
+        file.open(path, ios::binary | ios::trunc);
+#endif
+        recordsSinceReset = 0;
+    }
+
+    uint64_t getLastSequence() const {
+        return nextSequence - 1;
+    }
+
+    uint64_t getRecordsSinceReset() const {
+        return recordsSinceReset;
+    }
+
+    // Calls apply for every intact record with a sequence number above afterSequence.
+    // Returns the byte length of the intact prefix so a torn tail can be cut off.
+    template <typename Apply>
+    static size_t replay(const string& logPath, uint64_t afterSequence, uint64_t& lastSequence, Apply apply) {
+        ifstream in(logPath, ios::binary);
+        if (!in) return 0;
+        string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+        size_t offset = 0;
+        while (data.size() - offset >= sizeof(uint32_t)) {
+            uint32_t bodySize;
+            memcpy(&bodySize, data.data() + offset, sizeof(bodySize));
+            size_t recordSize = sizeof(uint32_t) + static_cast<size_t>(bodySize) + sizeof(uint32_t);
+            if (bodySize < sizeof(uint64_t) + 1 || data.size() - offset < recordSize) break;
+
+            const char* body = data.data() + offset + sizeof(uint32_t);
+            uint32_t storedSum;
+            memcpy(&storedSum, body + bodySize, sizeof(storedSum));
+            if (storedSum != checksum(body, bodySize)) break;
+
+            uint64_t sequence;
+            memcpy(&sequence, body, sizeof(sequence));
+            MutationType type = static_cast<MutationType>(static_cast<uint8_t>(body[sizeof(uint64_t)]));
+            if (sequence > afterSequence) {
+                BinaryReader payload(body + sizeof(uint64_t) + 1, bodySize - sizeof(uint64_t) - 1);
+                apply(type, payload);
+            }
+            lastSequence = max(lastSequence, sequence);
+            offset += recordSize;
+        }
+        return offset;
+    }
+};
+
+void writeHospitalSnapshot(const Hospital& hospital, const string& path, uint64_t sequence);
+void loadHospitalSnapshot(Hospital& hospital, const SnapshotView& view);
+
+struct RecoveryStats {
+    bool snapshotLoaded = false;
+    uint64_t replayedRecords = 0;
+    size_t truncatedBytes = 0;
+    double seconds = 0;
+};
+
+// Durable storage for a Hospital: a snapshot file plus a write-ahead log of
+// every mutation since that snapshot. Recovery loads the snapshot and replays
+// the log; a checkpoint writes a new snapshot and empties the log.
+class Storage {
+private:
+    Hospital& hospital;
+    string directory;
+    WriteAheadLog wal;
+    MutationFanout sinks; // The write-ahead log first, then any added sinks
+    bool commitEachRecord;
+    uint64_t checkpointInterval; // Log records between automatic checkpoints
+
+    string snapshotPath() const {
+        return directory + "/hms.snapshot";
+    }
+
+    string logPath() const {
+        return directory + "/hms.wal";
+    }
+
+    // Returns the log sequence number the snapshot covers, or 0 if there is none
+    uint64_t loadSnapshot(bool& loaded) {
+        loaded = false;
+        if (!filesystem::exists(snapshotPath())) return 0;
+
+        SnapshotView view;
+        view.open(snapshotPath());
+        if (!view.verifyPayload()) {
+            throw runtime_error("Snapshot " + snapshotPath() + " is corrupted.");
+        }
+        loadHospitalSnapshot(hospital, view);
+        loaded = true;
+        return view.getSequence();
+    }
+
+public:
+    Storage(Hospital& hospital, const string& directory, bool commitEachRecord = true, uint64_t checkpointInterval = 1000000)
+        : hospital(hospital), directory(directory), commitEachRecord(commitEachRecord), checkpointInterval(checkpointInterval) {
+        sinks.add(&wal);
+    }
+
+    // Also sends every logged mutation to the sink (e.g. the audit log) once recovered
+    void addSink(MutationLog* sink) {
+        sinks.add(sink);
+    }
+
+    ~Storage() {
+        try {
+            wal.commit();
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+        }
+        hospital.setMutationLog(nullptr);
+    }
+
+    // Loads the snapshot, replays the log on top of it and starts logging
+    RecoveryStats recover() {
+        RecoveryStats stats;
+        auto start = chrono::steady_clock::now();
+        filesystem::create_directories(directory);
+
+        hospital.setMutationLog(nullptr);
+        ofstream nullOutput;
+        streambuf* previous = cout.rdbuf(nullOutput.rdbuf()); // Replayed operations print as they run
+        uint64_t lastSequence = 0;
+        try {
+            lastSequence = loadSnapshot(stats.snapshotLoaded);
+            uint64_t snapshotSequence = lastSequence;
+            size_t intactBytes = WriteAheadLog::replay(logPath(), snapshotSequence, lastSequence,
+                [&](MutationType type, BinaryReader& payload) {
+                    applyMutation(hospital, type, payload);
+                    stats.replayedRecords++;
+                });
+            if (filesystem::exists(logPath()) && filesystem::file_size(logPath()) > intactBytes) {
+                stats.truncatedBytes = filesystem::file_size(logPath()) - intactBytes;
+                filesystem::resize_file(logPath(), intactBytes);
+            }
+        } catch (...) {
+            cout.rdbuf(previous);
+            throw;
+        }
+        cout.rdbuf(previous);
+
+        wal.open(logPath(), lastSequence + 1, commitEachRecord);
+        hospital.setMutationLog(&sinks);
+        stats.seconds = elapsedSeconds(start);
+        return stats;
+    }
+
+    // Writes a new snapshot next to the old one, swaps it in and empties the log.
+    // The snapshot and the rename are on disk before the log is truncated.
+    void checkpoint() {
+        wal.commit();
+
+        string temporaryPath = snapshotPath() + ".tmp";
+        writeHospitalSnapshot(hospital, temporaryPath, wal.getLastSequence());
+        syncPath(temporaryPath);
+        filesystem::rename(temporaryPath, snapshotPath());
+        syncPath(directory);
+        // Records still in the log are covered by the snapshot's sequence number,
+        // so a crash before this reset only causes them to be skipped on replay
+        wal.reset();
+    }
+
+    void checkpointIfDue() {
+        if (wal.getRecordsSinceReset() >= checkpointInterval) {
+            checkpoint();
+        }
+    }
+
+    void commit() {
+        wal.commit();
+    }
+};
+
+// ================= Audit Log =================
+// Append-only record of every change for compliance review. Unlike the
+// write-ahead log it is never truncated by checkpoints. The file starts with
+// an 8-byte magic followed by events, each a fixed header and its payload
+// (the same payload the write-ahead log carries for that mutation).
+struct AuditEventHeader {
+    uint32_t payloadSize;
+    uint32_t payloadChecksum;
+    uint64_t sequence;
+    int64_t timestampNs; // Wall clock, nanoseconds since the Unix epoch
+    uint8_t type;        // MutationType
+    uint8_t reserved[7];
+};
+
+const char auditMagic[8] = {'H', 'M', 'S', 'A', 'U', 'D', '0', '1'};
+
+// A mutation waiting in a MutationRing for the background writer
+struct QueuedMutation {
+    int64_t timestampNs; // Wall clock when it was appended, nanoseconds since the Unix epoch
+    MutationType type;
+    string payload;      // Keeps its capacity across laps, so steady-state appends do not allocate
+};
+
+// Bounded lock-free multi-producer ring (Vyukov's per-cell sequence scheme)
+// with a single consumer. A producer only waits if the ring is full, i.e. the
+// consumer has fallen a whole ring behind.
+class MutationRing {
+private:
+    struct alignas(64) Cell {
+        atomic<uint64_t> sequence;
+        QueuedMutation mutation;
+    };
+
+    static const size_t ringSize = 1 << 16;
+
+    unique_ptr<Cell[]> cells;
+    alignas(64) atomic<uint64_t> enqueuePosition;
+    alignas(64) uint64_t dequeuePosition;
+    atomic<uint64_t> fullWaits;
+
+public:
+    MutationRing() : cells(new Cell[ringSize]), enqueuePosition(0), dequeuePosition(0), fullWaits(0) {
+        for (size_t i = 0; i < ringSize; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    void push(MutationType type, const BinaryWriter& payload) {
+        uint64_t position = enqueuePosition.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & (ringSize - 1)];
+            uint64_t sequence = cell->sequence.load(memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence - position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                fullWaits.fetch_add(1, memory_order_relaxed);
+                this_thread::yield();
+                position = enqueuePosition.load(memory_order_relaxed);
+            } else {
+                position = enqueuePosition.load(memory_order_relaxed);
+            }
+        }
+        cell->mutation.timestampNs = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        cell->mutation.type = type;
+        cell->mutation.payload.assign(payload.data());
+        cell->sequence.store(position + 1, memory_order_release);
+    }
+
+    // Hands the published mutations in order to consume(mutation, position)
+    // until it returns false or the ring is empty; returns how many were taken
+    template <typename Consume>
+    size_t drain(Consume consume) {
+        size_t taken = 0;
+        while (true) {
+            Cell& cell = cells[dequeuePosition & (ringSize - 1)];
+            if (cell.sequence.load(memory_order_acquire) != dequeuePosition + 1) break;
+            bool more = consume(cell.mutation, dequeuePosition);
+            cell.sequence.store(dequeuePosition + ringSize, memory_order_release);
+            dequeuePosition++;
+            taken++;
+            if (!more) break;
+        }
+        return taken;
+    }
+
+    uint64_t getPushed() const {
+        return enqueuePosition.load(memory_order_acquire);
+    }
+
+    uint64_t getFullWaits() const {
+        return fullWaits.load(memory_order_relaxed);
+    }
+};
+
+// Callers hand mutations to a MutationRing and return; a background thread
+// drains the ring, encodes the mutations into one batch of up to 1 MiB and
+// hands it to a single write() (synced once per batch if asked). Subclasses
+// choose the file layout; they must call stop() in their destructor.
+class BackgroundMutationWriter : public MutationLog {
+private:
+    static const size_t batchBytes = 1 << 20;
+
+    MutationRing ring;
+    atomic<bool> stopping;
+    atomic<uint64_t> writtenEvents, droppedEvents, batches;
+    bool syncEachBatch;
+    atomic<bool> failed;
+    mutable mutex failureLock;
+    string failure; // First error on the writer thread
+    const char* label;
+#if defined(HMS_HAVE_MMAP)
+    int fd;
+#else
+    ofstream file;
+#endif
+    thread writer;
+
+    void run() {
+#if defined(HMS_HAVE_MMAP)
+        // SIGPIPE is blocked on this thread only, so a pipe reader that goes
+        // away fails the write with EPIPE instead of ending the process
+        sigset_t pipeSignal;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+#endif
+        // An error here must not escape the thread; once the writer has failed
+        // it keeps draining the ring so appends never block, but drops the events
+        uint64_t firstSequence = 0;
+        try {
+            firstSequence = prepareFile();
+        } catch (const exception& e) {
+            fail(e.what());
+        }
+        string batch;
+        batch.reserve(batchBytes + 4096);
+        while (true) {
+            bool finishing = stopping.load(memory_order_acquire);
+            size_t taken = ring.drain([&](const QueuedMutation& mutation, uint64_t position) {
+                if (!hasFailed()) encode(mutation, firstSequence + position, batch);
+                return batch.size() < batchBytes;
+            });
+            if (taken > 0) {
+                if (!batch.empty()) {
+                    try {
+                        writeBatch(batch);
+                    } catch (const exception& e) {
+                        fail(e.what());
+                    }
+                    batch.clear();
+                    batches.fetch_add(1, memory_order_relaxed);
+                }
+                (hasFailed() ? droppedEvents : writtenEvents).fetch_add(taken, memory_order_release);
+            } else if (finishing) {
+                return;
+            } else {
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+        }
+    }
+
+#if defined(HMS_HAVE_MMAP)
+    // Takes the SIGPIPE a failed pipe write left pending on this thread
+    static void discardPipeSignal() {
+        sigset_t pending;
+        sigpending(&pending);
+        if (sigismember(&pending, SIGPIPE)) {
+            sigset_t pipeSignal;
+            sigemptyset(&pipeSignal);
+            sigaddset(&pipeSignal, SIGPIPE);
+            int signal;
+            sigwait(&pipeSignal, &signal);
+        }
+    }
+#endif
+
+protected:
+    string path;
+
+    // Runs on the writer thread before the first batch; returns the sequence number the next event gets
+    virtual uint64_t prepareFile() = 0;
+
+    // Appends one event to the batch
+    virtual void encode(const QueuedMutation& mutation, uint64_t sequence, string& batch) = 0;
+
+    // Records the first failure and reports it once; later events are dropped
+    void fail(const string& reason) {
+        lock_guard<mutex> guard(failureLock);
+        if (!failure.empty()) return;
+        failure = reason;
+        failed.store(true, memory_order_release);
+        cerr << "Cannot write " << label << " " << path << ": " << reason << "; dropping further events." << endl;
+    }
+
+    // Events after a partly written batch could not be read back, so a failed write stops the writer
+    void writeBatch(const string& batch) {
+        if (hasFailed()) return;
+#if defined(HMS_HAVE_MMAP)
+        size_t offset = 0;
+        while (offset < batch.size()) {
+            ssize_t written = ::write(fd, batch.data() + offset, batch.size() - offset);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EPIPE) discardPipeSignal();
+                fail(strerror(errno));
+                return;
+            }
+            offset += written;
+        }
+        if (syncEachBatch) ::fsync(fd);
+#else
+        file.write(batch.data(), batch.size());
+        file.flush();
+        if (!file) fail("write failed");
+#endif
+    }
+
+    // Opens (or creates) the file for appending and starts the writer thread
+    void start(const string& filePath, bool syncBatches) {
+        path = filePath;
+        syncEachBatch = syncBatches;
+        failed.store(false, memory_order_relaxed);
+        failure.clear();
+#if defined(HMS_HAVE_MMAP)
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw runtime_error("Cannot open " + string(label) + " " + path);
+        }
+#else
+        file.open(path, ios::binary | ios::app);
+        if (!file) {
+            throw runtime_error("Cannot open " + string(label) + " " + path);
+        }
+#endif
+        writer = thread(&BackgroundMutationWriter::run, this);
+    }
+
+    // Drains the ring, stops the writer and closes the file
+    void stop() {
+        if (!writer.joinable()) return;
+        stopping.store(true, memory_order_release);
+        writer.join();
+        stopping.store(false, memory_order_relaxed);
+#if defined(HMS_HAVE_MMAP)
+        ::close(fd);
+        fd = -1;
+#else
+        file.close();
+#endif
+    }
+
+public:
+    explicit BackgroundMutationWriter(const char* label)
+        : stopping(false), writtenEvents(0), droppedEvents(0), batches(0), syncEachBatch(true), failed(false), label(label)
+#if defined(HMS_HAVE_MMAP)
+          , fd(-1)
+#endif
+    {}
+
+    void append(MutationType type, const BinaryWriter& payload) override {
+        ring.push(type, payload);
+    }
+
+    // Blocks until everything appended so far has been handed to the file (or dropped after a failure)
+    void flush() {
+        uint64_t target = ring.getPushed();
+        while (writer.joinable() && writtenEvents.load(memory_order_acquire) + droppedEvents.load(memory_order_acquire) < target) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    }
+
+    bool hasFailed() const {
+        return failed.load(memory_order_acquire);
+    }
+
+    // Why the writer stopped writing; empty while it is healthy
+    string getFailure() const {
+        lock_guard<mutex> guard(failureLock);
+        return failure;
+    }
+
+    uint64_t getWrittenEvents() const {
+        return writtenEvents.load(memory_order_relaxed);
+    }
+
+    uint64_t getDroppedEvents() const {
+        return droppedEvents.load(memory_order_relaxed);
+    }
+
+    uint64_t getBatchCount() const {
+        return batches.load(memory_order_relaxed);
+    }
+
+    uint64_t getFullWaits() const {
+        return ring.getFullWaits();
+    }
+};
+
+class AuditLog : public BackgroundMutationWriter {
+private:
+    uint64_t nextSequence = 1;
+    bool needsMagic = false;
+
+protected:
+    uint64_t prepareFile() override {
+        if (needsMagic) {
+            writeBatch(string(auditMagic, sizeof(auditMagic)));
+        }
+        return nextSequence;
+    }
+
+    void encode(const QueuedMutation& mutation, uint64_t sequence, string& batch) override {
+        AuditEventHeader header;
+        header.payloadSize = static_cast<uint32_t>(mutation.payload.size());
+        header.payloadChecksum = checksum(mutation.payload.data(), mutation.payload.size());
+        header.sequence = sequence;
+        header.timestampNs = mutation.timestampNs;
+        header.type = static_cast<uint8_t>(mutation.type);
+        memset(header.reserved, 0, sizeof(header.reserved));
+        batch.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        batch.append(mutation.payload);
+    }
+
+public:
+    AuditLog() : BackgroundMutationWriter("audit log") {}
+
+    ~AuditLog() {
+        close();
+    }
+
+    // Opens (or creates) the audit file after its last intact event, cutting
+    // off a torn tail, and starts the writer thread. A file that is not an
+    // audit log is moved aside to <path>.unreadable-<time> and a new log begun.
+    void open(const string& auditPath, bool syncBatches = true) {
+        uint64_t lastSequence = 0;
+        uintmax_t intactBytes = sizeof(auditMagic);
+        uintmax_t size = filesystem::exists(auditPath) ? filesystem::file_size(auditPath) : 0;
+        bool valid = read(auditPath, [&](const AuditEventHeader& header, const string& payload) {
+            lastSequence = header.sequence;
+            intactBytes += sizeof(header) + payload.size();
+        });
+        if (valid) {
+            if (size > intactBytes) filesystem::resize_file(auditPath, intactBytes);
+        } else if (size >= sizeof(auditMagic)) {
+            string aside = auditPath + ".unreadable-" + to_string(time(nullptr));
+            filesystem::rename(auditPath, aside);
+            cerr << "Audit log " << auditPath << " has an unknown format; moved it to " << aside << " and started a new log." << endl;
+            size = 0;
+        } else if (size > 0) {
+            filesystem::resize_file(auditPath, 0); // Torn while the magic was written
+            size = 0;
+        }
+        nextSequence = lastSequence + 1;
+        needsMagic = size == 0;
+        start(auditPath, syncBatches);
+    }
+
+    void close() {
+        stop();
+    }
+
+    // Calls visit(header, payload) for every intact event in an audit file;
+    // returns false if the file is not an audit log
+    template <typename Visit>
+    static bool read(const string& auditPath, Visit visit) {
+        ifstream in(auditPath, ios::binary);
+        char magic[sizeof(auditMagic)];
+        if (!in.read(magic, sizeof(magic)) || memcmp(magic, auditMagic, sizeof(magic)) != 0) return false;
+        AuditEventHeader header;
+        string payload;
+        while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            payload.resize(header.payloadSize);
+            if (!in.read(&payload[0], header.payloadSize) || checksum(payload.data(), payload.size()) != header.payloadChecksum) break;
+            visit(header, payload);
+        }
+        return true;
+    }
+};
+
+int printAuditLog(const string& path);
+
+// ================= Change Feed =================
+// Change-data-capture export of every mutation to a file or named pipe for
+// downstream systems. Events are either newline-delimited JSON
+//   {"seq":7,"ts_ns":1760000000000000000,"type":"BillAdd","data":{"patient_id":3,...}}
+// or, after an 8-byte magic, length-prefixed binary frames
+//   [u32 length][u64 sequence][i64 timestampNs][u8 type][payload][u32 checksum]
+// where length counts everything after itself and the checksum covers the
+// bytes between the length and the checksum. Sequence numbers continue across
+// restarts when the feed is a regular file. Events leave on the writer thread,
+// so after a crash the feed can be ahead of what the write-ahead log recovers.
+enum class ChangeFeedFormat {
+    Json,
+    Binary
+};
+
+const char changeFeedMagic[8] = {'H', 'M', 'S', 'C', 'D', 'C', '0', '1'};
+
+// "json" or "binary"; throws invalid_argument for anything else
+ChangeFeedFormat parseChangeFeedFormat(const string& name);
+
+// Binary if the file starts with the magic, JSON otherwise (including an empty or missing file)
+ChangeFeedFormat detectChangeFeedFormat(const string& path);
+
+// Appends the JSON line for one event, without the newline; payloads are decoded per mutation type
+void appendChangeEventJson(string& out, uint64_t sequence, int64_t timestampNs, MutationType type, const string& payload);
+
+// Calls visit(sequence, jsonLine, nextOffset) for every complete event that
+// starts at or after the byte offset, in either format; stops at a torn or
+// damaged tail. nextOffset is where the following event starts.
+void readChangeFeed(const string& path, uint64_t offset, const function<void(uint64_t, const string&, uint64_t)>& visit);
+
+// Where a consumer stopped: the last event it processed and the byte offset
+// just past it, so a restarted consumer continues without gaps or repeats
+struct ChangeFeedCursor {
+    uint64_t sequence = 0;
+    uint64_t offset = 0;
+
+    // A missing file is a fresh cursor at the start of the feed
+    static ChangeFeedCursor load(const string& path) {
+        ChangeFeedCursor cursor;
+        ifstream in(path);
+        if (in && !(in >> cursor.sequence >> cursor.offset)) {
+            throw runtime_error("Cannot parse change feed cursor " + path);
+        }
+        return cursor;
+    }
+
+    // Replaces the file in one rename, so a crash leaves the old or the new cursor
+    void save(const string& path) const {
+        string temporary = path + ".tmp";
+        {
+            ofstream out(temporary, ios::trunc);
+            out << sequence << " " << offset << "\n";
+            if (!out.flush()) {
+                throw runtime_error("Cannot write change feed cursor " + path);
+            }
+        }
+        filesystem::rename(temporary, path);
+    }
+};
+
+class ChangeFeed : public BackgroundMutationWriter {
+private:
+    ChangeFeedFormat format;
+    uint64_t nextSequence;
+    bool needsMagic;
+
+protected:
+    uint64_t prepareFile() override {
+        if (needsMagic) {
+            writeBatch(string(changeFeedMagic, sizeof(changeFeedMagic)));
+        }
+        return nextSequence;
+    }
+
+    void encode(const QueuedMutation& mutation, uint64_t sequence, string& batch) override {
+        if (format == ChangeFeedFormat::Json) {
+            appendChangeEventJson(batch, sequence, mutation.timestampNs, mutation.type, mutation.payload);
+            batch += '\n';
+            return;
+        }
+        uint32_t length = static_cast<uint32_t>(sizeof(uint64_t) + sizeof(int64_t) + 1 + mutation.payload.size() + sizeof(uint32_t));
+        uint8_t type = static_cast<uint8_t>(mutation.type);
+        batch.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        size_t body = batch.size();
+        batch.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+        batch.append(reinterpret_cast<const char*>(&mutation.timestampNs), sizeof(mutation.timestampNs));
+        batch.append(reinterpret_cast<const char*>(&type), sizeof(type));
+        batch.append(mutation.payload);
+        uint32_t sum = checksum(batch.data() + body, batch.size() - body);
+        batch.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+    }
+
+public:
+    ChangeFeed() : BackgroundMutationWriter("change feed"), format(ChangeFeedFormat::Json), nextSequence(1), needsMagic(false) {}
+
+    ~ChangeFeed() {
+        close();
+    }
+
+    // Appends to a regular file after its last complete event (cutting off a
+    // torn tail), or streams into a named pipe, which blocks until a reader
+    // opens it and always starts at sequence 1
+    void open(const string& feedPath, ChangeFeedFormat feedFormat) {
+        format = feedFormat;
+        nextSequence = 1;
+        bool regularFile = !filesystem::exists(feedPath) || filesystem::is_regular_file(feedPath);
+        uint64_t size = regularFile && filesystem::exists(feedPath) ? filesystem::file_size(feedPath) : 0;
+        if (size > 0) {
+            if (detectChangeFeedFormat(feedPath) != format) {
+                throw runtime_error("Change feed " + feedPath + " was written in the other format.");
+            }
+            uint64_t intactBytes = format == ChangeFeedFormat::Binary ? sizeof(changeFeedMagic) : 0;
+            readChangeFeed(feedPath, 0, [&](uint64_t sequence, const string&, uint64_t next) {
+                nextSequence = sequence + 1;
+                intactBytes = next;
+            });
+            if (size > intactBytes) {
+                filesystem::resize_file(feedPath, intactBytes);
+            }
+        }
+        needsMagic = format == ChangeFeedFormat::Binary && size == 0;
+        start(feedPath, false);
+    }
+
+    void close() {
+        stop();
+    }
+
+    ChangeFeedFormat getFormat() const {
+        return format;
+    }
+};
+
+// Prints the events after the cursor as JSON lines and advances the cursor
+// file ("-" for none), so running it again prints only what is new
+int printChangeFeed(const string& feedPath, const string& cursorPath);
+
+// ================= CSV Conversion =================
+// Splits one CSV line; fields may be double quoted with "" as an escaped quote.
+// Copies every field; kept as the baseline for the CsvReader benchmark.
+vector<string> parseCsvLine(const string& line, char delimiter = ',');
+
+// Streams delimited rows (CSV or TSV) in fixed-size chunks. Fields are views
+// into the chunk buffer, and quoted fields ("" is an escaped quote) are
+// unescaped in place, so no field is copied. The views are only valid until
+// the next call to nextRow.
+class CsvReader {
+private:
+    istream& in;
+    char delimiter;
+    vector<char> buffer;
+    size_t begin = 0, end = 0; // Unread bytes of the buffer
+    bool exhausted = false;
+    size_t lineNumber = 0;
+    size_t estimatedRows = 0;
+    vector<string_view> fields;
+
+    // Moves the unread tail to the front and reads the next chunk behind it,
+    // growing the buffer when one line does not fit. False at end of stream.
+    bool fill() {
+        if (exhausted) return false;
+        if (begin > 0) {
+            memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        in.read(buffer.data() + end, buffer.size() - end);
+        size_t got = static_cast<size_t>(in.gcount());
+        end += got;
+        exhausted = got == 0;
+        return got > 0;
+    }
+
+    void split(char* line, size_t length) {
+        fields.clear();
+        if (!memchr(line, '"', length)) {
+            char* lineEnd = line + length;
+            char* fieldStart = line;
+            while (char* stop = static_cast<char*>(memchr(fieldStart, delimiter, lineEnd - fieldStart))) {
+                fields.emplace_back(fieldStart, stop - fieldStart);
+                fieldStart = stop + 1;
+            }
+            fields.emplace_back(fieldStart, lineEnd - fieldStart);
+            return;
+        }
+        // Unescaping only ever shortens the text, so it is written back over the line
+        char* out = line;
+        char* fieldStart = line;
+        bool quoted = false;
+        for (size_t i = 0; i < length; i++) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < length && line[i + 1] == '"') {
+                    *out++ = '"';
+                    i++;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    *out++ = c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == delimiter) {
+                fields.emplace_back(fieldStart, out - fieldStart);
+                fieldStart = out;
+            } else if (c != '\r') {
+                *out++ = c;
+            }
+        }
+        fields.emplace_back(fieldStart, out - fieldStart);
+    }
+
+public:
+    CsvReader(istream& in, char delimiter = ',', size_t chunkSize = 1 << 20) : in(in), delimiter(delimiter), buffer(max<size_t>(chunkSize, 64)) {
+        // Row estimate for pre-sizing: the stream's length over the average line of the first chunk
+        streamoff remaining = -1;
+        streampos here = in.tellg();
+        if (here != streampos(-1) && in.seekg(0, ios::end)) {
+            remaining = in.tellg() - here;
+            in.seekg(here);
+        }
+        in.clear();
+        fill();
+        size_t lines = count(buffer.data(), buffer.data() + end, '\n');
+        estimatedRows = lines == 0 || remaining <= 0 ? lines : static_cast<size_t>(double(remaining) * lines / end);
+    }
+
+    // Advances to the next non-empty line; false at end of input
+    bool nextRow() {
+        while (true) {
+            char* start = buffer.data() + begin;
+            char* newline = static_cast<char*>(memchr(start, '\n', end - begin));
+            size_t length;
+            if (newline) {
+                length = newline - start;
+                begin += length + 1;
+            } else if (fill()) {
+                continue;
+            } else if (begin < end) {
+                // Last line without a newline; fill() may have moved it to the front
+                start = buffer.data() + begin;
+                length = end - begin;
+                begin = end;
+            } else {
+                return false;
+            }
+            lineNumber++;
+            if (lineNumber == 1 && length >= 3 && memcmp(start, "\xEF\xBB\xBF", 3) == 0) {
+                // UTF-8 byte order mark written by spreadsheet exports
+                start += 3;
+                length -= 3;
+            }
+            if (length > 0 && start[length - 1] == '\r') length--;
+            if (length == 0) continue;
+            split(start, length);
+            return true;
+        }
+    }
+
+    const vector<string_view>& getFields() const {
+        return fields;
+    }
+
+    size_t getLineNumber() const {
+        return lineNumber;
+    }
+
+    // Approximate number of lines in the input, known before the first row is read
+    size_t getEstimatedRows() const {
+        return estimatedRows;
+    }
+};
+
+// Whole-field number parsers for imports; no whitespace or trailing text allowed
+int parseIntField(string_view value);
+double parseDoubleField(string_view value);
+
+// Tab for .tsv and .tab files, comma for anything else
+char delimiterFor(const string& path);
+
+// Calls handleRow for every data row after the header line. Bad rows are
+// reported as source:line and skipped without stopping the load. Returns the
+// number of rows handled.
+template <typename Handler>
+size_t forEachCsvRow(CsvReader& reader, const string& sourceName, size_t columns, Handler handleRow) {
+    size_t loaded = 0;
+    bool headerSeen = false;
+    while (reader.nextRow()) {
+        if (!headerSeen) {
+            // The first non-empty row is the header, whatever line it is on
+            headerSeen = true;
+            continue;
+        }
+        try {
+            const vector<string_view>& fields = reader.getFields();
+            if (fields.size() < columns) {
+                throw invalid_argument("expected " + to_string(columns) + " columns");
+            }
+            handleRow(fields);
+            loaded++;
+        } catch (const exception& e) {
+            cerr << sourceName << ":" << reader.getLineNumber() << ": " << e.what() << endl;
+        }
+    }
+    return loaded;
+}
+
+// Bulk loaders for one module, with the columns listed for importCsvDirectory.
+// Fields are checked with the same rules as the interactive prompts, and the
+// manager is sized for the whole file before the first row goes in.
+size_t importPatients(PatientList& patients, istream& in, const string& sourceName, char delimiter = ',');
+size_t importStaff(StaffManagement& staff, istream& in, const string& sourceName, char delimiter = ',');
+size_t importBills(BillingSystem& billing, istream& in, const string& sourceName, char delimiter = ',');
+size_t importMedicalRecords(MedicalSystem& medical, istream& in, const string& sourceName, char delimiter = ',');
+
+// Loads a CSV export (one file per module, each with a header row):
+//   patients.csv  id,name,age,condition,doctor,appointment
+//   staff.csv     id,name,role,department,shift
+//   beds.csv      bed_number,patient_id          (empty patient_id for a free bed)
+//   bills.csv     patient_id,amount,payment_method,paid
+//   records.csv   patient_id,name,age,history,prescriptions,notes
+// A .tsv file with tab-separated columns is read when there is no .csv.
+// Missing files are skipped. Bad rows are reported and skipped. Returns the number of rows loaded.
+size_t importCsvDirectory(Hospital& hospital, const string& directory);
+
+int convertCsvToSnapshot(const string& csvDirectory, const string& snapshotPath);
+int printSnapshotInfo(const string& path);
+
+// ================= Batch Command Engine =================
+// Stream buffer that collects output in large blocks. sync() is a no-op so that
+// endl inside the managers does not flush on every line while a batch runs.
+class BlockOutputBuffer : public streambuf {
+private:
+    vector<char> buffer;
+    FILE* target;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) {
+            if (buffer.size() == buffer.capacity()) {
+                flushBlock();
+            }
+            buffer.push_back(static_cast<char>(ch));
+        }
+        return ch;
+    }
+
+    streamsize xsputn(const char* s, streamsize count) override {
+        if (buffer.size() + count > buffer.capacity()) {
+            flushBlock();
+        }
+        if (static_cast<size_t>(count) > buffer.capacity()) {
+            fwrite(s, 1, count, target);
+        } else {
+            buffer.insert(buffer.end(), s, s + count);
+        }
+        return count;
+    }
+
+    int sync() override {
+        return 0;
+    }
+
+public:
+    BlockOutputBuffer(FILE* target, size_t blockSize = 1 << 20) : target(target) {
+        buffer.reserve(blockSize);
+    }
+
+    ~BlockOutputBuffer() {
+        flushBlock();
+    }
+
+    void flushBlock() {
+        if (!buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), target);
+            buffer.clear();
+        }
+        fflush(target);
+    }
+};
+
+// Splits a command line on whitespace; double quotes group words into one field
+vector<string> tokenizeCommand(const string& line);
+
+// Executes the line-oriented command format used by --batch:
+//   staff add <id> <name> <role> <department> <shift> | staff find <id> | staff delete <id> | staff list
+//   staff query <role|*> <department|*> <shift|*> | staff import <file>
+//   patient admit <id> <name> <age> s                  | patient admit <id> <name> <age> ns <doctor#> <time#>
+//   patient find <id> | patient discharge <id> | patient list | patient census | patient import <file>
+//   bed add <first> [last] | bed allocate <patientId> [urgent] | bed release <bedNumber> | bed stats
+//   bill add <patientId> <amount> <Card|Insurance|Cash> | bill pay-top | bill pay <patientId>
+//   bill find <patientId> | bill list | bill settle [insurance-coverage%] [cash-discount%] | bill import <file>
+//   record add <patientId> <name> <age> <history> <prescriptions> <notes>
+//   record find <patientId> | record update <patientId> <prescriptions> <notes>
+//   record delete <patientId> | record list | record import <file>
+//   (import files are CSV, or TSV when named .tsv, with a header row and the columns of importCsvDirectory)
+//   record search <words...>   (words are ANDed, OR between alternatives, trailing * for prefixes)
+//   doctor list | doctor book <doctor#> <time#> | doctor cancel <doctor#> <day> <HH:MM>
+//   doctor rebook <doctor#> <day> <HH:MM> <day> <HH:MM> | doctor earliest <specialization> [<day> <HH:MM>]
+//   doctor soonest <k> [specialization]
+//   doctor add <name> <specialization> <day> <HH:MM> [<day> <HH:MM> ...]   (day: Monday..Sunday or a day number)
+//   checkpoint (with --data: write a snapshot and empty the log) | stats [json]
+// Fields containing spaces are double quoted; '#' starts a comment.
+class CommandEngine {
+private:
+    Hospital& hospital;
+    Storage* storage;
+    MetricsDumper* metricsDumper = nullptr;
+    unique_ptr<WorkerPool> settlementPool; // Started on the first "bill settle" and reused after
+    size_t commandCount;
+    size_t errorCount;
+
+    static void requireArgs(const vector<string>& args, size_t count, const string& usage) {
+        if (args.size() < count) {
+            throw invalid_argument("Usage: " + usage);
+        }
+    }
+
+    // Runs a bulk importer on the CSV or TSV file named in a command
+    template <typename Importer>
+    static void importFile(const string& path, const string& what, Importer import) {
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open " + path + ".");
+        }
+        cout << import(in, path, delimiterFor(path)) << " " << what << " imported." << endl;
+    }
+
+    void staffCommand(const vector<string>& args) {
+        requireArgs(args, 2, "staff <add|find|delete|list|query|import> ...");
+        const string& action = args[1];
+        if (action == "add") {
+            requireArgs(args, 7, "staff add <id> <name> <role> <department> <shift>");
+            if (!isValidRole(args[4])) {
+                throw invalid_argument("Invalid role '" + args[4] + "'.");
+            }
+            hospital.staff.addStaff(parseIntArgument(args[2]), args[3], args[4], args[5], args[6]);
+        } else if (action == "find") {
+            requireArgs(args, 3, "staff find <id>");
+            hospital.staff.searchStaff(parseIntArgument(args[2]));
+        } else if (action == "delete") {
+            requireArgs(args, 3, "staff delete <id>");
+            hospital.staff.deleteStaff(parseIntArgument(args[2]));
+        } else if (action == "list") {
+            hospital.staff.displayStaff();
+        } else if (action == "query") {
+            requireArgs(args, 5, "staff query <role|*> <department|*> <shift|*>");
+            auto value = [](const string& arg) { return arg == "*" ? string() : arg; };
+            hospital.staff.displayStaffQuery(value(args[2]), value(args[3]), value(args[4]));
+        } else if (action == "import") {
+            requireArgs(args, 3, "staff import <csv-or-tsv-file>");
+            importFile(args[2], "staff", [&](istream& in, const string& path, char delimiter) {
+                return importStaff(hospital.staff, in, path, delimiter);
+            });
+        } else {
+            throw invalid_argument("Unknown staff command '" + action + "'.");
+        }
+    }
+
+    void patientCommand(const vector<string>& args) {
+        requireArgs(args, 2, "patient <admit|find|discharge|list|census|import> ...");
+        const string& action = args[1];
+        if (action == "admit") {
+            requireArgs(args, 6, "patient admit <id> <name> <age> <s|ns> [doctor# time#]");
+            int id = parseIntArgument(args[2]);
+            const string& name = args[3];
+            int age = parseIntArgument(args[4]);
+            if (!isAlphaString(name)) {
+                throw invalid_argument("Invalid patient name '" + name + "'.");
+            }
+            if (age <= 0 || age > 110) {
+                throw out_of_range("Age must be between 1 and 110.");
+            }
+            if (hospital.patients.searchPatientByID(id)) {
+                throw invalid_argument("Patient with ID " + args[2] + " already exists.");
+            }
+            if (args[5] == "s") {
+                hospital.patients.admitPatient(id, name, age, "severe", "", "");
+                hospital.beds.allocateBed(id);
+            } else if (args[5] == "ns") {
+                requireArgs(args, 8, "patient admit <id> <name> <age> ns <doctor#> <time#>");
+                int doctorIndex = parseIntArgument(args[6]) - 1;
+                string appointmentTime;
+                if (!hospital.doctors.bookAppointment(doctorIndex, parseIntArgument(args[7]), appointmentTime)) {
+                    throw invalid_argument("Requested appointment time is not available.");
+                }
+                hospital.patients.admitPatient(id, name, age, "not_severe", hospital.doctors.getDoctorName(doctorIndex), appointmentTime);
+            } else {
+                throw invalid_argument("Condition must be 's' or 'ns'.");
+            }
+        } else if (action == "find") {
+            requireArgs(args, 3, "patient find <id>");
+            int id = parseIntArgument(args[2]);
+            Patient* patient = hospital.patients.searchPatientByID(id);
+            if (patient) {
+                cout << "ID: " << patient->id << ", Name: " << patient->name
+                     << ", Age: " << patient->age << ", Condition: " << patient->condition
+                     << ", Doctor: " << patient->doctorName
+                     << ", Appointment: " << patient->appointmentTime << "\n";
+            } else {
+                cout << "Patient with ID " << id << " not found.\n";
+            }
+        } else if (action == "discharge") {
+            requireArgs(args, 3, "patient discharge <id>");
+            int id = parseIntArgument(args[2]);
+            if (!hospital.patients.dischargePatient(id)) {
+                throw invalid_argument("Patient with ID " + args[2] + " not found.");
+            }
+            hospital.beds.dischargePatient(id);
+        } else if (action == "list") {
+            hospital.patients.displayPatients();
+        } else if (action == "census") {
+            hospital.patients.displayCensus();
+        } else if (action == "import") {
+            requireArgs(args, 3, "patient import <csv-or-tsv-file>");
+            importFile(args[2], "patients", [&](istream& in, const string& path, char delimiter) {
+                return importPatients(hospital.patients, in, path, delimiter);
+            });
+        } else {
+            throw invalid_argument("Unknown patient command '" + action + "'.");
+        }
+    }
+
+    void bedCommand(const vector<string>& args) {
+        requireArgs(args, 2, "bed <add|allocate|release|stats> ...");
+        const string& action = args[1];
+        if (action == "stats") {
+            hospital.beds.displayWaitingStats();
+            return;
+        }
+        requireArgs(args, 3, "bed <add|allocate|release> <number> ...");
+        if (action == "add") {
+            int first = parseIntArgument(args[2]);
+            int last = args.size() > 3 ? parseIntArgument(args[3]) : first;
+            for (int bedNumber = first; bedNumber <= last; bedNumber++) {
+                hospital.beds.addBeds(bedNumber);
+            }
+        } else if (action == "allocate") {
+            hospital.beds.allocateBed(parseIntArgument(args[2]), args.size() > 3 && args[3] == "urgent");
+        } else if (action == "release") {
+            hospital.beds.releaseBed(parseIntArgument(args[2]));
+        } else {
+            throw invalid_argument("Unknown bed command '" + action + "'.");
+        }
+    }
+
+    void billCommand(const vector<string>& args) {
+        requireArgs(args, 2, "bill <add|pay-top|pay|find|list|settle|import> ...");
+        const string& action = args[1];
+        if (action == "add") {
+            requireArgs(args, 5, "bill add <patientId> <amount> <Card|Insurance|Cash>");
+            if (!isValidPaymentMethod(args[4])) {
+                throw invalid_argument("Invalid payment method '" + args[4] + "'.");
+            }
+            hospital.billing.addBillingRecord(parseIntArgument(args[2]), parseDoubleArgument(args[3]), args[4]);
+        } else if (action == "pay-top") {
+            hospital.billing.markAsPaid();
+        } else if (action == "pay") {
+            requireArgs(args, 3, "bill pay <patientId>");
+            hospital.billing.markBillAsPaidByID(parseIntArgument(args[2]));
+        } else if (action == "find") {
+            requireArgs(args, 3, "bill find <patientId>");
+            hospital.billing.searchBillByID(parseIntArgument(args[2]));
+        } else if (action == "list") {
+            hospital.billing.displayAllBills();
+        } else if (action == "settle") {
+            SettlementRules rules;
+            if (args.size() > 2) rules.insuranceCoverage = parseDoubleArgument(args[2]) / 100;
+            if (args.size() > 3) rules.cashDiscount = parseDoubleArgument(args[3]) / 100;
+            if (!settlementPool) {
+                settlementPool = make_unique<WorkerPool>(max(1u, thread::hardware_concurrency()));
+            }
+            BillingSystem::displaySettlement(hospital.billing.settleAll(rules, settlementPool.get()));
+        } else if (action == "import") {
+            requireArgs(args, 3, "bill import <csv-or-tsv-file>");
+            importFile(args[2], "bills", [&](istream& in, const string& path, char delimiter) {
+                return importBills(hospital.billing, in, path, delimiter);
+            });
+        } else {
+            throw invalid_argument("Unknown bill command '" + action + "'.");
+        }
+    }
+
+    void recordCommand(const vector<string>& args) {
+        requireArgs(args, 2, "record <add|find|update|delete|list|search|import> ...");
+        const string& action = args[1];
+        if (action == "add") {
+            requireArgs(args, 8, "record add <patientId> <name> <age> <history> <prescriptions> <notes>");
+            hospital.medical.addRecord(parseIntArgument(args[2]), args[3], parseIntArgument(args[4]), args[5], args[6], args[7]);
+        } else if (action == "find") {
+            requireArgs(args, 3, "record find <patientId>");
+            hospital.medical.searchRecord(parseIntArgument(args[2]));
+        } else if (action == "update") {
+            requireArgs(args, 5, "record update <patientId> <prescriptions> <notes>");
+            hospital.medical.updateRecord(parseIntArgument(args[2]), args[3], args[4]);
+        } else if (action == "delete") {
+            requireArgs(args, 3, "record delete <patientId>");
+            hospital.medical.deleteRecord(parseIntArgument(args[2]));
+        } else if (action == "list") {
+            hospital.medical.displayRecords();
+        } else if (action == "search") {
+            requireArgs(args, 3, "record search <words...>");
+            string query;
+            for (size_t i = 2; i < args.size(); i++) {
+                query += args[i] + " ";
+            }
+            hospital.medical.displaySearchResults(query);
+        } else if (action == "import") {
+            requireArgs(args, 3, "record import <csv-or-tsv-file>");
+            importFile(args[2], "records", [&](istream& in, const string& path, char delimiter) {
+                return importMedicalRecords(hospital.medical, in, path, delimiter);
+            });
+        } else {
+            throw invalid_argument("Unknown record command '" + action + "'.");
+        }
+    }
+
+    void doctorCommand(const vector<string>& args) {
+        requireArgs(args, 2, "doctor <list|book|cancel|rebook|earliest|soonest|add> ...");
+        const string& action = args[1];
+        if (action == "list") {
+            hospital.doctors.showDoctors();
+        } else if (action == "book") {
+            requireArgs(args, 4, "doctor book <doctor#> <time#>");
+            string appointmentTime;
+            if (!hospital.doctors.bookAppointment(parseIntArgument(args[2]) - 1, parseIntArgument(args[3]), appointmentTime)) {
+                throw invalid_argument("Requested appointment time is not available.");
+            }
+            cout << "Booked " << appointmentTime << "\n";
+        } else if (action == "cancel") {
+            requireArgs(args, 5, "doctor cancel <doctor#> <day> <HH:MM>");
+            SlotTime time = parseSlotTime(args[3], args[4]);
+            if (!hospital.doctors.cancelAppointment(parseIntArgument(args[2]) - 1, time)) {
+                throw invalid_argument("No booking at " + formatSlotTime(time) + ".");
+            }
+            cout << "Cancelled " << formatSlotTime(time) << "\n";
+        } else if (action == "rebook") {
+            requireArgs(args, 7, "doctor rebook <doctor#> <day> <HH:MM> <day> <HH:MM>");
+            SlotTime from = parseSlotTime(args[3], args[4]);
+            SlotTime to = parseSlotTime(args[5], args[6]);
+            if (!hospital.doctors.rebookAppointment(parseIntArgument(args[2]) - 1, from, to)) {
+                throw invalid_argument("Cannot move the booking at " + formatSlotTime(from) + " to " + formatSlotTime(to) + ".");
+            }
+            cout << "Moved to " << formatSlotTime(to) << "\n";
+        } else if (action == "earliest") {
+            requireArgs(args, 3, "doctor earliest <specialization> [<day> <HH:MM>]");
+            SlotTime after = args.size() >= 5 ? parseSlotTime(args[3], args[4]) : 0;
+            int doctorIndex;
+            string appointmentTime;
+            if (!hospital.doctors.bookEarliest(args[2], after, doctorIndex, appointmentTime)) {
+                throw invalid_argument("No free " + args[2] + " appointment.");
+            }
+            cout << "Booked " << hospital.doctors.getDoctorName(doctorIndex) << " at " << appointmentTime << "\n";
+        } else if (action == "soonest") {
+            requireArgs(args, 3, "doctor soonest <k> [specialization]");
+            int k = parseIntArgument(args[2]);
+            if (k <= 0) {
+                throw invalid_argument("k must be positive.");
+            }
+            hospital.doctors.showSoonest(k, args.size() > 3 ? args[3] : "");
+        } else if (action == "add") {
+            requireArgs(args, 6, "doctor add <name> <specialization> <day> <HH:MM> [<day> <HH:MM> ...]");
+            if (args.size() % 2 != 0) {
+                throw invalid_argument("Each working time needs a day and an HH:MM time.");
+            }
+            vector<SlotTime> weeklyHours;
+            for (size_t i = 4; i + 1 < args.size(); i += 2) {
+                weeklyHours.push_back(parseSlotTime(args[i], args[i + 1]));
+            }
+            int index = hospital.doctors.addDoctor(args[2], args[3], weeklyHours);
+            cout << "Added " << args[2] << " as doctor #" << index + 1 << "\n";
+        } else {
+            throw invalid_argument("Unknown doctor command '" + action + "'.");
+        }
+    }
+
+public:
+    CommandEngine(Hospital& hospital, Storage* storage = nullptr)
+        : hospital(hospital), storage(storage), commandCount(0), errorCount(0) {}
+
+    void execute(const vector<string>& args) {
+        if (args.empty()) return;
+
+        const string& subsystem = args[0];
+        if (subsystem == "staff") {
+            staffCommand(args);
+        } else if (subsystem == "patient") {
+            patientCommand(args);
+        } else if (subsystem == "bed") {
+            bedCommand(args);
+        } else if (subsystem == "bill") {
+            billCommand(args);
+        } else if (subsystem == "record") {
+            recordCommand(args);
+        } else if (subsystem == "doctor") {
+            doctorCommand(args);
+        } else if (subsystem == "checkpoint") {
+            if (!storage) {
+                throw invalid_argument("Persistence is not enabled (use --data <dir>).");
+            }
+            storage->checkpoint();
+        } else if (subsystem == "stats") {
+            writeMetrics(cout, hospital, args.size() > 1 && args[1] == "json");
+        } else {
+            throw invalid_argument("Unknown command '" + subsystem + "'.");
+        }
+    }
+
+    // Runs every line of the stream; a failing command is reported and the run continues
+    void run(istream& in) {
+        string line;
+        size_t lineNumber = 0;
+        while (true) {
+            // Group-committed log records are made durable before waiting on
+            // more input, so a pause in a piped stream never leaves them pending
+            if (storage && in.rdbuf()->in_avail() <= 0) storage->commit();
+            if (!getline(in, line)) break;
+            lineNumber++;
+            try {
+                vector<string> args = tokenizeCommand(line);
+                if (args.empty()) continue;
+                commandCount++;
+                execute(args);
+                if (storage) storage->checkpointIfDue();
+                if (metricsDumper) metricsDumper->dumpIfDue(hospital);
+            } catch (const exception& e) {
+                errorCount++;
+                cout << "Error (line " << lineNumber << "): " << e.what() << "\n";
+            }
+        }
+    }
+
+    void setMetricsDumper(MetricsDumper* dumper) {
+        metricsDumper = dumper;
+    }
+
+    size_t getCommandCount() const {
+        return commandCount;
+    }
+
+    size_t getErrorCount() const {
+        return errorCount;
+    }
+};
+
+// Audit file for a run: the one given with --audit, else hms.audit in the data directory
+string auditPathFor(const string& dataDirectory, const string& auditPath);
+
+// Passes the hospital's mutations on to a sink, behind the storage's write-ahead
+// log when there is one and through the caller's fanout otherwise
+void addMutationSink(Hospital& hospital, Storage* storage, MutationFanout& sinks, MutationLog* sink);
+
+// Starts auditing the hospital's mutations
+void attachAuditLog(Hospital& hospital, Storage* storage, MutationFanout& sinks, AuditLog& audit, const string& auditPath);
+
+struct ChangeFeedOptions {
+    string path; // Empty for no feed
+    ChangeFeedFormat format = ChangeFeedFormat::Json;
+};
+
+// Starts exporting the hospital's mutations to a change feed
+void attachChangeFeed(Hospital& hospital, Storage* storage, MutationFanout& sinks, ChangeFeed& feed, const ChangeFeedOptions& options);
+
+int runBatch(const string& path, const string& dataDirectory, const string& auditPath, const ChangeFeedOptions& changeFeed,
+             MetricsDumper* metricsDumper);
+
+// ================= Concurrent Service =================
+// Copies of a manager, each owning the IDs that hash to it and guarded by its
+// own shared_mutex: lookups on a shard share the lock, writes only block that shard.
+template <typename Manager>
+class ShardedManager {
+private:
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        Manager manager;
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    uint32_t shardBits;
+
+    // Fibonacci hashing spreads consecutive IDs over shards while keeping the
+    // IDs inside a shard well spread for the manager's own hash table
+    Shard& shardOf(int id) const {
+        if (shardBits == 0) return *shards[0];
+        return *shards[(static_cast<uint32_t>(id) * 2654435761u) >> (32 - shardBits)];
+    }
+
+public:
+    // The shard count is rounded up to a power of two
+    explicit ShardedManager(size_t shardCount) : shardBits(0) {
+        while ((size_t(1) << shardBits) < shardCount) shardBits++;
+        for (size_t i = 0; i < (size_t(1) << shardBits); i++) {
+            shards.push_back(make_unique<Shard>());
+        }
+    }
+
+    template <typename Function>
+    auto read(int id, Function function) const {
+        const Shard& shard = shardOf(id);
+        shared_lock<shared_mutex> guard(shard.lock);
+        return function(static_cast<const Manager&>(shard.manager));
+    }
+
+    template <typename Function>
+    auto write(int id, Function function) {
+        Shard& shard = shardOf(id);
+        unique_lock<shared_mutex> guard(shard.lock);
+        return function(shard.manager);
+    }
+
+    // Visits every shard under its read lock, one shard at a time
+    template <typename Function>
+    void forEach(Function function) const {
+        for (const unique_ptr<Shard>& shard : shards) {
+            shared_lock<shared_mutex> guard(shard->lock);
+            function(static_cast<const Manager&>(shard->manager));
+        }
+    }
+
+    // Visits every shard under its write lock, one shard at a time
+    template <typename Function>
+    void forEachWritable(Function function) {
+        for (unique_ptr<Shard>& shard : shards) {
+            unique_lock<shared_mutex> guard(shard->lock);
+            function(shard->manager);
+        }
+    }
+
+    size_t getShardCount() const {
+        return shards.size();
+    }
+};
+
+// Applies the mutations made through a HospitalService to a Hospital, one at a
+// time, so the hospital's own log (write-ahead log, audit log, change feed)
+// records them and its state stays current for checkpoints
+class HospitalWriteThrough : public MutationLog {
+private:
+    Hospital& hospital;
+    mutex lock;
+
+public:
+    explicit HospitalWriteThrough(Hospital& hospital) : hospital(hospital) {}
+
+    void append(MutationType type, const BinaryWriter& payload) override {
+        lock_guard<mutex> guard(lock);
+        BinaryReader in(payload.data().data(), payload.size());
+        applyMutation(hospital, type, in);
+    }
+
+    // Runs function on the hospital between two applied mutations
+    template <typename Function>
+    void run(Function function) {
+        lock_guard<mutex> guard(lock);
+        function(hospital);
+    }
+};
+
+enum class ServiceRequestType {
+    AddStaff,
+    RemoveStaff,
+    FindStaff,
+    AdmitPatient,
+    DischargePatient,
+    FindPatient,
+    AddBill,
+    AllocateBed,
+    ReleaseBed
+};
+
+// One request for HospitalService::submit; only the fields its type uses are read
+struct ServiceRequest {
+    ServiceRequestType type;
+    int id = 0;             // Staff ID, patient ID (also for bills and beds) or bed number for ReleaseBed
+    string name;            // AddStaff, AdmitPatient
+    string role;            // AddStaff
+    string department;      // AddStaff
+    string shift;           // AddStaff
+    int age = 0;            // AdmitPatient
+    string condition;       // AdmitPatient
+    double amount = 0;      // AddBill
+    string paymentMethod;   // AddBill
+    size_t desk = 0;        // AllocateBed
+};
+
+struct ServiceResult {
+    bool ok = false; // Whether the request changed or found something
+    int value = -1;  // AllocateBed: the bed given out; ReleaseBed: the patient who had it
+    string name;     // FindStaff, FindPatient
+};
+
+// Thread-safe front for the front desk, wards and billing office. Staff and
+// patients are sharded by ID; bills sit behind one reader/writer lock and beds
+// go through the lock-free allocator. Lookups hand the record to a callback
+// while the lock is held, so no pointer escapes. Requests can be called
+// directly or submitted to the service's own worker pool.
+class HospitalService {
+private:
+    ShardedManager<StaffManagement> staff;
+    ShardedManager<PatientList> patients;
+    BillingSystem billing;
+    mutable shared_mutex billingLock;
+    unique_ptr<ConcurrentBedAllocator> beds;
+    unique_ptr<HospitalWriteThrough> writeThrough;
+    unique_ptr<WorkerPool> dispatcher; // Last, so queued requests finish before the managers go
+    static const size_t wordsPerDesk = 8; // Desks start scanning 512 beds apart
+
+public:
+    // workerCount 0 uses one dispatch thread per hardware thread
+    explicit HospitalService(size_t shardCount = 64, size_t workerCount = 0)
+        : staff(shardCount), patients(shardCount),
+          dispatcher(make_unique<WorkerPool>(workerCount ? workerCount : max(1u, thread::hardware_concurrency()))) {}
+
+    // Serves the hospital's staff, patients and bills and writes every later
+    // change through to it, so it reaches the hospital's storage and mutation
+    // sinks. Call once on a fresh service, before dispatching requests; beds
+    // follow openWard/syncWard. Use withHospital to touch the hospital (e.g. to
+    // checkpoint) while requests are in flight.
+    void attach(Hospital& hospital) {
+        hospital.patients.forEach([&](const Patient& patient) {
+            patients.write(patient.id, [&](PatientList& shard) {
+                return shard.insertPatient(patient.id, patient.name, patient.age, patient.condition.str(), patient.doctorName.str(),
+                                           patient.appointmentTime.str());
+            });
+        });
+        for (const Staff* member : hospital.staff.queryStaff("", "", "")) {
+            addStaff(member->id, member->name, member->role.str(), member->department.str(), member->shift.str());
+        }
+        {
+            unique_lock<shared_mutex> guard(billingLock);
+            billing = hospital.billing;
+        }
+        writeThrough = make_unique<HospitalWriteThrough>(hospital);
+        MutationLog* log = writeThrough.get();
+        staff.forEachWritable([&](StaffManagement& shard) { shard.setMutationLog(log); });
+        patients.forEachWritable([&](PatientList& shard) { shard.setMutationLog(log); });
+        unique_lock<shared_mutex> guard(billingLock);
+        billing.setMutationLog(log);
+    }
+
+    template <typename Function>
+    void withHospital(Function function) {
+        if (!writeThrough) {
+            throw logic_error("No hospital is attached to the service.");
+        }
+        writeThrough->run(function);
+    }
+
+    // Runs the request on the worker pool. Requests run concurrently, so wait
+    // for a request's future before submitting one that depends on it.
+    future<ServiceResult> submit(ServiceRequest request) {
+        auto result = make_shared<promise<ServiceResult>>();
+        future<ServiceResult> pending = result->get_future();
+        dispatcher->submit([this, result, request = move(request)] {
+            try {
+                result->set_value(execute(request));
+            } catch (...) {
+                result->set_exception(current_exception());
+            }
+        });
+        return pending;
+    }
+
+    // Runs the request on the calling thread
+    ServiceResult execute(const ServiceRequest& request) {
+        ServiceResult result;
+        switch (request.type) {
+            case ServiceRequestType::AddStaff:
+                result.ok = addStaff(request.id, request.name, request.role, request.department, request.shift);
+                break;
+            case ServiceRequestType::RemoveStaff:
+                result.ok = removeStaff(request.id);
+                break;
+            case ServiceRequestType::FindStaff:
+                result.ok = readStaff(request.id, [&](const Staff& member) { result.name = member.name; });
+                break;
+            case ServiceRequestType::AdmitPatient:
+                result.ok = admitPatient(request.id, request.name, request.age, request.condition);
+                break;
+            case ServiceRequestType::DischargePatient:
+                result.ok = dischargePatient(request.id);
+                break;
+            case ServiceRequestType::FindPatient:
+                result.ok = readPatient(request.id, [&](const Patient& patient) { result.name = patient.name; });
+                break;
+            case ServiceRequestType::AddBill:
+                addBill(request.id, request.amount, request.paymentMethod);
+                result.ok = true;
+                break;
+            case ServiceRequestType::AllocateBed:
+                result.value = allocateBed(request.id, request.desk);
+                result.ok = result.value != -1;
+                break;
+            case ServiceRequestType::ReleaseBed:
+                result.value = releaseBed(request.id);
+                result.ok = result.value != -1;
+                break;
+        }
+        return result;
+    }
+
+    bool addStaff(int id, const string& name, const string& role, const string& department, const string& shift) {
+        return staff.write(id, [&](StaffManagement& shard) { return shard.insertStaff(id, name, role, department, shift); });
+    }
+
+    bool removeStaff(int id) {
+        return staff.write(id, [&](StaffManagement& shard) { return shard.removeStaff(id); });
+    }
+
+    template <typename Function>
+    bool readStaff(int id, Function function) const {
+        return staff.read(id, [&](const StaffManagement& shard) {
+            const Staff* member = shard.findStaff(id);
+            if (member) function(*member);
+            return member != nullptr;
+        });
+    }
+
+    // IDs of the staff matching every given attribute; empty values match anything
+    vector<int> queryStaff(const string& role, const string& department, const string& shift) const {
+        vector<int> ids;
+        staff.forEach([&](const StaffManagement& shard) {
+            for (const Staff* member : shard.queryStaff(role, department, shift)) {
+                ids.push_back(member->id);
+            }
+        });
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    size_t getStaffCount() const {
+        size_t count = 0;
+        staff.forEach([&](const StaffManagement& shard) { count += shard.size(); });
+        return count;
+    }
+
+    bool admitPatient(int id, const string& name, int age, const string& condition) {
+        return patients.write(id, [&](PatientList& shard) { return shard.insertPatient(id, name, age, condition); });
+    }
+
+    bool dischargePatient(int id) {
+        return patients.write(id, [&](PatientList& shard) { return shard.dischargePatient(id); });
+    }
+
+    template <typename Function>
+    bool readPatient(int id, Function function) const {
+        return patients.read(id, [&](const PatientList& shard) {
+            const Patient* patient = shard.searchPatientByID(id);
+            if (patient) function(*patient);
+            return patient != nullptr;
+        });
+    }
+
+    size_t getPatientCount() const {
+        size_t count = 0;
+        patients.forEach([&](const PatientList& shard) { count += shard.size(); });
+        return count;
+    }
+
+    void addBill(int patientID, double amount, const string& paymentMethod) {
+        unique_lock<shared_mutex> guard(billingLock);
+        billing.mergeBill(patientID, amount, paymentMethod);
+    }
+
+    template <typename Function>
+    bool readPendingBill(int patientID, Function function) const {
+        shared_lock<shared_mutex> guard(billingLock);
+        const BillingRecord* record = billing.findPendingBill(patientID);
+        if (record) function(*record);
+        return record != nullptr;
+    }
+
+    // Takes over the ward's beds and occupancy; call before dispatching requests.
+    // The ward itself is not updated until syncWard or closeWard.
+    void openWard(const BedManagement& ward) {
+        beds = make_unique<ConcurrentBedAllocator>(ward.getOccupancy());
+    }
+
+    // Writes the allocator's occupancy back to the ward (tree, patient map,
+    // waiting list and mutation log); call while no bed requests are in flight.
+    // Returns how many beds changed.
+    size_t syncWard(BedManagement& ward) {
+        return beds ? ward.applyOccupancy(beds->getOccupancy()) : 0;
+    }
+
+    // Syncs the ward and hands bed requests back to it
+    size_t closeWard(BedManagement& ward) {
+        size_t changed = syncWard(ward);
+        beds.reset();
+        return changed;
+    }
+
+    // Lowest free bed from the desk's starting word on, or -1 if the ward is full
+    int allocateBed(int patientId, size_t desk = 0) {
+        if (!beds) return -1;
+        return beds->allocate(patientId, desk * wordsPerDesk);
+    }
+
+    int releaseBed(int bedNumber) {
+        return beds ? beds->release(bedNumber) : -1;
+    }
+
+    int getFreeBeds() const {
+        return beds ? beds->getFreeBeds() : 0;
+    }
+
+    size_t getShardCount() const {
+        return staff.getShardCount();
+    }
+};
+
+#endif // HOSPITAL_MANAGEMENT_SYSTEM_H
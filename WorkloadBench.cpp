@@ -0,0 +1,405 @@
+#include "HospitalManagementSystem.h"
+
+// ================= Workload Generators =================
+// Every generator draws from a 64-bit Mersenne Twister and converts the raw
+// output itself, so a seed produces the same operation stream on every platform.
+double uniformUnit(mt19937_64& rng) {
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+// Ranks 1..n where rank r is drawn with probability proportional to 1/r^theta
+// (Gray et al., "Quickly generating billion-record synthetic databases").
+class ZipfGenerator {
+private:
+    uint64_t n;
+    double theta, alpha, zetan, eta;
+
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; i++) {
+            sum += 1.0 / pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+public:
+    ZipfGenerator(uint64_t n, double theta = 0.99) : n(n), theta(theta) {
+        if (n < 2 || theta <= 0 || theta == 1) {
+            throw invalid_argument("Zipf needs at least two items and a skew other than 0 or 1.");
+        }
+        alpha = 1.0 / (1.0 - theta);
+        zetan = zeta(n, theta);
+        eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+    }
+
+    uint64_t next(mt19937_64& rng) const {
+        double u = uniformUnit(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 1;
+        if (uz < 1.0 + pow(0.5, theta)) return 2;
+        return 1 + min<uint64_t>(n - 1, static_cast<uint64_t>(n * pow(eta * u - eta + 1.0, alpha)));
+    }
+};
+
+// Admissions arrive in bursts: mostly small groups, with an occasional surge
+// (a bus crash, a flu wave) that is ten times larger than usual
+class BurstGenerator {
+private:
+    double meanBurst, surgeChance;
+
+public:
+    BurstGenerator(double meanBurst, double surgeChance) : meanBurst(meanBurst), surgeChance(surgeChance) {}
+
+    size_t next(mt19937_64& rng) const {
+        double mean = uniformUnit(rng) < surgeChance ? meanBurst * 10 : meanBurst;
+        // Geometric burst size with the chosen mean
+        return 1 + static_cast<size_t>(-log(1.0 - uniformUnit(rng)) * (mean - 1));
+    }
+};
+
+// ================= Workload Runner =================
+struct OperationStats {
+    string name;
+    LatencyHistogram latency;
+    double seconds = 0;
+};
+
+struct WorkloadReport {
+    string name;
+    size_t operations = 0;
+    double seconds = 0;
+    vector<OperationStats> results;
+};
+
+// Times each call separately so percentiles come from real per-call latencies.
+// Two clock reads (~40 ns) are included in every sample.
+class WorkloadRecorder {
+private:
+    WorkloadReport report;
+    unordered_map<string, size_t> slots;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit WorkloadRecorder(const string& name) {
+        report.name = name;
+        start = chrono::steady_clock::now();
+    }
+
+    template <typename Operation>
+    auto time(const string& name, Operation operation) -> decltype(operation()) {
+        auto found = slots.find(name);
+        if (found == slots.end()) {
+            found = slots.emplace(name, report.results.size()).first;
+            report.results.push_back(OperationStats{name, LatencyHistogram(), 0});
+        }
+        OperationStats& stats = report.results[found->second];
+        struct Sample {
+            OperationStats& stats;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            ~Sample() {
+                auto nanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+                stats.latency.record(static_cast<uint64_t>(nanoseconds));
+                stats.seconds += nanoseconds * 1e-9;
+            }
+        } sample{stats};
+        return operation();
+    }
+
+    WorkloadReport finish() {
+        report.seconds = elapsedSeconds(start);
+        for (const OperationStats& stats : report.results) {
+            report.operations += stats.latency.getCount();
+        }
+        return report;
+    }
+};
+
+struct WorkloadOptions {
+    uint64_t seed = 42;
+    double scale = 1.0;
+
+    size_t scaled(size_t count) const {
+        return max<size_t>(1, static_cast<size_t>(count * scale));
+    }
+};
+
+const vector<string> roles = {"doctor", "nurses", "paramedics", "janitors"};
+const vector<string> shifts = {"morning", "evening", "night"};
+const vector<string> departments = {"Cardiology", "Neurology", "Oncology", "Pediatrics", "Radiology", "Surgery",
+                                    "Emergency", "Orthopedics", "Dermatology", "Psychiatry", "Urology", "Pulmonology"};
+const vector<string> specializations = {"Cardiologist", "Dermatologist", "Neurologist", "Orthopedist",
+                                        "Pediatrician", "Oncologist", "Gastroenterologist"};
+
+// Hot patients come back again and again: lookups, chart reads and new chart
+// entries all pick patient IDs from a Zipf distribution over the census
+WorkloadReport runZipfPatients(const WorkloadOptions& options) {
+    mt19937_64 rng(options.seed);
+    size_t census = options.scaled(100000), operations = options.scaled(1000000);
+    ZipfGenerator patientIds(census);
+    PatientList patients;
+    MedicalSystem medical;
+    medical.reserve(census);
+    for (size_t id = 1; id <= census; id++) {
+        patients.admitPatient(static_cast<int>(id), "Patient", 20 + id % 70, id % 3 ? "not_severe" : "severe");
+        medical.addRecord(static_cast<int>(id), "Patient", 20 + id % 70, "Admission", "Paracetamol", "Stable");
+    }
+
+    WorkloadRecorder recorder("zipf-patients");
+    size_t found = 0;
+    for (size_t i = 0; i < operations; i++) {
+        int id = static_cast<int>(patientIds.next(rng));
+        uint64_t pick = rng() % 100;
+        if (pick < 60) {
+            found += recorder.time("PatientList.searchPatientByID", [&] { return patients.searchPatientByID(id); }) != nullptr;
+        } else if (pick < 85) {
+            found += recorder.time("MedicalSystem.findRecord", [&] { return medical.findRecord(id); }) != nullptr;
+        } else if (pick < 95) {
+            recorder.time("MedicalSystem.addRecord", [&] { medical.addRecord(id, "Patient", 40, "Follow-up", "Ibuprofen", "Improving"); });
+        } else {
+            // Discharge and readmit under the same ID so the census stays constant
+            recorder.time("PatientList.dischargePatient", [&] { return patients.dischargePatient(id); });
+            recorder.time("PatientList.admitPatient", [&] { return patients.admitPatient(id, "Patient", 40, "severe"); });
+        }
+    }
+    if (found == 0) {
+        cerr << "warning: zipf-patients found no patients" << endl;
+    }
+    return recorder.finish();
+}
+
+// Admissions arrive in bursts while discharges drain at a steady rate. Each
+// admission takes a patient record and a bed; stable patients also book the
+// earliest appointment with a specialist.
+WorkloadReport runAdmissionBurst(const WorkloadOptions& options) {
+    mt19937_64 rng(options.seed);
+    size_t admissions = options.scaled(200000);
+    int bedCount = static_cast<int>(options.scaled(5000));
+    const int scheduleWeeks = 52;
+    BurstGenerator bursts(40, 0.02);
+    PatientList patients;
+    BedManagement beds;
+    DoctorManagement doctors(scheduleWeeks);
+    for (int bed = 1; bed <= bedCount; bed++) {
+        beds.addBeds(bed);
+    }
+    int doctorCount = static_cast<int>(options.scaled(100));
+    for (int d = 0; d < doctorCount; d++) {
+        vector<SlotTime> weeklyHours;
+        for (uint32_t day = 0; day < 5; day++) {
+            for (int hour = 9; hour < 13; hour++) {
+                weeklyHours.push_back(makeSlotTime(day, hour + d % 4, 0));
+            }
+        }
+        doctors.addDoctor("Dr. " + to_string(d), specializations[d % specializations.size()], weeklyHours);
+    }
+
+    WorkloadRecorder recorder("admission-burst");
+    deque<int> inHospital;
+    const SlotTime horizon = scheduleWeeks * 7 * slotsPerDay;
+    int nextId = 1;
+    while (static_cast<size_t>(nextId) <= admissions) {
+        size_t burst = min(bursts.next(rng), admissions - nextId + 1);
+        for (size_t i = 0; i < burst; i++, nextId++) {
+            int id = nextId;
+            bool severe = rng() % 4 == 0;
+            recorder.time("PatientList.admitPatient", [&] { return patients.admitPatient(id, "Patient", 40, severe ? "severe" : "not_severe"); });
+            recorder.time("BedManagement.allocateBed", [&] { return beds.allocateBed(id, severe); });
+            if (!severe) {
+                // The simulated clock moves through the schedule as admissions accumulate
+                SlotTime now = static_cast<SlotTime>(uint64_t(horizon) * id / (admissions + 1));
+                int doctorIndex;
+                string appointmentTime;
+                const string& wanted = specializations[rng() % specializations.size()];
+                recorder.time("DoctorManagement.bookEarliest", [&] { return doctors.bookEarliest(wanted, now, doctorIndex, appointmentTime); });
+            }
+            inHospital.push_back(id);
+        }
+        // Steady discharges: a bit more than the average arrival rate, so surges drain
+        size_t discharges = min(inHospital.size(), size_t(45));
+        for (size_t i = 0; i < discharges; i++) {
+            int id = inHospital.front();
+            inHospital.pop_front();
+            recorder.time("BedManagement.dischargePatient", [&] { return beds.dischargePatient(id); });
+            recorder.time("PatientList.dischargePatient", [&] { return patients.dischargePatient(id); });
+        }
+    }
+    return recorder.finish();
+}
+
+// A month of charges against a Zipf-skewed set of accounts, a trickle of
+// mid-month payments, then the month-end settlement run. Repeated for several months.
+WorkloadReport runBillingMonthEnd(const WorkloadOptions& options) {
+    mt19937_64 rng(options.seed);
+    size_t accounts = options.scaled(100000), chargesPerMonth = options.scaled(500000);
+    const int months = 3;
+    const vector<string> methods = {"Card", "Insurance", "Cash"};
+    ZipfGenerator accountIds(accounts, 0.8);
+    BillingSystem billing;
+    SettlementRules rules;
+    rules.cashDiscount = 0.05;
+
+    WorkloadRecorder recorder("billing-month-end");
+    for (int month = 0; month < months; month++) {
+        for (size_t i = 0; i < chargesPerMonth; i++) {
+            int id = static_cast<int>(accountIds.next(rng));
+            if (rng() % 20 == 0) {
+                recorder.time("BillingSystem.markBillAsPaidByID", [&] { billing.markBillAsPaidByID(id); });
+            } else {
+                double amount = 50 + rng() % 5000;
+                const string& method = methods[rng() % methods.size()];
+                recorder.time("BillingSystem.addBillingRecord", [&] { billing.addBillingRecord(id, amount, method); });
+            }
+        }
+        recorder.time("BillingSystem.settleAll", [&] { return billing.settleAll(rules); });
+    }
+    return recorder.finish();
+}
+
+// Shift changes: staff leave and are replaced under new IDs while the desk
+// keeps looking people up and building rosters by role, department and shift
+WorkloadReport runRosterChurn(const WorkloadOptions& options) {
+    mt19937_64 rng(options.seed);
+    size_t headcount = options.scaled(50000), operations = options.scaled(500000);
+    StaffManagement staff;
+    vector<int> employed;
+    int nextId = 1;
+    for (; static_cast<size_t>(nextId) <= headcount; nextId++) {
+        staff.addStaff(nextId, "Staff", roles[rng() % roles.size()], departments[rng() % departments.size()], shifts[rng() % shifts.size()]);
+        employed.push_back(nextId);
+    }
+
+    WorkloadRecorder recorder("roster-churn");
+    size_t found = 0;
+    for (size_t i = 0; i < operations; i++) {
+        uint64_t pick = rng() % 100;
+        if (pick < 50) {
+            int id = employed[rng() % employed.size()];
+            found += recorder.time("StaffManagement.findStaff", [&] { return staff.findStaff(id); }) != nullptr;
+        } else if (pick < 60) {
+            // One-, two- and three-attribute roster queries in equal measure
+            string role = roles[rng() % roles.size()], department = departments[rng() % departments.size()];
+            string shift = shifts[rng() % shifts.size()];
+            if (pick % 3 == 1) shift.clear();
+            if (pick % 3 == 2) department.clear(), shift.clear();
+            found += recorder.time("StaffManagement.queryStaff", [&] { return staff.queryStaff(role, department, shift); }).size();
+        } else {
+            size_t slot = rng() % employed.size();
+            int leaving = employed[slot], joining = nextId++;
+            recorder.time("StaffManagement.removeStaff", [&] { return staff.removeStaff(leaving); });
+            const string& role = roles[rng() % roles.size()];
+            const string& department = departments[rng() % departments.size()];
+            const string& shift = shifts[rng() % shifts.size()];
+            recorder.time("StaffManagement.addStaff", [&] { return staff.addStaff(joining, "Staff", role, department, shift); });
+            employed[slot] = joining;
+        }
+    }
+    if (found == 0) {
+        cerr << "warning: roster-churn found no staff" << endl;
+    }
+    return recorder.finish();
+}
+
+// ================= Results =================
+string jsonEscape(const string& value) {
+    string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void printReport(const WorkloadReport& report) {
+    cout << report.name << ": " << report.operations << " ops in " << report.seconds << " s ("
+         << (report.seconds > 0 ? report.operations / report.seconds : 0) << " ops/s)" << endl;
+    for (const OperationStats& stats : report.results) {
+        cout << "  " << left << setw(36) << stats.name << right << setw(10) << stats.latency.getCount() << " ops "
+             << setw(12) << static_cast<uint64_t>(stats.seconds > 0 ? stats.latency.getCount() / stats.seconds : 0) << " ops/s"
+             << "  p50 " << setw(8) << stats.latency.percentile(50) << " ns  p99 " << setw(9) << stats.latency.percentile(99) << " ns" << endl;
+    }
+}
+
+// {"seed":..,"scale":..,"workloads":[{"name":..,"operations":..,"seconds":..,"opsPerSecond":..,
+//   "results":[{"operation":..,"count":..,"seconds":..,"opsPerSecond":..,"p50Ns":..,"p99Ns":..,"maxNs":..,"meanNs":..}]}]}
+void writeJsonReports(ostream& out, const WorkloadOptions& options, const vector<WorkloadReport>& reports) {
+    out << "{\"seed\":" << options.seed << ",\"scale\":" << options.scale << ",\"workloads\":[";
+    for (size_t w = 0; w < reports.size(); w++) {
+        const WorkloadReport& report = reports[w];
+        out << (w ? "," : "") << "\n{\"name\":\"" << jsonEscape(report.name) << "\",\"operations\":" << report.operations
+            << ",\"seconds\":" << report.seconds << ",\"opsPerSecond\":" << (report.seconds > 0 ? report.operations / report.seconds : 0)
+            << ",\"results\":[";
+        for (size_t i = 0; i < report.results.size(); i++) {
+            const OperationStats& stats = report.results[i];
+            out << (i ? "," : "") << "\n  {\"operation\":\"" << jsonEscape(stats.name) << "\",\"count\":" << stats.latency.getCount()
+                << ",\"seconds\":" << stats.seconds
+                << ",\"opsPerSecond\":" << (stats.seconds > 0 ? stats.latency.getCount() / stats.seconds : 0)
+                << ",\"p50Ns\":" << stats.latency.percentile(50) << ",\"p99Ns\":" << stats.latency.percentile(99)
+                << ",\"maxNs\":" << stats.latency.getMax() << ",\"meanNs\":" << stats.latency.getMean() << "}";
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
+
+// ================= Main =================
+int main(int argc, char* argv[]) {
+    const vector<pair<string, WorkloadReport (*)(const WorkloadOptions&)>> workloads = {
+        {"zipf-patients", runZipfPatients},
+        {"admission-burst", runAdmissionBurst},
+        {"billing-month-end", runBillingMonthEnd},
+        {"roster-churn", runRosterChurn},
+    };
+    WorkloadOptions options;
+    string selected = "all", jsonPath;
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc) {
+                options.seed = static_cast<uint64_t>(parseIntArgument(argv[++i]));
+            } else if (arg == "--scale" && i + 1 < argc) {
+                options.scale = parseDoubleArgument(argv[++i]);
+                if (options.scale <= 0) throw invalid_argument("Scale must be positive.");
+            } else if (arg == "--workload" && i + 1 < argc) {
+                selected = argv[++i];
+            } else if (arg == "--json" && i + 1 < argc) {
+                jsonPath = argv[++i];
+            } else {
+                cerr << "Usage: hms_bench [--workload all|zipf-patients|admission-burst|billing-month-end|roster-churn]"
+                     << " [--seed N] [--scale X] [--json FILE|-]" << endl;
+                return 1;
+            }
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    vector<WorkloadReport> reports;
+    for (const auto& workload : workloads) {
+        if (selected != "all" && selected != workload.first) continue;
+        // Managers report to the console; keep that out of the timings and the results
+        ofstream nullOutput;
+        streambuf* previous = cout.rdbuf(nullOutput.rdbuf());
+        WorkloadReport report = workload.second(options);
+        cout.rdbuf(previous);
+        if (jsonPath != "-") printReport(report);
+        reports.push_back(report);
+    }
+    if (reports.empty()) {
+        cerr << "Unknown workload: " << selected << endl;
+        return 1;
+    }
+
+    if (jsonPath == "-") {
+        writeJsonReports(cout, options, reports);
+    } else if (!jsonPath.empty()) {
+        ofstream out(jsonPath);
+        if (!out) {
+            cerr << "Error: cannot write " << jsonPath << endl;
+            return 1;
+        }
+        writeJsonReports(out, options, reports);
+        cout << "Results written to " << jsonPath << endl;
+    }
+    return 0;
+}
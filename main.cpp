@@ -0,0 +1,423 @@
+#include "HospitalManagementSystem.h"
+#include "Benchmarks.h"
+
+// ================= Main System =================
+int main(int argc, char* argv[]) {
+    string batchPath;
+    string auditPath;
+    ChangeFeedOptions changeFeed;
+    string metricsPath;
+    double metricsInterval = 10;
+    string dataDirectory = "hms_data";
+    bool dataDirectoryGiven = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--data" && i + 1 < argc) {
+            dataDirectory = argv[++i];
+            dataDirectoryGiven = true;
+        } else if (arg == "--in-memory") {
+            dataDirectory.clear();
+            dataDirectoryGiven = true;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            return runBenchmark(argv[++i]);
+        } else if (arg == "--convert-csv" && i + 2 < argc) {
+            return convertCsvToSnapshot(argv[i + 1], argv[i + 2]);
+        } else if (arg == "--snapshot-info" && i + 1 < argc) {
+            return printSnapshotInfo(argv[++i]);
+        } else if (arg == "--audit" && i + 1 < argc) {
+            auditPath = argv[++i];
+        } else if (arg == "--audit-dump" && i + 1 < argc) {
+            return printAuditLog(argv[++i]);
+        } else if (arg == "--cdc" && i + 1 < argc) {
+            changeFeed.path = argv[++i];
+        } else if (arg == "--cdc-format" && i + 1 < argc) {
+            try {
+                changeFeed.format = parseChangeFeedFormat(argv[++i]);
+            } catch (const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+                return 1;
+            }
+        } else if (arg == "--cdc-read" && i + 2 < argc) {
+            return printChangeFeed(argv[i + 1], argv[i + 2]);
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            metricsInterval = atof(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--data <dir> | --in-memory] [--audit <file>] [--cdc <file|fifo> [--cdc-format json|binary]]\n"
+                 << "       " << string(strlen(argv[0]), ' ') << " [--metrics <file> [--metrics-interval <seconds>]]\n"
+                 << "       " << argv[0] << " [options] [--batch <file|->] [--bench <name>]\n"
+                 << "       " << argv[0] << " --convert-csv <csv-dir> <snapshot-file>\n"
+                 << "       " << argv[0] << " --snapshot-info <snapshot-file>\n"
+                 << "       " << argv[0] << " --audit-dump <audit-file>\n"
+                 << "       " << argv[0] << " --cdc-read <feed-file> <cursor-file|->" << endl;
+            return 1;
+        }
+    }
+    unique_ptr<MetricsDumper> metricsDumper;
+    if (!metricsPath.empty()) {
+        metricsDumper.reset(new MetricsDumper(metricsPath, metricsInterval));
+    }
+    if (!batchPath.empty()) {
+        // Batch runs are in-memory unless a data directory is named explicitly
+        return runBatch(batchPath, dataDirectoryGiven ? dataDirectory : "", auditPath, changeFeed, metricsDumper.get());
+    }
+
+    Hospital hospital;
+    PatientList& patientList = hospital.patients;
+    BillingSystem& billingSystem = hospital.billing;
+    MedicalSystem& medicalSystem = hospital.medical;
+    BedManagement& bedManagement = hospital.beds;
+    StaffManagement& staffManagement = hospital.staff;
+    DoctorManagement& doctorManagement = hospital.doctors;
+
+    AuditLog audit;
+    ChangeFeed feed;
+    MutationFanout sinks;
+    unique_ptr<WorkerPool> settlementPool; // Shared by every settlement run in this session
+    unique_ptr<Storage> storage;
+    if (!dataDirectory.empty()) {
+        try {
+            storage.reset(new Storage(hospital, dataDirectory));
+            storage->recover();
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+    try {
+        attachAuditLog(hospital, storage.get(), sinks, audit, auditPathFor(dataDirectory, auditPath));
+        attachChangeFeed(hospital, storage.get(), sinks, feed, changeFeed);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    int choice;
+    do {
+        if (storage) storage->checkpointIfDue();
+        if (metricsDumper) metricsDumper->dumpIfDue(hospital);
+
+        cout << "\nWelcome to Hospital Management System\n";
+        cout << "1. Manage Staff\n";
+        cout << "2. Manage Patients\n";
+        cout << "3. Manage Medical Records\n";
+        cout << "4. Manage Billing\n";
+        cout << "5. Exit\n";
+        choice = getValidatedInt("Enter your choice: ");
+
+        switch (choice) {
+            case 1: {
+                int choice;
+                do {
+                    cout << "\n----Staff Management System----\n";
+                    cout << "1. Add Staff\n";
+                    cout << "2. Display Staff\n";
+                    cout << "3. Search Staff\n";
+                    cout << "4. Delete Staff\n";
+                    cout << "5. Find Staff by Role/Department/Shift\n";
+                    cout << "6. Import Staff from CSV/TSV\n";
+                    cout << "7. Back to Main Menu\n";
+                    choice = getValidatedInt("Enter your choice: ");
+                    
+                    switch (choice) {
+                        case 1: {
+                            int id = getValidatedInt("Enter ID: ");
+                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
+                            string name = getValidatedString("Enter Name: ");
+                            string role = getValidatedRole("Enter Role: ");
+                            string department = getValidatedString("Enter Department: ");
+                            string shift = getValidatedString("Enter Shift: ");
+                            try {
+                                staffManagement.addStaff(id, name, role, department, shift);
+                                cout << "Staff added successfully." << endl;
+                            } catch (const exception& e) {
+                                cout << "Error: " << e.what() << endl;
+                            }
+                            break;
+                        }
+                        case 2:
+                            staffManagement.displayStaff();
+                            break;
+                        case 3: {
+                            int id = getValidatedInt("Enter ID to search: ");
+                            staffManagement.searchStaff(id);
+                            break;
+                        }
+                        case 4: {
+                            int id = getValidatedInt("Enter ID to delete: ");
+                            staffManagement.deleteStaff(id);
+                            break;
+                        }
+                        case 5: {
+                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
+                            string role = getValidatedString("Enter Role (* for any): ");
+                            string department = getValidatedString("Enter Department (* for any): ");
+                            string shift = getValidatedString("Enter Shift (* for any): ");
+                            staffManagement.displayStaffQuery(role == "*" ? "" : role, department == "*" ? "" : department,
+                                                              shift == "*" ? "" : shift);
+                            break;
+                        }
+                        case 6: {
+                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
+                            cout << "Enter file path (id,name,role,department,shift; .tsv for tab-separated): ";
+                            string path;
+                            getline(cin, path);
+                            ifstream in(path, ios::binary);
+                            if (!in) {
+                                cout << "Cannot open " << path << ".\n";
+                                break;
+                            }
+                            cout << importStaff(staffManagement, in, path, delimiterFor(path)) << " staff imported.\n";
+                            break;
+                        }
+                        case 7:
+                            break;
+                        default:
+                            cout << "Invalid choice. Please try again." << endl;
+                    }
+                } while (choice != 7);
+                break;
+            }
+            
+            case 2: {
+                for (int i = 1; i <= 5; i++) {
+                    bedManagement.addBeds(i);
+                }
+
+                int patientCounter = patientList.getNextID();
+                while (true) {
+                    string name, condition;
+                    string ageInput;
+                    int age;
+
+                    cout << "\nEnter Patient Name (or 'back' to go to main Menu): ";
+                    cin >> name;
+
+                    if (name == "back") break;
+
+                    if (!isAlphaString(name)) {
+                        cout << "Please enter a valid name." << endl;
+                        continue;
+                    }
+
+                    while (true) { 
+                        cout << "Enter Patient Age: ";
+                        cin >> ageInput;
+
+                        try {
+                            if (!isNumericString(ageInput)) {
+                                throw invalid_argument("Age must be numeric.");
+                            }
+
+                            age = stoi(ageInput);
+                            if (age <= 0 || age > 110) {
+                                throw out_of_range("Age must be between 1 and 110.");
+                            }
+
+                            break; // Age input is valid, break the loop
+
+                        } catch (const invalid_argument& e) {
+                            cout << "Invalid input: " << e.what() << ". Please enter age again." << endl;
+                        } catch (const out_of_range& e) {
+                            cout << "Out of range error: " << e.what() << ". Please enter age again." << endl;
+                        }
+                    }
+
+                    cout << "Enter Condition (s for severe, ns for not_severe): ";
+                    cin >> condition;
+
+                    if (condition == "s") {
+                        // For severe patients, admit them and allocate a bed
+                        patientList.admitPatient(patientCounter, name, age, "severe", "", "");
+                        bedManagement.allocateBed(patientCounter);
+                        cout << "Patient " << name << " admitted successfully." << endl;
+                        ++patientCounter; // Increment the patient counter
+                    } else if (condition == "ns") {
+                        // For non-severe patients, show doctor options and schedule an appointment
+                        doctorManagement.showSoonest(3);
+                        cout << endl;
+                        doctorManagement.showDoctors();
+
+                        int doctorChoice;
+
+                        while (true) {
+                            string doctorChoiceInput;
+
+                            cout << "Select a doctor by number: ";
+                            cin >> doctorChoiceInput;
+
+                            try {
+                                if (!isNumericString(doctorChoiceInput)) {
+                                    throw invalid_argument("Doctor choice must be numeric.");
+                                }
+
+                                doctorChoice = stoi(doctorChoiceInput);
+
+                                if (doctorChoice > 0 && doctorChoice <= doctorManagement.getDoctorsCount()) {
+                                    string appointmentTime;
+                                    if (doctorManagement.allocateDoctorAppointment(doctorChoice - 1, appointmentTime)) {
+                                        // Schedule appointment for non-severe patients
+                                        string selectedDoctorName = doctorManagement.getDoctorName(doctorChoice - 1);
+                                        string selectedDoctorSpecialization = doctorManagement.getDoctorSpecialization(doctorChoice - 1);
+                                        patientList.admitPatient(patientCounter, name, age, "not_severe", selectedDoctorName, appointmentTime);
+                                        cout << "Appointment scheduled with " << selectedDoctorName << " (" << selectedDoctorSpecialization << ") at " << appointmentTime << endl;
+                                        ++patientCounter; // Increment patient counter
+                                        break;
+                                    }
+                                } else {
+                                    cout << "Invalid doctor choice. Please choose again." << endl;
+                                }
+                            } catch (const invalid_argument& e) {
+                                cout << "Invalid input: " << e.what() << ". Please choose a valid doctor." << endl;
+                            }
+                        }
+                    } else {
+                        cout << "Invalid condition entered. Please try again.\n";
+                    }
+                }
+                break;
+            }
+            
+            case 3: {
+                int choice;
+                do {
+                    cout << "\n----Medical Records----";
+                    cout << "\n1. Add Record";
+                    cout << "\n2. Search Record";
+                    cout << "\n3. Update Record";
+                    cout << "\n4. Delete Record";
+                    cout << "\n5. Display All Records";
+                    cout << "\n6. Search Records by Text";
+                    cout << "\n7. Import Records from CSV File";
+                    cout << "\n8. Back to Main Menu";
+                    choice = getValidatedInt("\nEnter your choice: ");
+            
+                    switch (choice) {
+                        case 1: {
+                            medicalSystem.addRecord(); 
+                            break;
+                        }
+                        case 2: {
+                            medicalSystem.searchRecord(); 
+                            break;
+                        }
+                        case 3: {
+                            medicalSystem.updateRecord(); 
+                            break;
+                        }
+                        case 4: {
+                            medicalSystem.deleteRecord(); 
+                            break;
+                        }
+                        case 5: {
+                            medicalSystem.displayRecords(); 
+                            break;
+                        }
+                        case 6: {
+                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
+                            cout << "Enter search words (OR between alternatives, * for prefix): ";
+                            string query;
+                            getline(cin, query);
+                            medicalSystem.displaySearchResults(query);
+                            break;
+                        }
+                        case 7: {
+                            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear the input buffer
+                            cout << "Enter CSV path (patient_id,name,age,history,prescriptions,notes): ";
+                            string path;
+                            getline(cin, path);
+                            ifstream in(path, ios::binary);
+                            if (!in) {
+                                cout << "Cannot open " << path << ".\n";
+                                break;
+                            }
+                            cout << importMedicalRecords(medicalSystem, in, path, delimiterFor(path)) << " records imported.\n";
+                            break;
+                        }
+                        case 8: {
+                            break;
+                        }
+                        default: cout << "Invalid choice. Please try again.\n";
+                    }
+                } while (choice != 8);
+                break;
+            }
+
+           case 4: {
+            int choice;
+            bool inBilling = true;
+            while (inBilling) {
+                try {
+                    cout << "\n----Billing System----" << endl;
+                    cout << "1. Add Billing Record" << endl;
+                    cout << "2. Mark Top Bill as Paid" << endl;
+                    cout << "3. Display All Bills" << endl;
+                    cout << "4. Search Bill by Patient ID" << endl;
+                    cout << "5. Mark Bill as Paid by Patient ID" << endl;
+                    cout << "6. Month-End Settlement" << endl;
+                    cout << "7. Back to Main Menu" << endl;
+                    choice = getValidatedInt("Enter your choice: ");
+        
+                    switch (choice) {
+                        case 1: {
+                            int patientID = getValidatedInt("Enter Patient ID: ");
+                            double totalAmount = getValidatedDouble("Enter Total Amount: ");
+                            string paymentMethod = getValidatedPaymentMethod();
+                            billingSystem.addBillingRecord(patientID, totalAmount, paymentMethod);
+                            break;
+                        }
+                        case 2:
+                            billingSystem.markAsPaid();
+                            break;
+                        case 3:
+                            billingSystem.displayAllBills();
+                            break;
+                        case 4: {
+                            int patientID = getValidatedInt("Enter Patient ID to search: ");
+                            billingSystem.searchBillByID(patientID);
+                            break;
+                        }
+                        case 5: {
+                            int patientID = getValidatedInt("Enter Patient ID to mark as paid: ");
+                            billingSystem.markBillAsPaidByID(patientID);
+                            break;
+                        }
+                        case 6: {
+                            SettlementRules rules;
+                            rules.insuranceCoverage = getValidatedDouble("Enter insurance coverage (%): ") / 100;
+                            rules.cashDiscount = getValidatedDouble("Enter cash discount (%): ") / 100;
+                            if (!settlementPool) {
+                                settlementPool = make_unique<WorkerPool>(max(1u, thread::hardware_concurrency()));
+                            }
+                            BillingSystem::displaySettlement(billingSystem.settleAll(rules, settlementPool.get()));
+                            break;
+                        }
+                        case 7:
+                            // Return to main menu
+                            inBilling = false;
+                            break;
+                        default:
+                            cout << "Invalid choice. Please select a valid option." << endl;
+                    }
+                } catch (const exception& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
+            }
+            break;
+        }
+
+            case 5:
+                if (storage) storage->checkpoint();
+                if (metricsDumper) metricsDumper->dump(hospital);
+                cout << "Goodbye!" << endl;
+                break;
+            default:
+                cout << "Invalid choice. Please try again." << endl;
+        }
+    } while (choice != 5);
+
+    return 0;
+}
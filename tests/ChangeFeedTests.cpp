@@ -0,0 +1,156 @@
+#include "TestSupport.h"
+
+#include <map>
+
+// ================= Change Feed Tests =================
+// A downstream consumer must be able to rebuild state from the JSON feed alone
+
+// Number after "key": at or after `from`; returns `from` past it in `end`
+double numberField(const string& line, const string& key, size_t from = 0, size_t* end = nullptr) {
+    size_t position = line.find("\"" + key + "\":", from);
+    if (position == string::npos) {
+        throw runtime_error("Missing field " + key + " in " + line);
+    }
+    const char* start = line.c_str() + position + key.size() + 3;
+    char* stop;
+    double value = strtod(start, &stop);
+    if (end) *end = stop - line.c_str();
+    return value;
+}
+
+int intField(const string& line, const string& key, size_t from = 0, size_t* end = nullptr) {
+    return static_cast<int>(numberField(line, key, from, end));
+}
+
+bool isType(const string& line, const string& type) {
+    return line.find("\"type\":\"" + type + "\"") != string::npos;
+}
+
+struct PaidBill {
+    double amount;
+    double paidByPatient;
+    double claimedFromInsurer;
+    double discount;
+};
+
+// What a warehouse keeps: bed number -> patient (-1 free) and the paid bills
+struct FeedConsumer {
+    map<int, int> beds;
+    map<int, PaidBill> paidBills;
+
+    void assign(int bed, int patientId) {
+        if (bed != -1) beds[bed] = patientId;
+    }
+
+    void apply(const string& line) {
+        if (isType(line, "BedAdd")) {
+            beds[intField(line, "bed")] = -1;
+        } else if (isType(line, "BedAllocate")) {
+            assign(intField(line, "bed"), intField(line, "patient_id"));
+        } else if (isType(line, "BedOccupy")) {
+            assign(intField(line, "bed"), intField(line, "patient_id"));
+        } else if (isType(line, "BedVacate")) {
+            assign(intField(line, "bed"), -1);
+        } else if (isType(line, "BedRelease") || isType(line, "BedDischarge")) {
+            assign(intField(line, "bed"), -1);
+            assign(intField(line, "next_bed"), intField(line, "next_patient_id"));
+        } else if (isType(line, "BedServeWaiting")) {
+            size_t position = line.find("\"served\":[");
+            size_t close = line.find(']', position);
+            while ((position = line.find("\"patient_id\":", position)) < close) {
+                int patientId = intField(line, "patient_id", position, &position);
+                assign(intField(line, "bed", position, &position), patientId);
+            }
+        } else if (isType(line, "BillPaid")) {
+            paidBills[intField(line, "patient_id")] = PaidBill{numberField(line, "amount"), numberField(line, "paid_by_patient"),
+                                                              numberField(line, "claimed_from_insurer"), numberField(line, "discount")};
+        }
+    }
+};
+
+// Allocations, waiting-list hand-offs, ward write-back and payments, each
+// replayed from the feed and compared with the managers
+void testConsumerRebuildsBedsAndPaidBills() {
+    filesystem::path directory = freshDirectory("change_feed");
+    filesystem::create_directories(directory);
+    string feedPath = (directory / "feed.jsonl").string();
+
+    Hospital hospital;
+    ChangeFeed feed;
+    feed.open(feedPath, ChangeFeedFormat::Json);
+    hospital.setMutationLog(&feed);
+
+    BedManagement& beds = hospital.beds;
+    for (int bed = 1; bed <= 3; bed++) beds.addBeds(bed);
+    for (int patient = 1; patient <= 3; patient++) beds.allocateBed(patient);
+    beds.allocateBed(4);       // Waits
+    beds.allocateBed(5, true); // Waits ahead of 4
+    beds.releaseBed(2);        // Goes to 5
+    beds.dischargePatient(1);  // Bed 1 goes to 4
+    beds.allocateBed(6);
+    beds.allocateBed(7);
+    beds.clearBed(3);
+    beds.serveWaitingList();   // Bed 3 goes to 6
+    beds.addBeds(4);
+    beds.serveWaitingList();   // Bed 4 goes to 7
+    beds.clearBed(1);
+    beds.occupyBed(1, 8);
+    beds.allocateBed(9);
+    beds.dischargePatient(9);  // Only leaves the waiting list
+
+    BillingSystem& billing = hospital.billing;
+    billing.addBillingRecord(1, 1000.0, "Insurance");
+    billing.addBillingRecord(2, 500.0, "Cash");
+    billing.addBillingRecord(3, 200.0, "Card");
+    billing.addBillingRecord(3, 50.0, "Card");
+    billing.addBillingRecord(4, 300.0, "Card");
+    billing.markBillAsPaidByID(3);
+    SettlementRules rules;
+    rules.cashDiscount = 0.1;
+    WorkerPool pool(2);
+    billing.settleAll(rules, &pool);
+
+    hospital.setMutationLog(nullptr);
+    feed.close();
+
+    FeedConsumer consumer;
+    size_t events = 0;
+    readChangeFeed(feedPath, 0, [&](uint64_t, const string& line, uint64_t) {
+        consumer.apply(line);
+        events++;
+    });
+    check(events > 0, "feed: events written");
+
+    map<int, int> expectedBeds;
+    for (const pair<int, int>& bed : beds.getOccupancy()) {
+        expectedBeds[bed.first] = bed.second;
+    }
+    check(consumer.beds == expectedBeds, "feed: bed map rebuilt from the feed");
+    check(consumer.beds[2] == 5 && consumer.beds[3] == 6 && consumer.beds[4] == 7 && consumer.beds[1] == 8,
+          "feed: waiting patients seen moving into beds");
+
+    const vector<BillingRecord>& paid = billing.getPaidBills();
+    check(consumer.paidBills.size() == paid.size(), "feed: one paid event per bill, got " + to_string(consumer.paidBills.size()));
+    for (const BillingRecord& record : paid) {
+        auto found = consumer.paidBills.find(record.patientID);
+        string label = "feed: bill " + to_string(record.patientID);
+        if (found == consumer.paidBills.end()) {
+            check(false, label + " reported paid");
+            continue;
+        }
+        const PaidBill& bill = found->second;
+        check(bill.amount == record.totalAmount && bill.paidByPatient == record.paidByPatient &&
+                  bill.claimedFromInsurer == record.claimedFromInsurer && bill.discount == record.discount,
+              label + " split matches");
+    }
+    check(consumer.paidBills[1].claimedFromInsurer == 800.0 && consumer.paidBills[2].discount == 50.0 &&
+              consumer.paidBills[3].paidByPatient == 250.0,
+          "feed: insurer, discount and full payments reported");
+    filesystem::remove_all(directory);
+}
+
+int main() {
+    return runChecks("change feed", [] {
+        testConsumerRebuildsBedsAndPaidBills();
+    });
+}
@@ -0,0 +1,192 @@
+#include "TestSupport.h"
+
+// ================= Concurrency Tests =================
+// Multi-threaded checks for the service layer, the lock-free bed allocator and
+// the multi-producer queue behind the audit log and change feed
+
+ServiceRequest request(ServiceRequestType type, int id) {
+    ServiceRequest request;
+    request.type = type;
+    request.id = id;
+    return request;
+}
+
+// Requests dispatched on the service's workers reach the attached hospital's
+// write-ahead log, and a restart recovers exactly what the service holds
+void testServiceWritesReachStorage() {
+    filesystem::path directory = freshDirectory("service");
+    const int seeded = 10, total = 400;
+    size_t staffCount = 0, patientCount = 0;
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string(), false);
+        storage.recover();
+        for (int id = 1; id <= seeded; id++) {
+            hospital.staff.addStaff(id, "Staff", "nurses", "Cardiology", "night");
+            hospital.patients.admitPatient(id, "Patient" + to_string(id), 40, "severe");
+        }
+        hospital.billing.addBillingRecord(1, 100.0, "Card");
+
+        HospitalService service(8, 4);
+        service.attach(hospital);
+        check(service.getStaffCount() == seeded && service.getPatientCount() == seeded, "service: seeded from the hospital");
+        check(service.submit(request(ServiceRequestType::FindPatient, 5)).get().name == "Patient5", "service: seeded patient found");
+        check(!service.submit(request(ServiceRequestType::RemoveStaff, seeded + 1)).get().ok, "service: unknown staff not removed");
+
+        vector<future<ServiceResult>> results;
+        for (int id = seeded + 1; id <= total; id++) {
+            ServiceRequest staff = request(ServiceRequestType::AddStaff, id);
+            staff.name = "Staff";
+            staff.role = "doctors";
+            staff.department = "Neurology";
+            staff.shift = "day";
+            results.push_back(service.submit(staff));
+            ServiceRequest patient = request(ServiceRequestType::AdmitPatient, id);
+            patient.name = "Patient" + to_string(id);
+            patient.age = 30;
+            patient.condition = "not_severe";
+            results.push_back(service.submit(patient));
+            ServiceRequest bill = request(ServiceRequestType::AddBill, id % 50 + 1);
+            bill.amount = 10.0;
+            bill.paymentMethod = "Cash";
+            results.push_back(service.submit(bill));
+        }
+        size_t accepted = 0;
+        for (future<ServiceResult>& result : results) accepted += result.get().ok;
+        check(accepted == results.size(), "service: every new record accepted");
+
+        service.withHospital([&](Hospital&) { storage.checkpoint(); });
+
+        results.clear();
+        for (int id = seeded + 1; id <= total; id += 2) {
+            results.push_back(service.submit(request(ServiceRequestType::RemoveStaff, id)));
+            results.push_back(service.submit(request(ServiceRequestType::DischargePatient, id + 1)));
+        }
+        for (future<ServiceResult>& result : results) result.get();
+        staffCount = service.getStaffCount();
+        patientCount = service.getPatientCount();
+        service.withHospital([&](Hospital& attached) {
+            check(attached.staff.size() == staffCount && attached.patients.size() == patientCount, "service: hospital kept in step");
+        });
+    }
+    Hospital hospital;
+    Storage storage(hospital, directory.string(), false);
+    RecoveryStats stats = storage.recover();
+    check(stats.replayedRecords > 0, "service: later writes replayed from the log");
+    check(hospital.staff.size() == staffCount, "service: staff recovered, got " + to_string(hospital.staff.size()));
+    check(hospital.patients.size() == patientCount, "service: patients recovered, got " + to_string(hospital.patients.size()));
+    check(hospital.staff.findStaff(seeded + 1) == nullptr && hospital.staff.findStaff(seeded + 2) != nullptr, "service: removals recovered");
+    const BillingRecord* bill = hospital.billing.findPendingBill(1);
+    double expected = 100.0;
+    for (int id = seeded + 1; id <= total; id++) {
+        if (id % 50 + 1 == 1) expected += 10.0;
+    }
+    check(bill && bill->totalAmount == expected, "service: concurrent bills merged and recovered");
+    filesystem::remove_all(directory);
+}
+
+// Desks allocate and release beds at the same time. Every bed handed out is
+// marked taken; finding the mark already set means a bed went to two patients.
+void testBedAllocatorNeverDoubleBooks() {
+    const int bedCount = 256; // Small enough that the desks fill the ward
+    const size_t threads = 8, operations = 800000;
+    vector<pair<int, int>> ward;
+    for (int bed = 1; bed <= bedCount; bed++) {
+        ward.emplace_back(bed * 2, bed % 4 == 0 ? 100000 + bed : -1); // Every fourth bed already occupied
+    }
+    ConcurrentBedAllocator beds(ward);
+    int initiallyFree = beds.getFreeBeds();
+    unique_ptr<atomic<bool>[]> taken(new atomic<bool>[bedCount * 2 + 1]);
+    for (int bed = 0; bed <= bedCount * 2; bed++) taken[bed].store(false);
+
+    atomic<size_t> doubleBooked(0), wrongOccupant(0), failedReleases(0);
+    vector<thread> desks;
+    for (size_t t = 0; t < threads; t++) {
+        desks.emplace_back([&, t] {
+            mt19937 rng(static_cast<uint32_t>(t + 1));
+            vector<int> held;
+            int patientId = static_cast<int>(t * operations) + 1;
+            for (size_t i = 0; i < operations / threads; i++) {
+                if (held.size() >= 48 || (!held.empty() && rng() % 3 == 0)) {
+                    size_t pick = rng() % held.size();
+                    int bed = held[pick];
+                    held[pick] = held.back();
+                    held.pop_back();
+                    taken[bed].store(false);
+                    failedReleases += beds.release(bed) == -1;
+                } else {
+                    int id = patientId++;
+                    int bed = beds.allocate(id, t * beds.getWordCount() / threads);
+                    if (bed == -1) continue;
+                    doubleBooked += taken[bed].exchange(true);
+                    wrongOccupant += beds.getOccupant(bed) != id;
+                    held.push_back(bed);
+                }
+            }
+            for (int bed : held) {
+                taken[bed].store(false);
+                failedReleases += beds.release(bed) == -1;
+            }
+        });
+    }
+    for (thread& desk : desks) desk.join();
+
+    check(doubleBooked == 0, "beds: no bed handed out twice, got " + to_string(doubleBooked.load()));
+    check(wrongOccupant == 0, "beds: occupant recorded for each allocation");
+    check(failedReleases == 0, "beds: every held bed released once");
+    check(beds.getFreeBeds() == initiallyFree, "beds: free count back to " + to_string(initiallyFree) + ", got " + to_string(beds.getFreeBeds()));
+    check(beds.getOccupancy() == ward, "beds: pre-occupied beds untouched");
+    check(beds.allocate(1) == 2, "beds: lowest free bed handed out after the run");
+}
+
+// Producers append to the audit log at once, more events than the ring holds.
+// On disk every event must appear exactly once, numbered 1, 2, 3, ... with
+// each producer's events in the order it appended them.
+void testAuditLogKeepsEveryEventInOrder() {
+    filesystem::path directory = freshDirectory("audit_producers");
+    filesystem::create_directories(directory);
+    string path = (directory / "hms.audit").string();
+    const int producers = 8, perProducer = 20000;
+    {
+        AuditLog audit;
+        audit.open(path, false);
+        vector<thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < perProducer; i++) {
+                    BinaryWriter payload;
+                    payload.putInt(p);
+                    payload.putInt(i);
+                    audit.append(MutationType::StaffDelete, payload);
+                }
+            });
+        }
+        for (thread& producer : threads) producer.join();
+        audit.close();
+        check(!audit.hasFailed() && audit.getWrittenEvents() == uint64_t(producers) * perProducer, "audit: every event handed to the file");
+    }
+
+    uint64_t expectedSequence = 1;
+    size_t outOfSequence = 0, outOfOrder = 0;
+    vector<int> nextFromProducer(producers, 0);
+    bool valid = AuditLog::read(path, [&](const AuditEventHeader& header, const string& payload) {
+        outOfSequence += header.sequence != expectedSequence++;
+        BinaryReader in(payload.data(), payload.size());
+        int producer = in.getInt();
+        int index = in.getInt();
+        if (producer < 0 || producer >= producers || index != nextFromProducer[producer]++) outOfOrder++;
+    });
+    check(valid, "audit: file readable");
+    check(expectedSequence - 1 == uint64_t(producers) * perProducer, "audit: all events on disk, got " + to_string(expectedSequence - 1));
+    check(outOfSequence == 0, "audit: sequence numbers consecutive from 1");
+    check(outOfOrder == 0, "audit: each producer's events once and in order, " + to_string(outOfOrder) + " misplaced");
+    filesystem::remove_all(directory);
+}
+
+int main() {
+    return runChecks("concurrency", [] {
+        testServiceWritesReachStorage();
+        testBedAllocatorNeverDoubleBooks();
+        testAuditLogKeepsEveryEventInOrder();
+    });
+}
@@ -0,0 +1,220 @@
+#include "TestSupport.h"
+
+// ================= Storage Tests =================
+// Recovery checks for the snapshot + write-ahead log pair and the audit log
+
+void addChanges(Hospital& hospital, int firstID, int count) {
+    for (int id = firstID; id < firstID + count; id++) {
+        hospital.staff.addStaff(id, "Staff", "nurses", "Cardiology", "night");
+        hospital.patients.admitPatient(id, "Patient", 30 + id % 50, "severe");
+        hospital.billing.addBillingRecord(id, 100.0 * id, "Card");
+    }
+}
+
+void checkChanges(const Hospital& hospital, int firstID, int count, const string& label) {
+    for (int id = firstID; id < firstID + count; id++) {
+        check(hospital.staff.findStaff(id) != nullptr, label + ": staff " + to_string(id) + " recovered");
+        const Patient* patient = hospital.patients.searchPatientByID(id);
+        check(patient && patient->age == 30 + id % 50, label + ": patient " + to_string(id) + " recovered");
+        const BillingRecord* bill = hospital.billing.findPendingBill(id);
+        check(bill && bill->totalAmount == 100.0 * id, label + ": bill " + to_string(id) + " recovered");
+    }
+}
+
+// Changes before a checkpoint come back from the snapshot, later ones from the log
+void testSnapshotAndLogRoundTrip() {
+    filesystem::path directory = freshDirectory("roundtrip");
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string());
+        storage.recover();
+        addChanges(hospital, 1, 50);
+        storage.checkpoint();
+        addChanges(hospital, 51, 20);
+    }
+    Hospital hospital;
+    Storage storage(hospital, directory.string());
+    RecoveryStats stats = storage.recover();
+    check(stats.snapshotLoaded, "round trip: snapshot loaded");
+    check(stats.replayedRecords == 60, "round trip: 60 log records replayed, got " + to_string(stats.replayedRecords));
+    check(stats.truncatedBytes == 0, "round trip: nothing truncated");
+    check(hospital.patients.size() == 70, "round trip: 70 patients");
+    checkChanges(hospital, 1, 70, "round trip");
+    filesystem::remove_all(directory);
+}
+
+// A record cut short by a crash is dropped; the records before it survive and
+// logging continues after them
+void testTornTailRecovery() {
+    filesystem::path directory = freshDirectory("torn");
+    string logPath = (directory / "hms.wal").string();
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string(), false);
+        storage.recover();
+        addChanges(hospital, 1, 10);
+    }
+    uintmax_t intactSize = filesystem::file_size(logPath);
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string(), false);
+        storage.recover();
+        addChanges(hospital, 11, 1);
+    }
+    filesystem::resize_file(logPath, filesystem::file_size(logPath) - 3);
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string(), false);
+        RecoveryStats stats = storage.recover();
+        check(stats.replayedRecords == 32, "torn tail: 32 intact records replayed, got " + to_string(stats.replayedRecords));
+        check(stats.truncatedBytes > 0, "torn tail: torn record cut off");
+        check(filesystem::file_size(logPath) > intactSize, "torn tail: intact records of the second run kept");
+        check(hospital.billing.findPendingBill(11) == nullptr, "torn tail: torn bill not applied");
+        checkChanges(hospital, 1, 10, "torn tail");
+        hospital.billing.addBillingRecord(11, 1100.0, "Card");
+    }
+    Hospital hospital;
+    Storage storage(hospital, directory.string(), false);
+    RecoveryStats stats = storage.recover();
+    check(stats.truncatedBytes == 0, "torn tail: log clean after the next run");
+    checkChanges(hospital, 1, 11, "torn tail, reopened");
+    filesystem::remove_all(directory);
+}
+
+// Each settled bill's split between patient, insurer and discount survives a
+// checkpoint, and replaying the log's per-bill payments rebuilds it too
+void testSettlementSplitRoundTrip(bool checkpoint) {
+    string label = checkpoint ? "settlement, snapshot" : "settlement, log";
+    filesystem::path directory = freshDirectory(checkpoint ? "settlement_snapshot" : "settlement_log");
+    {
+        Hospital hospital;
+        Storage storage(hospital, directory.string());
+        storage.recover();
+        hospital.billing.addBillingRecord(1, 1000.0, "Insurance");
+        hospital.billing.addBillingRecord(2, 500.0, "Cash");
+        SettlementRules rules;
+        rules.cashDiscount = 0.1;
+        hospital.billing.settleAll(rules);
+        if (checkpoint) storage.checkpoint();
+    }
+    Hospital hospital;
+    Storage storage(hospital, directory.string());
+    storage.recover();
+    SnapshotBuilder out;
+    hospital.billing.saveSnapshot(out);
+    string path = (directory / "check.snapshot").string();
+    out.write(path, 0);
+    SnapshotView view;
+    view.open(path);
+    RecordSpan<SnapshotBill> paid = view.records<SnapshotBill>(SnapshotSectionKind::PaidBills);
+    check(paid.size() == 2, label + ": 2 paid bills");
+    check(hospital.billing.getPendingCount() == 0, label + ": no pending bills left");
+    for (const SnapshotBill& bill : paid) {
+        if (bill.patientID == 1) {
+            check(bill.claimedFromInsurer == 800.0 && bill.paidByPatient == 200.0, label + ": insurance split kept");
+        } else {
+            check(bill.discount == 50.0 && bill.paidByPatient == 450.0, label + ": cash discount kept");
+        }
+    }
+    filesystem::remove_all(directory);
+}
+
+size_t countAuditEvents(const string& path, bool& valid) {
+    size_t events = 0;
+    valid = AuditLog::read(path, [&](const AuditEventHeader&, const string&) { events++; });
+    return events;
+}
+
+// A file that is not an audit log is moved aside instead of being appended to,
+// so the events written after it stay readable
+void testAuditLogMovesUnknownFileAside() {
+    filesystem::path directory = freshDirectory("audit_unknown");
+    filesystem::create_directories(directory);
+    string path = (directory / "hms.audit").string();
+    {
+        ofstream garbage(path, ios::binary);
+        garbage << "this is not an audit log";
+    }
+    {
+        Hospital hospital;
+        AuditLog audit;
+        ostringstream warning;
+        streambuf* previous = cerr.rdbuf(warning.rdbuf());
+        audit.open(path, false);
+        cerr.rdbuf(previous);
+        check(warning.str().find("moved it to") != string::npos, "audit: unknown file reported");
+        hospital.setMutationLog(&audit);
+        addChanges(hospital, 1, 5);
+        hospital.setMutationLog(nullptr);
+        audit.close();
+    }
+    bool valid = false;
+    size_t events = countAuditEvents(path, valid);
+    check(valid && events == 15, "audit: new log readable with 15 events, got " + to_string(events));
+    size_t asideFiles = 0;
+    for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directory)) {
+        asideFiles += entry.path().filename().string().rfind("hms.audit.unreadable-", 0) == 0;
+    }
+    check(asideFiles == 1, "audit: unknown file moved aside");
+    filesystem::remove_all(directory);
+}
+
+// A writer whose setup throws on its thread, as a filesystem error would
+class FailingWriter : public BackgroundMutationWriter {
+protected:
+    uint64_t prepareFile() override {
+        throw filesystem::filesystem_error("cannot size file", path, make_error_code(errc::io_error));
+    }
+
+    void encode(const QueuedMutation&, uint64_t, string& batch) override {
+        batch += "event";
+    }
+
+public:
+    FailingWriter() : BackgroundMutationWriter("test writer") {}
+
+    ~FailingWriter() {
+        stop();
+    }
+
+    void open(const string& filePath) {
+        start(filePath, false);
+    }
+};
+
+// An error on the writer thread is reported through its status instead of
+// ending the process, and appends keep draining
+void testWriterFailureIsReported() {
+    filesystem::path directory = freshDirectory("writer_failure");
+    filesystem::create_directories(directory);
+    string path = (directory / "events").string();
+    ostringstream errors;
+    streambuf* previous = cerr.rdbuf(errors.rdbuf());
+    {
+        FailingWriter writer;
+        writer.open(path);
+        BinaryWriter payload;
+        payload.putInt(1);
+        for (int i = 0; i < 100000; i++) { // More than the ring holds
+            writer.append(MutationType::StaffDelete, payload);
+        }
+        writer.flush();
+        check(writer.hasFailed() && writer.getFailure().find("cannot size file") != string::npos, "writer failure: reported in status");
+        check(writer.getDroppedEvents() == 100000 && writer.getWrittenEvents() == 0, "writer failure: events dropped, not written");
+    }
+    cerr.rdbuf(previous);
+    check(errors.str().find("dropping further events") != string::npos, "writer failure: reported once on stderr");
+    check(filesystem::file_size(path) == 0, "writer failure: nothing written after the failure");
+    filesystem::remove_all(directory);
+}
+
+int main() {
+    return runChecks("storage", [] {
+        testSnapshotAndLogRoundTrip();
+        testTornTailRecovery();
+        testSettlementSplitRoundTrip(true);
+        testSettlementSplitRoundTrip(false);
+        testAuditLogMovesUnknownFileAside();
+        testWriterFailureIsReported();
+    });
+}
@@ -0,0 +1,35 @@
+#ifndef HMS_TEST_SUPPORT_H
+#define HMS_TEST_SUPPORT_H
+
+#include "HospitalManagementSystem.h"
+
+// ================= Test Support =================
+// Each check prints what failed; runChecks exits non-zero if any did.
+inline int failures = 0;
+
+inline void check(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+inline filesystem::path freshDirectory(const string& name) {
+    filesystem::path directory = filesystem::temp_directory_path() / ("hms_test_" + name);
+    filesystem::remove_all(directory);
+    return directory;
+}
+
+// Runs the checks with cout silenced (the managers print confirmations) and
+// returns the process exit code
+template <typename Function>
+int runChecks(const string& suite, Function checks) {
+    ostringstream quiet;
+    streambuf* previous = cout.rdbuf(quiet.rdbuf());
+    checks();
+    cout.rdbuf(previous);
+    cout << (failures == 0 ? "All " + suite + " tests passed." : to_string(failures) + " " + suite + " checks failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // HMS_TEST_SUPPORT_H